@@ -2,22 +2,207 @@
 #include "DataTypes.h"
 #include <new>
 #include <assert.h>
+#if !WIN32 && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define ALLOCATOR_POSIX_MEMORY 1
+#endif
+
+// Page size used if the operating system cannot report one
+static const size_t DEFAULT_PAGE_SIZE = 4096;
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Memory options requiring memory mapped from the operating system
+static const UINT MMAP_FLAGS = ALLOC_MMAP | ALLOC_HUGE_PAGES | ALLOC_TRANSPARENT_HUGE_PAGES;
+
+//------------------------------------------------------------------------------
+// RoundUp
+//------------------------------------------------------------------------------
+static size_t RoundUp(size_t size, size_t multiple)
+{
+	return (size + multiple - 1) / multiple * multiple;
+}
+
+//------------------------------------------------------------------------------
+// RoundBlockSize
+//------------------------------------------------------------------------------
+static size_t RoundBlockSize(size_t size, CHAR* memory, UINT flags, size_t cacheLineSize)
+{
+	size_t blockSize = size < sizeof(long*) ? sizeof(long*) : size;
+
+	// Caller provided memory is sized for the unrounded block size
+	if (!memory && (flags & ALLOC_CACHE_ALIGN))
+		blockSize = RoundUp(blockSize, cacheLineSize);
+	return blockSize;
+}
+
+//------------------------------------------------------------------------------
+// ImpliedFlags
+//------------------------------------------------------------------------------
+static UINT ImpliedFlags(UINT flags)
+{
+	if (flags & MMAP_FLAGS)
+		flags |= ALLOC_MMAP;
+	if (flags & ALLOC_HUGE_PAGES)
+		flags |= ALLOC_TRANSPARENT_HUGE_PAGES;
+	return flags;
+}
+
+//------------------------------------------------------------------------------
+// QueryPageSize
+//------------------------------------------------------------------------------
+static size_t QueryPageSize()
+{
+#if WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#elif ALLOCATOR_POSIX_MEMORY
+	long pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize > 0 ? (size_t)pageSize : DEFAULT_PAGE_SIZE;
+#else
+	return DEFAULT_PAGE_SIZE;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// MapPages
+//------------------------------------------------------------------------------
+static CHAR* MapPages(size_t& bytes, UINT& flags)
+{
+#if WIN32
+	// Large pages require the SeLockMemoryPrivilege and are always locked
+	if (flags & ALLOC_HUGE_PAGES)
+	{
+		size_t largePage = GetLargePageMinimum();
+		if (largePage)
+		{
+			size_t largeBytes = RoundUp(bytes, largePage);
+			void* p = VirtualAlloc(NULL, largeBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (p)
+			{
+				bytes = largeBytes;
+				flags |= ALLOC_TRANSPARENT_HUGE_PAGES;
+				return (CHAR*)p;
+			}
+		}
+	}
+	flags &= ~(ALLOC_HUGE_PAGES | ALLOC_TRANSPARENT_HUGE_PAGES);
+	bytes = RoundUp(bytes, Allocator::GetPageSize());
+	return (CHAR*)VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif ALLOCATOR_POSIX_MEMORY
+#ifdef MAP_HUGETLB
+	if (flags & ALLOC_HUGE_PAGES)
+	{
+		// Fails unless huge pages of the default size are reserved 
+		size_t hugeBytes = RoundUp(bytes, HUGE_PAGE_SIZE);
+		void* p = mmap(NULL, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED)
+		{
+			bytes = hugeBytes;
+			flags |= ALLOC_TRANSPARENT_HUGE_PAGES;
+			return (CHAR*)p;
+		}
+	}
+#endif
+	if (flags & ALLOC_HUGE_PAGES)
+		flags = (flags & ~ALLOC_HUGE_PAGES) | ALLOC_TRANSPARENT_HUGE_PAGES;
+
+	// Transparent huge pages need a huge page sized and aligned range
+	bool transparent = (flags & ALLOC_TRANSPARENT_HUGE_PAGES) != 0;
+	bytes = RoundUp(bytes, transparent ? HUGE_PAGE_SIZE : Allocator::GetPageSize());
+	size_t mapBytes = transparent ? bytes + HUGE_PAGE_SIZE : bytes;
+	void* p = mmap(NULL, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	CHAR* pMemory = (CHAR*)p;
+	if (transparent)
+	{
+		// Trim the mapping to an aligned range
+		pMemory = (CHAR*)RoundUp((size_t)p, HUGE_PAGE_SIZE);
+		size_t head = pMemory - (CHAR*)p;
+		if (head)
+			munmap(p, head);
+		munmap(pMemory + bytes, HUGE_PAGE_SIZE - head);
+
+#ifdef MADV_HUGEPAGE
+		if (madvise(pMemory, bytes, MADV_HUGEPAGE) != 0)
+			flags &= ~ALLOC_TRANSPARENT_HUGE_PAGES;
+#else
+		flags &= ~ALLOC_TRANSPARENT_HUGE_PAGES;
+#endif
+	}
+	return pMemory;
+#else
+	// No virtual memory interface. Use the heap instead. 
+	flags &= ~MMAP_FLAGS;
+	return NULL;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// UnmapPages
+//------------------------------------------------------------------------------
+static void UnmapPages(CHAR* pMemory, size_t bytes)
+{
+#if WIN32
+	(void)bytes;
+	VirtualFree(pMemory, 0, MEM_RELEASE);
+#elif ALLOCATOR_POSIX_MEMORY
+	munmap(pMemory, bytes);
+#else
+	(void)pMemory;
+	(void)bytes;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// LockPages
+//------------------------------------------------------------------------------
+static bool LockPages(CHAR* pMemory, size_t bytes, bool lock)
+{
+#if WIN32
+	return lock ? VirtualLock(pMemory, bytes) != 0 : VirtualUnlock(pMemory, bytes) != 0;
+#elif ALLOCATOR_POSIX_MEMORY
+	return lock ? mlock(pMemory, bytes) == 0 : munlock(pMemory, bytes) == 0;
+#else
+	(void)pMemory;
+	(void)bytes;
+	(void)lock;
+	return false;
+#endif
+}
 
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
-Allocator::Allocator(size_t size, UINT objects, CHAR* memory, const CHAR* name) :
-    m_blockSize(size < sizeof(long*) ? sizeof(long*):size),
+Allocator::Allocator(size_t size, UINT objects, CHAR* memory, const CHAR* name, bool lockFree, UINT flags) :
+    m_blockSize(RoundBlockSize(size, memory, flags, CACHE_LINE_SIZE)),
     m_objectSize(size),
     m_maxObjects(objects),
     m_pHead(NULL),
+    m_pPool(NULL),
     m_poolIndex(0),
     m_blockCnt(0),
     m_blocksInUse(0),
+    m_peakBlocksInUse(0),
     m_allocations(0),
     m_deallocations(0),
-    m_name(name)
+    m_exhaustions(0),
+    m_reclaimedBytes(0),
+    m_name(name),
+    m_flags(memory ? 0 : flags),
+    m_chunked(!objects && (lockFree || (!memory && flags))),
+    m_memoryFlags(ImpliedFlags(m_flags)),
+    m_lockFree(lockFree),
+    m_freeHead(0),
+    m_pNext(NULL),
+    m_chunkCnt(0)
 {
+    for (UINT k = 0; k < MAX_CHUNKS; k++)
+        m_chunks[k] = NULL;
+
     // If using a fixed memory pool 
 	if (m_maxObjects)
 	{
@@ -29,12 +214,24 @@ Allocator::Allocator(size_t size, UINT objects, CHAR* memory, const CHAR* name)
 		}
 		else 
 		{
-			m_pPool = (CHAR*)new CHAR[m_blockSize * m_maxObjects];
+			ObtainMemory(m_poolRegion, m_blockSize * m_maxObjects, m_flags);
+			m_memoryFlags.fetch_and(m_poolRegion.flags);
+			m_pPool = m_poolRegion.pMemory;
 			m_allocatorMode = HEAP_POOL;
 		}
 	}
 	else
 		m_allocatorMode = HEAP_BLOCKS;
+
+	// A lock-free pool starts with every block on the free-list
+	if (m_lockFree && m_maxObjects)
+	{
+		m_pNext = new std::atomic<UINT>[m_maxObjects];
+		for (UINT i = 0; i < m_maxObjects; i++)
+			m_pNext[i].store(i + 1 < m_maxObjects ? i + 2 : 0, std::memory_order_relaxed);
+		m_freeHead.store(1, std::memory_order_release);
+		m_blockCnt.store(m_maxObjects, std::memory_order_relaxed);
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -45,12 +242,24 @@ Allocator::~Allocator()
 	// If using pool then destroy it, otherwise traverse free-list and 
 	// destroy each individual block
 	if (m_allocatorMode == HEAP_POOL)
-		delete [] m_pPool;
-	else if (m_allocatorMode == HEAP_BLOCKS)
+		ReleaseMemory(m_poolRegion);
+	else if (m_allocatorMode == HEAP_BLOCKS && !m_chunked)
 	{
 		while(m_pHead)
 			delete [] (CHAR*)Pop();
 	}
+
+	delete [] m_pNext;
+	for (UINT k = 0; k < MAX_CHUNKS; k++)
+	{
+		Chunk* chunk = m_chunks[k].load();
+		if (chunk)
+		{
+			ReleaseMemory(chunk->region);
+			delete [] chunk->pNext;
+			delete chunk;
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -61,20 +270,24 @@ void* Allocator::Allocate(size_t size)
     assert(size <= m_objectSize);
 	
     // If can't obtain existing block then get a new one
-    void* pBlock = Pop();
+    void* pBlock = m_lockFree ? PopLockFree() : Pop();
     if (!pBlock)
     {
         // If using a pool method then get block from pool,
-        // otherwise using dynamic so get block from heap
-        if (m_maxObjects)
+        // otherwise using dynamic so get block from heap. 
+        // A lock-free allocator only fails when exhausted.
+        if (m_maxObjects || m_lockFree)
         {
             // If we have not exceeded the pool maximum
-            if(m_poolIndex < m_maxObjects)
+            if(!m_lockFree && m_poolIndex < m_maxObjects)
             {
+                m_blockCnt.fetch_add(1, std::memory_order_relaxed);
                 pBlock = (void*)(m_pPool + (m_poolIndex++ * m_blockSize));
             }
             else
             {
+                m_exhaustions.fetch_add(1, std::memory_order_relaxed);
+
                 // Get the pointer to the new handler
                 std::new_handler handler = std::set_new_handler(0);
                 std::set_new_handler(handler);
@@ -86,27 +299,76 @@ void* Allocator::Allocate(size_t size)
                     assert(0);
             }
         }
+        else if (m_chunked)
+        {
+            pBlock = GrowBlocks();
+        }
         else
         {
-        	m_blockCnt++;
+        	m_blockCnt.fetch_add(1, std::memory_order_relaxed);
             pBlock = (void*)new CHAR[m_blockSize];
         }
     }
 
-    m_blocksInUse++;
-    m_allocations++;
+    if (pBlock)
+        CountAllocation();
 	
     return pBlock;
 }
 
+//------------------------------------------------------------------------------
+// TryAllocate
+//------------------------------------------------------------------------------
+void* Allocator::TryAllocate(size_t size)
+{
+    assert(size <= m_objectSize);
+
+    void* pBlock = NULL;
+    if (m_lockFree)
+    {
+        // Only pools are never grown by PopLockFree()
+        if (m_maxObjects)
+            pBlock = PopLockFree();
+    }
+    else
+    {
+        pBlock = Pop();
+        if (!pBlock && m_maxObjects && m_poolIndex < m_maxObjects)
+        {
+            m_blockCnt.fetch_add(1, std::memory_order_relaxed);
+            pBlock = (void*)(m_pPool + (m_poolIndex++ * m_blockSize));
+        }
+    }
+
+    if (pBlock)
+        CountAllocation();
+    return pBlock;
+}
+
+//------------------------------------------------------------------------------
+// CountAllocation
+//------------------------------------------------------------------------------
+void Allocator::CountAllocation()
+{
+    // Raise the high-water mark 
+    UINT inUse = m_blocksInUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    UINT peak = m_peakBlocksInUse.load(std::memory_order_relaxed);
+    while (inUse > peak && !m_peakBlocksInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+        ;
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
 //------------------------------------------------------------------------------
 // Deallocate
 //------------------------------------------------------------------------------
 void Allocator::Deallocate(void* pBlock)
 {
-    Push(pBlock);
-	m_blocksInUse--;
-	m_deallocations++;
+    if (m_lockFree)
+        PushLockFree(pBlock);
+    else
+        Push(pBlock);
+    m_blocksInUse.fetch_sub(1, std::memory_order_relaxed);
+    m_deallocations.fetch_add(1, std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------
@@ -135,7 +397,350 @@ void* Allocator::Pop()
     return (void*)pBlock;
 }
 
+//------------------------------------------------------------------------------
+// PushLockFree
+//------------------------------------------------------------------------------
+void Allocator::PushLockFree(void* pMemory)
+{
+    UINT index = GetIndex(pMemory);
+    PushChain(index, index);
+}
 
+//------------------------------------------------------------------------------
+// PushChain
+//------------------------------------------------------------------------------
+void Allocator::PushChain(UINT first, UINT last)
+{
+    unsigned long long head = m_freeHead.load(std::memory_order_relaxed);
+    unsigned long long newHead;
+    do
+    {
+        GetNext(last).store((UINT)head, std::memory_order_relaxed);
+        newHead = (((head >> 32) + 1) << 32) | (first + 1);
+    } while (!m_freeHead.compare_exchange_weak(head, newHead, 
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+//------------------------------------------------------------------------------
+// PopLockFree
+//------------------------------------------------------------------------------
+void* Allocator::PopLockFree()
+{
+    unsigned long long head = m_freeHead.load(std::memory_order_acquire);
+    while (1)
+    {
+        UINT index = (UINT)head;
+        if (index == 0)
+        {
+            // Pools never grow
+            if (m_maxObjects || m_chunkCnt.load() == MAX_CHUNKS)
+                return NULL;
 
+            void* pBlock = Grow();
+            if (pBlock)
+                return pBlock;
+            head = m_freeHead.load(std::memory_order_acquire);
+            continue;
+        }
 
+        // The next index may be stale if another thread popped the block 
+        // meanwhile. The tag then differs and the exchange fails.
+        UINT next = GetNext(index - 1).load(std::memory_order_relaxed);
+        unsigned long long newHead = (((head >> 32) + 1) << 32) | next;
+        if (m_freeHead.compare_exchange_weak(head, newHead, 
+            std::memory_order_acquire, std::memory_order_acquire))
+            return GetBlock(index - 1);
+    }
+}
 
+//------------------------------------------------------------------------------
+// Grow
+//------------------------------------------------------------------------------
+void* Allocator::Grow()
+{
+    UINT k = m_chunkCnt.load(std::memory_order_acquire);
+    if (k == MAX_CHUNKS)
+        return NULL;
+
+    UINT count = (UINT)CHUNK_BLOCKS << k;
+    Chunk* chunk = new Chunk;
+    ObtainMemory(chunk->region, m_blockSize * count, m_flags);
+    chunk->pBlocks = chunk->region.pMemory;
+    chunk->pNext = new std::atomic<UINT>[count];
+    chunk->count = count;
+
+    // Another thread may install chunk k first
+    Chunk* expected = NULL;
+    BOOL installed = m_chunks[k].compare_exchange_strong(expected, chunk, std::memory_order_acq_rel);
+    UINT cnt = k;
+    m_chunkCnt.compare_exchange_strong(cnt, k + 1, std::memory_order_acq_rel);
+    if (!installed)
+    {
+        ReleaseMemory(chunk->region);
+        delete [] chunk->pNext;
+        delete chunk;
+        return NULL;
+    }
+
+    m_memoryFlags.fetch_and(chunk->region.flags);
+    m_blockCnt.fetch_add(count, std::memory_order_relaxed);
+
+    // Keep the first block and push the rest as one chain
+    UINT first = (UINT)CHUNK_BLOCKS * ((1u << k) - 1);
+    if (count > 1)
+    {
+        for (UINT i = 1; i < count - 1; i++)
+            chunk->pNext[i].store(first + i + 2, std::memory_order_relaxed);
+        PushChain(first + 1, first + count - 1);
+    }
+    return chunk->pBlocks;
+}
+
+//------------------------------------------------------------------------------
+// GetBlock
+//------------------------------------------------------------------------------
+CHAR* Allocator::GetBlock(UINT index)
+{
+    if (m_maxObjects)
+        return m_pPool + (size_t)index * m_blockSize;
+
+    // Chunk k starts at block CHUNK_BLOCKS * (2^k - 1)
+    UINT q = index / CHUNK_BLOCKS + 1;
+    UINT k = 0;
+    while (q >> (k + 1))
+        k++;
+    UINT first = (UINT)CHUNK_BLOCKS * ((1u << k) - 1);
+    return m_chunks[k].load(std::memory_order_acquire)->pBlocks + (size_t)(index - first) * m_blockSize;
+}
+
+//------------------------------------------------------------------------------
+// GetIndex
+//------------------------------------------------------------------------------
+UINT Allocator::GetIndex(void* pBlock)
+{
+    CHAR* p = (CHAR*)pBlock;
+    if (m_maxObjects)
+        return (UINT)((p - m_pPool) / m_blockSize);
+
+    for (UINT k = 0; k < MAX_CHUNKS; k++)
+    {
+        Chunk* chunk = m_chunks[k].load(std::memory_order_acquire);
+        assert(chunk != NULL);
+        size_t count = (size_t)CHUNK_BLOCKS << k;
+        if (p >= chunk->pBlocks && p < chunk->pBlocks + count * m_blockSize)
+            return (UINT)(CHUNK_BLOCKS * ((1u << k) - 1) + (p - chunk->pBlocks) / m_blockSize);
+    }
+    assert(0);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// GetNext
+//------------------------------------------------------------------------------
+std::atomic<UINT>& Allocator::GetNext(UINT index)
+{
+    if (m_maxObjects)
+        return m_pNext[index];
+
+    UINT q = index / CHUNK_BLOCKS + 1;
+    UINT k = 0;
+    while (q >> (k + 1))
+        k++;
+    UINT first = (UINT)CHUNK_BLOCKS * ((1u << k) - 1);
+    return m_chunks[k].load(std::memory_order_acquire)->pNext[index - first];
+}
+
+//------------------------------------------------------------------------------
+// GrowBlocks
+//------------------------------------------------------------------------------
+void* Allocator::GrowBlocks()
+{
+    UINT k = 0;
+    while (k < MAX_CHUNKS && m_chunks[k].load(std::memory_order_relaxed))
+        k++;
+    assert(k < MAX_CHUNKS);
+
+    Chunk* chunk = new Chunk;
+    ObtainMemory(chunk->region, m_blockSize * ((size_t)CHUNK_BLOCKS << k), m_flags);
+    chunk->pBlocks = chunk->region.pMemory;
+    chunk->pNext = NULL;
+    chunk->count = (UINT)(chunk->region.bytes / m_blockSize);
+    m_chunks[k].store(chunk, std::memory_order_relaxed);
+    m_memoryFlags.fetch_and(chunk->region.flags);
+    m_blockCnt.fetch_add(chunk->count, std::memory_order_relaxed);
+
+    // Keep the first block and push the rest so lower addresses are used first
+    for (UINT i = chunk->count - 1; i > 0; i--)
+        Push(chunk->pBlocks + (size_t)i * m_blockSize);
+    return chunk->pBlocks;
+}
+
+//------------------------------------------------------------------------------
+// FindChunk
+//------------------------------------------------------------------------------
+UINT Allocator::FindChunk(void* pBlock)
+{
+    CHAR* p = (CHAR*)pBlock;
+    for (UINT k = 0; k < MAX_CHUNKS; k++)
+    {
+        Chunk* chunk = m_chunks[k].load(std::memory_order_relaxed);
+        if (chunk && p >= chunk->pBlocks && p < chunk->pBlocks + (size_t)chunk->count * m_blockSize)
+            return k;
+    }
+    assert(0);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Trim
+//------------------------------------------------------------------------------
+size_t Allocator::Trim(UINT retainBlocks)
+{
+    if (m_allocatorMode != HEAP_BLOCKS || m_lockFree)
+        return 0;
+
+    size_t released = 0;
+    if (!m_chunked)
+    {
+        // Keep the most recently freed blocks since they are likely still cached
+        Block** ppNext = &m_pHead;
+        for (UINT i = 0; i < retainBlocks && *ppNext; i++)
+            ppNext = &(*ppNext)->pNext;
+        Block* pBlock = *ppNext;
+        *ppNext = NULL;
+
+        while (pBlock)
+        {
+            Block* pNext = pBlock->pNext;
+            delete [] (CHAR*)pBlock;
+            m_blockCnt.fetch_sub(1, std::memory_order_relaxed);
+            released += m_blockSize;
+            pBlock = pNext;
+        }
+    }
+    else
+    {
+        // Count the free blocks of each chunk
+        UINT freeCnt[MAX_CHUNKS] = { 0 };
+        UINT freeBlocks = 0;
+        for (Block* pBlock = m_pHead; pBlock; pBlock = pBlock->pNext)
+        {
+            freeCnt[FindChunk(pBlock)]++;
+            freeBlocks++;
+        }
+
+        // Select fully free chunks, largest first, while enough blocks remain free
+        bool release[MAX_CHUNKS] = { false };
+        bool any = false;
+        for (INT k = MAX_CHUNKS - 1; k >= 0; k--)
+        {
+            Chunk* chunk = m_chunks[k].load(std::memory_order_relaxed);
+            if (chunk && freeCnt[k] == chunk->count && freeBlocks - chunk->count >= retainBlocks)
+            {
+                release[k] = any = true;
+                freeBlocks -= chunk->count;
+            }
+        }
+        if (!any)
+            return 0;
+
+        // Unlink the blocks of the selected chunks from the free-list
+        Block** ppNext = &m_pHead;
+        while (*ppNext)
+        {
+            if (release[FindChunk(*ppNext)])
+                *ppNext = (*ppNext)->pNext;
+            else
+                ppNext = &(*ppNext)->pNext;
+        }
+
+        for (UINT k = 0; k < MAX_CHUNKS; k++)
+        {
+            if (!release[k])
+                continue;
+            Chunk* chunk = m_chunks[k].load(std::memory_order_relaxed);
+            m_chunks[k].store(NULL, std::memory_order_relaxed);
+            m_blockCnt.fetch_sub(chunk->count, std::memory_order_relaxed);
+            released += chunk->region.bytes;
+            ReleaseMemory(chunk->region);
+            delete chunk;
+        }
+    }
+
+    m_reclaimedBytes.fetch_add(released, std::memory_order_relaxed);
+    return released;
+}
+
+//------------------------------------------------------------------------------
+// GetPageSize
+//------------------------------------------------------------------------------
+size_t Allocator::GetPageSize()
+{
+    static const size_t pageSize = QueryPageSize();
+    return pageSize;
+}
+
+//------------------------------------------------------------------------------
+// ObtainMemory
+//------------------------------------------------------------------------------
+void Allocator::ObtainMemory(Region& region, size_t bytes, UINT flags)
+{
+    region.pMemory = NULL;
+    region.pRaw = NULL;
+    region.bytes = bytes;
+    region.flags = flags;
+
+    if (flags & MMAP_FLAGS)
+    {
+        region.flags |= ALLOC_MMAP;
+        region.pRaw = MapPages(region.bytes, region.flags);
+        if (!region.pRaw && (region.flags & MMAP_FLAGS))
+            throw std::bad_alloc();
+        region.pMemory = region.pRaw;
+    }
+
+    if (!region.pRaw)
+    {
+        // Heap memory is aligned by hand
+        size_t align = (flags & ALLOC_CACHE_ALIGN) ? CACHE_LINE_SIZE : 1;
+        region.pRaw = new CHAR[bytes + align - 1];
+        region.pMemory = (CHAR*)RoundUp((size_t)region.pRaw, align);
+        region.bytes = bytes;
+    }
+
+    if (flags & ALLOC_PREFAULT)
+    {
+        // Write so the pages are backed now rather than on first use
+        volatile CHAR* p = region.pMemory;
+        size_t pageSize = GetPageSize();
+        for (size_t i = 0; i < region.bytes; i += pageSize)
+            p[i] = 0;
+        if (region.bytes)
+            p[region.bytes - 1] = 0;
+    }
+
+    // Locking faults in any pages not yet touched
+    if ((flags & ALLOC_MLOCK) && !LockPages(region.pMemory, region.bytes, true))
+        region.flags &= ~ALLOC_MLOCK;
+}
+
+//------------------------------------------------------------------------------
+// ReleaseMemory
+//------------------------------------------------------------------------------
+void Allocator::ReleaseMemory(Region& region)
+{
+    if (!region.pRaw)
+        return;
+
+    if (region.flags & ALLOC_MMAP)
+        UnmapPages(region.pMemory, region.bytes);
+    else
+    {
+        // Unlock first since the locked pages may be shared with other heap memory
+        if (region.flags & ALLOC_MLOCK)
+            LockPages(region.pMemory, region.bytes, false);
+        delete [] region.pRaw;
+    }
+    region.pMemory = NULL;
+    region.pRaw = NULL;
+}
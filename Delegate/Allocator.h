@@ -3,6 +3,34 @@
 
 #include "DataTypes.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/// Allocator memory options. Combine with bitwise OR. The options apply to memory
+/// the allocator obtains itself and are ignored if the caller provides the memory.
+enum AllocatorFlags
+{
+    /// Map memory directly from the operating system instead of the global heap.
+    ALLOC_MMAP = 0x01,
+
+    /// Request explicit huge pages. Falls back to transparent huge pages if none
+    /// are reserved. Implies ALLOC_MMAP.
+    ALLOC_HUGE_PAGES = 0x02,
+
+    /// Advise the kernel to back the memory with transparent huge pages. 
+    /// Implies ALLOC_MMAP.
+    ALLOC_TRANSPARENT_HUGE_PAGES = 0x04,
+
+    /// Touch every page when the memory is obtained so first use never page faults.
+    ALLOC_PREFAULT = 0x08,
+
+    /// Lock the memory into RAM so it is never paged out. 
+    ALLOC_MLOCK = 0x10,
+
+    /// Round the block size up to a multiple of the cache line size and align
+    /// blocks to cache lines so neighbouring blocks never share a line.
+    ALLOC_CACHE_ALIGN = 0x20
+};
 
 /// @see https://github.com/endurodave/Allocator
 /// David Lafreniere
@@ -17,7 +45,12 @@ public:
 	///		to obtain memory from global heap. If not NULL, the objects argument 
 	///		defines the size of the memory block (size x objects = memory size in bytes).
 	///	@param[in]	name - optional allocator name string.
-    Allocator(size_t size, UINT objects=0, CHAR* memory = NULL, const CHAR* name=NULL);
+	/// @param[in]	lockFree - if true, Allocate() and Deallocate() may be called 
+	///		concurrently from any thread without an external lock. 
+	/// @param[in]	flags - AllocatorFlags options for the pool memory, or for the 
+	///		chunks heap blocks are carved from. A pool is prefaulted and locked in
+	///		the constructor; heap blocks chunks as each one is obtained.
+    Allocator(size_t size, UINT objects=0, CHAR* memory = NULL, const CHAR* name=NULL, bool lockFree=false, UINT flags=0);
 
     /// Destructor
     ~Allocator();
@@ -27,10 +60,25 @@ public:
     /// @return     Returns pointer to the block. Otherwise NULL if unsuccessful.
     void* Allocate(size_t size);
 
+    /// Get a free block without growing the storage or reporting exhaustion. 
+    /// @param[in]  size - size of the block to allocate
+    /// @return     Returns pointer to the block. Otherwise NULL if no block is free.
+    void* TryAllocate(size_t size);
+
     /// Return a pointer to the memory pool. 
     /// @param[in]  pBlock - block of memory deallocate (i.e push onto free-list)
     void Deallocate(void* pBlock);
 
+    /// Release free blocks so the memory held tracks the working set rather than the
+    /// historical peak. HEAP_BLOCKS mode only; pools keep their memory. Heap blocks
+    /// carved from chunks are released a whole chunk at a time once every block of 
+    /// the chunk is free, largest chunk first. Not thread safe, call with the same
+    /// lock as Allocate() and Deallocate(). A lock-free allocator is never trimmed 
+    /// since other threads may be reading a free block's link.
+    /// @param[in]  retainBlocks - the number of free blocks to keep for reuse.
+    /// @return     The number of bytes released.
+    size_t Trim(UINT retainBlocks = 0);
+
     /// Get the allocator name string.
     /// @return		A pointer to the allocator name or NULL if none was assigned.
     const CHAR* GetName() { return m_name; }
@@ -39,23 +87,70 @@ public:
     /// @return		The fixed block size in bytes.
     size_t GetBlockSize() { return m_blockSize; }
 
-    /// Gets the maximum number of blocks created by the allocator.
+    /// Gets the number of blocks created by the allocator and not yet trimmed.
     /// @return		The number of fixed memory blocks created.
-    UINT GetBlockCount() { return m_blockCnt; }
+    UINT GetBlockCount() { return m_blockCnt.load(std::memory_order_relaxed); }
 
     /// Gets the number of blocks in use.
     /// @return		The number of blocks in use by the application.
-    UINT GetBlocksInUse() { return m_blocksInUse; }
+    UINT GetBlocksInUse() { return m_blocksInUse.load(std::memory_order_relaxed); }
+
+    /// Gets the highest number of blocks in use at once.
+    /// @return		The blocks in use high-water mark.
+    UINT GetPeakBlocksInUse() { return m_peakBlocksInUse.load(std::memory_order_relaxed); }
 
     /// Gets the total number of allocations for this allocator instance.
     /// @return		The total number of allocations.
-    UINT GetAllocations() { return m_allocations; }
+    UINT GetAllocations() { return m_allocations.load(std::memory_order_relaxed); }
 
     /// Gets the total number of deallocations for this allocator instance.
     /// @return		The total number of deallocations.
-    UINT GetDeallocations() { return m_deallocations; }
+    UINT GetDeallocations() { return m_deallocations.load(std::memory_order_relaxed); }
+
+    /// Gets the number of allocations that failed because the pool was exhausted.
+    /// @return		The number of pool exhaustion events.
+    UINT GetExhaustions() { return m_exhaustions.load(std::memory_order_relaxed); }
+
+    /// Gets the total number of bytes released by Trim().
+    /// @return		The number of bytes reclaimed.
+    unsigned long long GetReclaimedBytes() { return m_reclaimedBytes.load(std::memory_order_relaxed); }
+
+    /// Returns true if the allocator is lock-free.
+    bool IsLockFree() { return m_lockFree; }
+
+    /// Gets the operating system page size mapped memory is rounded up to.
+    /// @return		The page size in bytes.
+    static size_t GetPageSize();
+
+    /// Returns true if the allocator has a fixed pool of blocks.
+    bool IsPool() { return m_maxObjects != 0; }
+
+    /// Check if a block lies within the fixed pool.
+    /// @param[in]  pBlock - the block.
+    /// @return     True if pBlock is a pool block. Always false in HEAP_BLOCKS mode.
+    bool IsPoolBlock(const void* pBlock) 
+    {
+        uintptr_t p = (uintptr_t)pBlock;
+        uintptr_t pool = (uintptr_t)m_pPool;
+        return m_maxObjects && p >= pool && p < pool + m_blockSize * m_maxObjects;
+    }
+
+    /// Gets the AllocatorFlags options in effect for the memory obtained so far. 
+    /// An option is cleared if the operating system refused it for any memory, 
+    /// e.g. no explicit huge pages are reserved or the mlock limit is reached.
+    /// ALLOC_TRANSPARENT_HUGE_PAGES remains set if memory is backed by explicit
+    /// huge pages instead.
+    /// @return		The AllocatorFlags options in effect.
+    UINT GetMemoryFlags() { return m_memoryFlags.load(std::memory_order_relaxed); }
 	
 private:
+    // Prevent copying objects
+    Allocator(const Allocator&) = delete;
+    Allocator& operator=(const Allocator&) = delete;
+
+    /// Update the statistics for an allocated block.
+    void CountAllocation();
+
     /// Push a memory block onto head of free-list.
     /// @param[in]  pMemory - block of memory to push onto free-list
     void Push(void* pMemory);
@@ -64,11 +159,75 @@ private:
     /// @return     Returns pointer to the block. Otherwise NULL if unsuccessful.
     void* Pop();
 
+    /// Lock-free Push(). The block must belong to this allocator.
+    void PushLockFree(void* pMemory);
+
+    /// Lock-free Pop(). Grows the storage in HEAP_BLOCKS mode.
+    void* PopLockFree();
+
+    /// Push a chain of blocks already linked through m_next onto the lock-free free-list.
+    void PushChain(UINT first, UINT last);
+
+    /// Add a new chunk of blocks in lock-free HEAP_BLOCKS mode.
+    /// @return A block from the new chunk or NULL if another thread grew the storage.
+    void* Grow();
+
+    /// Get a block address from its index. Lock-free mode only.
+    CHAR* GetBlock(UINT index);
+
+    /// Get the index of a block. Lock-free mode only.
+    UINT GetIndex(void* pBlock);
+
+    /// Get the next index slot of a block. Lock-free mode only.
+    std::atomic<UINT>& GetNext(UINT index);
+
+    /// Add a new chunk of blocks in chunked HEAP_BLOCKS mode and push all but
+    /// the first block onto the free-list. The chunk takes the lowest free slot.
+    /// @return A block from the new chunk.
+    void* GrowBlocks();
+
+    /// Get the chunk slot holding a block. Chunked HEAP_BLOCKS mode only.
+    UINT FindChunk(void* pBlock);
+
     struct Block
     {
         Block* pNext;
     };
 
+    /// Memory obtained with ObtainMemory()
+    struct Region
+    {
+        CHAR* pMemory;      // Usable memory, aligned as requested
+        CHAR* pRaw;         // Heap allocation or mapping base
+        size_t bytes;       // Usable bytes
+        UINT flags;         // AllocatorFlags options in effect
+    };
+
+    /// Obtain memory from the heap or the operating system and apply the flags.
+    /// Throws std::bad_alloc if no memory is available.
+    /// @param[out] region - receives the memory. A mapping is rounded up to a
+    ///     whole number of pages, so region.bytes may exceed bytes.
+    /// @param[in]  bytes - the number of bytes required.
+    /// @param[in]  flags - the AllocatorFlags options.
+    static void ObtainMemory(Region& region, size_t bytes, UINT flags);
+
+    /// Release memory obtained with ObtainMemory().
+    static void ReleaseMemory(Region& region);
+
+    // Lock-free HEAP_BLOCKS storage grows in chunks. Chunk k holds CHUNK_BLOCKS << k 
+    // blocks so MAX_CHUNKS chunks can index any block count. HEAP_BLOCKS storage
+    // with memory options grows the same way, except each chunk uses all of its 
+    // memory since blocks are never looked up by index and Trim() may free any slot.
+    enum { CHUNK_BLOCKS = 16, MAX_CHUNKS = 27, CACHE_LINE_SIZE = 64 };
+
+    struct Chunk
+    {
+        CHAR* pBlocks;
+        std::atomic<UINT>* pNext;
+        UINT count;
+        Region region;
+    };
+
 	enum AllocatorMode { HEAP_BLOCKS, HEAP_POOL, STATIC_POOL };
 
     const size_t m_blockSize;
@@ -78,19 +237,35 @@ private:
     Block* m_pHead;
     CHAR* m_pPool;
     UINT m_poolIndex;
-    UINT m_blockCnt;
-    UINT m_blocksInUse;
-    UINT m_allocations;
-    UINT m_deallocations;
+    std::atomic<UINT> m_blockCnt;
+    std::atomic<UINT> m_blocksInUse;
+    std::atomic<UINT> m_peakBlocksInUse;
+    std::atomic<UINT> m_allocations;
+    std::atomic<UINT> m_deallocations;
+    std::atomic<UINT> m_exhaustions;
+    std::atomic<unsigned long long> m_reclaimedBytes;
     const CHAR* m_name;
+    const UINT m_flags;
+    const bool m_chunked;                       // HEAP_BLOCKS carved from chunks
+    std::atomic<UINT> m_memoryFlags;
+    Region m_poolRegion;                        // HEAP_POOL mode
+
+    // Lock-free mode. The free-list head packs a generation tag in the upper 32 bits
+    // with the block index + 1 in the lower 32 bits; the tag changes on every 
+    // update to prevent ABA. Each block's next index is kept outside the block. 
+    const bool m_lockFree;
+    std::atomic<unsigned long long> m_freeHead;
+    std::atomic<UINT>* m_pNext;                 // Pool modes
+    std::atomic<Chunk*> m_chunks[MAX_CHUNKS];   // Chunked HEAP_BLOCKS mode
+    std::atomic<UINT> m_chunkCnt;
 };
 
 // Template class to create external memory pool
-template <class T, UINT Objects>
+template <class T, UINT Objects, bool LockFree = false>
 class AllocatorPool : public Allocator
 {
 public:
-	AllocatorPool() : Allocator(sizeof(T), Objects, m_memory)
+	AllocatorPool() : Allocator(sizeof(T), Objects, m_memory, NULL, LockFree)
 	{
 	}
 private:
@@ -113,6 +288,14 @@ private:
 #define IMPLEMENT_ALLOCATOR(class, objects, memory) \
 	Allocator class::_allocator(sizeof(class), objects, memory, #class);
 
+// macro to provide source file interface for a lock-free allocator
+#define IMPLEMENT_ALLOCATOR_LOCK_FREE(class, objects, memory) \
+	Allocator class::_allocator(sizeof(class), objects, memory, #class, true);
+
+// macro to provide source file interface with AllocatorFlags memory options
+#define IMPLEMENT_ALLOCATOR_FLAGS(class, objects, flags) \
+	Allocator class::_allocator(sizeof(class), objects, NULL, #class, false, flags);
+
 #endif
 
 
@@ -6,17 +6,13 @@
 // David Lafreniere, Oct 2022.
 
 #include "DelegateOpt.h"
-#ifdef USE_XALLOCATOR
-	#include "xallocator.h"
-#endif
+#include "DelegateMemoryResource.h"
 
 namespace DelegateLib {
 
 /// @brief Non-template common base class for all delegates.
 class DelegateBase {
-#ifdef USE_XALLOCATOR
-	XALLOCATOR
-#endif
+	DELEGATE_ALLOCATOR
 public:
     virtual ~DelegateBase() = default;
 
@@ -126,6 +122,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   		// Pointer to an instance member function
@@ -173,6 +172,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   		// Pointer to an instance member function
@@ -220,6 +222,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   		// Pointer to an instance member function
@@ -267,6 +272,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   		// Pointer to an instance member function
@@ -314,6 +322,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   		// Pointer to an instance member function
@@ -361,6 +372,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   		// Pointer to an instance member function
@@ -403,6 +417,9 @@ public:
 	void Clear() { m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	FreeFunc GetFunc() const { return m_func; }
+
 private:
 	FreeFunc m_func = nullptr;		// Pointer to a free function
 };
@@ -438,6 +455,9 @@ public:
 	void Clear() { m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	FreeFunc GetFunc() const { return m_func; }
+
 private:
 	FreeFunc m_func = nullptr;		// Pointer to a free function
 };
@@ -474,6 +494,9 @@ public:
 	void Clear() { m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	FreeFunc GetFunc() const { return m_func; }
+
 private:
 	FreeFunc m_func = nullptr;		// Pointer to a free function
 };
@@ -510,6 +533,9 @@ public:
 	void Clear() { m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	FreeFunc GetFunc() const { return m_func; }
+
 private:
 	FreeFunc m_func = nullptr;		// Pointer to a free function
 };
@@ -546,6 +572,9 @@ public:
 	void Clear() { m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	FreeFunc GetFunc() const { return m_func; }
+
 private:
 	FreeFunc m_func = nullptr;		// Pointer to a free function
 };
@@ -582,6 +611,9 @@ public:
 	void Clear() { m_func = 0; }
 	explicit operator bool() const { return !Empty(); }
 
+	/// Get the bound function. Identifies the delegate target.
+	FreeFunc GetFunc() const { return m_func; }
+
 private:
 	FreeFunc m_func = nullptr;		// Pointer to a free function
 };
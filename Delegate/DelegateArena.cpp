@@ -0,0 +1,96 @@
+#include "DelegateArena.h"
+#include "DelegateMemoryResource.h"
+
+namespace DelegateLib
+{
+    // Chunk memory starts after the header, aligned for any fundamental type
+    static const size_t HEADER_SIZE = (sizeof(void*) + sizeof(size_t) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    DelegateArena::DelegateArena(size_t chunkSize) :
+        m_chunkSize(chunkSize),
+        m_pChunks(nullptr),
+        m_pNext(nullptr),
+        m_pEnd(nullptr),
+        m_used(0),
+        m_peak(0),
+        m_capacity(0),
+        m_resets(0),
+        m_chunkAllocations(0)
+    {
+    }
+
+    DelegateArena::~DelegateArena()
+    {
+        FreeChunks();
+    }
+
+    void* DelegateArena::Allocate(size_t size, size_t alignment)
+    {
+        if (size == 0)
+            size = 1;
+
+        size_t pad = (alignment - (reinterpret_cast<size_t>(m_pNext) & (alignment - 1))) & (alignment - 1);
+        if (!m_pChunks || pad + size > (size_t)(m_pEnd - m_pNext))
+        {
+            // Room for the worst case padding in the new chunk
+            AddChunk(size + alignment - 1);
+            pad = (alignment - (reinterpret_cast<size_t>(m_pNext) & (alignment - 1))) & (alignment - 1);
+        }
+
+        char* block = m_pNext + pad;
+        m_pNext = block + size;
+        m_used.store(m_used.load(std::memory_order_relaxed) + pad + size, std::memory_order_relaxed);
+        return block;
+    }
+
+    void DelegateArena::Reset()
+    {
+        size_t used = m_used.load(std::memory_order_relaxed);
+        if (used > m_peak.load(std::memory_order_relaxed))
+            m_peak.store(used, std::memory_order_relaxed);
+
+        if (m_pChunks && m_pChunks->pNext)
+        {
+            // Replace the chunks with one holding the whole cycle
+            size_t capacity = m_capacity.load(std::memory_order_relaxed);
+            FreeChunks();
+            AddChunk(capacity);
+        }
+        else if (m_pChunks)
+        {
+            m_pNext = reinterpret_cast<char*>(m_pChunks) + HEADER_SIZE;
+        }
+
+        m_used.store(0, std::memory_order_relaxed);
+        m_resets.store(m_resets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void DelegateArena::AddChunk(size_t size)
+    {
+        if (size < m_chunkSize)
+            size = m_chunkSize;
+
+        ReportHeapAllocation("DelegateArena", HEADER_SIZE + size);
+        Chunk* chunk = static_cast<Chunk*>(::operator new(HEADER_SIZE + size));
+        chunk->pNext = m_pChunks;
+        chunk->size = size;
+        m_pChunks = chunk;
+        m_pNext = reinterpret_cast<char*>(chunk) + HEADER_SIZE;
+        m_pEnd = m_pNext + size;
+
+        m_capacity.store(m_capacity.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+        m_chunkAllocations.store(m_chunkAllocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void DelegateArena::FreeChunks()
+    {
+        while (m_pChunks)
+        {
+            Chunk* next = m_pChunks->pNext;
+            ::operator delete(m_pChunks);
+            m_pChunks = next;
+        }
+        m_pNext = m_pEnd = nullptr;
+        m_capacity.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef _DELEGATE_ARENA_H
+#define _DELEGATE_ARENA_H
+
+// DelegateArena.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include "DelegateOpt.h"
+#include <stddef.h>
+#include <cstddef>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+#ifdef USE_CXX17
+	#include <memory_resource>
+#endif
+
+namespace DelegateLib {
+
+/// @brief A monotonic bump allocator. Allocate() advances a pointer within a chunk
+/// and nothing is freed individually; Reset() releases every allocation at once.
+/// Each WorkerThread owns an arena that is reset after each message or each batch
+/// of messages, so delegate handlers get scratch memory with no malloc or free.
+///
+/// @details A request that does not fit the current chunk takes a new chunk. On the
+/// next Reset() the chunks are replaced by one chunk large enough for the whole
+/// cycle, so once the arena has seen its peak load every allocation is a pointer
+/// bump. Allocate() and Reset() may only be called by the owning thread. The
+/// statistics may be read from any thread. With USE_CXX17 the arena is also a
+/// std::pmr::memory_resource, e.g. for a std::pmr::vector local to a handler.
+class DelegateArena
+#ifdef USE_CXX17
+	: public std::pmr::memory_resource
+#endif
+{
+public:
+	enum { DEFAULT_CHUNK_SIZE = 16 * 1024 };
+
+	/// Constructor. No memory is obtained until the first allocation.
+	/// @param[in] chunkSize - the minimum chunk size in bytes.
+	explicit DelegateArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+	/// Destructor
+	~DelegateArena();
+
+	/// Allocate storage valid until the next Reset(). Owning thread only.
+	/// @param[in] size - the number of bytes.
+	/// @param[in] alignment - the alignment, a power of two.
+	/// @return The storage. Throws std::bad_alloc if no memory is available.
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	/// Construct an object in the arena. The destructor is never called, so the
+	/// type must be trivially destructible. Owning thread only.
+	template <class T, class... Args>
+	T* New(Args&&... args) {
+		static_assert(std::is_trivially_destructible<T>::value, "DelegateArena objects are never destroyed");
+		return ::new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/// Release every allocation. Owning thread only.
+	void Reset();
+
+	/// Get the bytes allocated since the last Reset(), including alignment padding.
+	size_t GetUsed() const { return m_used.load(std::memory_order_relaxed); }
+
+	/// Get the largest GetUsed() seen before a Reset().
+	size_t GetPeak() const { return m_peak.load(std::memory_order_relaxed); }
+
+	/// Get the bytes held in chunks.
+	size_t GetCapacity() const { return m_capacity.load(std::memory_order_relaxed); }
+
+	/// Get the number of Reset() calls.
+	unsigned long long GetResets() const { return m_resets.load(std::memory_order_relaxed); }
+
+	/// Get the number of chunks obtained from the heap. Stops increasing once the
+	/// arena has grown to its peak load.
+	unsigned long long GetChunkAllocations() const { return m_chunkAllocations.load(std::memory_order_relaxed); }
+
+private:
+	// Prevent copying objects
+	DelegateArena(const DelegateArena&) = delete;
+	DelegateArena& operator=(const DelegateArena&) = delete;
+
+	/// Chunk header. The chunk memory follows the header.
+	struct Chunk
+	{
+		Chunk* pNext;
+		size_t size;
+	};
+
+	/// Obtain a chunk and make it current.
+	/// @param[in] size - the minimum usable bytes.
+	void AddChunk(size_t size);
+
+	/// Free every chunk.
+	void FreeChunks();
+
+#ifdef USE_CXX17
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		return Allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void*, size_t, size_t) override {}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+#endif
+
+	const size_t m_chunkSize;
+	Chunk* m_pChunks;			// Current chunk first
+	char* m_pNext;				// Next free byte in the current chunk
+	char* m_pEnd;				// End of the current chunk
+
+	std::atomic<size_t> m_used;
+	std::atomic<size_t> m_peak;
+	std::atomic<size_t> m_capacity;
+	std::atomic<unsigned long long> m_resets;
+	std::atomic<unsigned long long> m_chunkAllocations;
+};
+
+}
+
+#endif
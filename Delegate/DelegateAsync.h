@@ -8,11 +8,11 @@
 #include "Delegate.h"
 #include "IDelegateThread.h"
 #include "DelegateInvoker.h"
+#include "DelegateConnection.h"
+#include "DelegateLatency.h"
 #include <memory>
 #include <type_traits>
-#ifdef USE_XALLOCATOR
-	#include <new>
-#endif
+#include <new>
 
 namespace DelegateLib {
 
@@ -48,29 +48,21 @@ public:
 	static void Delete(Param param) { }
 };
 
-/// @brief Implement new/delete for pointer parameter values. If USE_ALLOCATOR is
-/// defined, get memory from the fixed block allocator and not global heap.
+/// @brief Implement new/delete for pointer parameter values. Memory comes from 
+/// DelegateAllocate() and not the global heap.
 template <typename Param>
 class DelegateParam<Param *>
 {
 public:
 	static Param* New(Param* param)	{
-#ifdef USE_XALLOCATOR
-		void* mem = xmalloc(sizeof(*param));
+		void* mem = DelegateAllocate(sizeof(*param), typeid(Param).name());
 		Param* newParam = new (mem) Param(*param);
-#else
-		Param* newParam = new Param(*param);
-#endif
 		return newParam;
 	}
 
 	static void Delete(Param* param) {
-#ifdef USE_XALLOCATOR
 		param->~Param();
-		xfree((void*)param);
-#else
-		delete param;
-#endif
+		DelegateDeallocate((void*)param);
 	}
 };
 
@@ -80,29 +72,19 @@ class DelegateParam<Param **>
 {
 public:
 	static Param** New(Param** param) {
-#ifdef USE_XALLOCATOR
-		void* mem = xmalloc(sizeof(*param));
+		void* mem = DelegateAllocate(sizeof(*param), typeid(Param*).name());
 		Param** newParam = new (mem) Param*();
 
-		void* mem2 = xmalloc(sizeof(**param));
+		void* mem2 = DelegateAllocate(sizeof(**param), typeid(Param).name());
 		*newParam = new (mem2) Param(**param);
-#else
-		Param** newParam = new Param*();
-		*newParam = new Param(**param);
-#endif
 		return newParam;
 	}
 
 	static void Delete(Param** param) {
-#ifdef USE_XALLOCATOR
 		(*param)->~Param();
-		xfree((void*)(*param));
+		DelegateDeallocate((void*)(*param));
 
-		xfree((void*)(param));
-#else
-		delete *param;
-		delete param;
-#endif
+		DelegateDeallocate((void*)(param));
 	}
 };
 
@@ -112,22 +94,14 @@ class DelegateParam<Param &>
 {
 public:
 	static Param& New(Param& param)	{
-#ifdef USE_XALLOCATOR
-		void* mem = xmalloc(sizeof(param));
+		void* mem = DelegateAllocate(sizeof(param), typeid(Param).name());
 		Param* newParam = new (mem) Param(param);
-#else
-		Param* newParam = new Param(param);
-#endif
 		return *newParam;
 	}
 
 	static void Delete(Param& param) {
-#ifdef USE_XALLOCATOR
 		(&param)->~Param();
-		xfree((void*)(&param));
-#else
-		delete &param;
-#endif
+		DelegateDeallocate((void*)(&param));
 	}
 };
 
@@ -137,7 +111,7 @@ class DelegateMemberAsync;
 
 /// @brief Asynchronous member delegate that invokes the target function on the specified thread of control.
 template <class TClass> 
-class DelegateMemberAsync<void(TClass(void))> : public DelegateMember<void(TClass(void))>, public IDelegateInvoker {
+class DelegateMemberAsync<void(TClass(void))> : public DelegateMember<void(TClass(void))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef TClass* ObjectPtr;
 	typedef void (TClass::*MemberFunc)();
@@ -170,21 +144,40 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()() override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()();
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsgBase>(delegate);
+		auto msg = MakeShared<DelegateMsgBase>(delegate);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
+
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
 	}
 
 	/// Called by the target thread to invoke the delegate function 
 	virtual void DelegateInvoke(std::shared_ptr<DelegateMsgBase> msg) override {
 		// Invoke the delegate function
 		BaseType::operator()();
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
 	}
 
 private:
@@ -193,7 +186,7 @@ private:
 };
 
 template <class TClass, class Param1> 
-class DelegateMemberAsync<void(TClass(Param1))> : public DelegateMember<void(TClass(Param1))>, public IDelegateInvoker {
+class DelegateMemberAsync<void(TClass(Param1))> : public DelegateMember<void(TClass(Param1))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef TClass* ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1);
@@ -226,19 +219,35 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg1<Param1>>(delegate, heapParam1);
+		auto msg = MakeShared<DelegateMsg1<Param1>>(delegate, heapParam1);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value))),
 			"std::shared_ptr reference argument not allowed");
@@ -258,6 +267,18 @@ public:
 
 		// Delete heap data created inside operator()
 		DelegateParam<Param1>::Delete(param1);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg1<Param1>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
 	}
 
 private:
@@ -266,7 +287,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2> 
-class DelegateMemberAsync<void(TClass(Param1, Param2))> : public DelegateMember<void(TClass(Param1, Param2))>, public IDelegateInvoker {
+class DelegateMemberAsync<void(TClass(Param1, Param2))> : public DelegateMember<void(TClass(Param1, Param2))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef TClass* ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2);
@@ -299,20 +320,36 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg2<Param1, Param2>>(delegate, heapParam1, heapParam2);
+		auto msg = MakeShared<DelegateMsg2<Param1, Param2>>(delegate, heapParam1, heapParam2);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value))),
@@ -335,6 +372,19 @@ public:
 		// Delete heap data created inside operator()
 		DelegateParam<Param1>::Delete(param1);
 		DelegateParam<Param2>::Delete(param2);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg2<Param1, Param2>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
 	}
 
 private:
@@ -343,7 +393,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2, class Param3> 
-class DelegateMemberAsync<void(TClass(Param1, Param2, Param3))> : public DelegateMember<void(TClass(Param1, Param2, Param3))>, public IDelegateInvoker {
+class DelegateMemberAsync<void(TClass(Param1, Param2, Param3))> : public DelegateMember<void(TClass(Param1, Param2, Param3))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef TClass* ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2, Param3);
@@ -376,21 +426,37 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
 		Param3 heapParam3 = DelegateParam<Param3>::New(p3);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg3<Param1, Param2, Param3>>(delegate, heapParam1, heapParam2, heapParam3);
+		auto msg = MakeShared<DelegateMsg3<Param1, Param2, Param3>>(delegate, heapParam1, heapParam2, heapParam3);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -416,6 +482,20 @@ public:
 		DelegateParam<Param1>::Delete(param1);
 		DelegateParam<Param2>::Delete(param2);
 		DelegateParam<Param3>::Delete(param3);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg3<Param1, Param2, Param3>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
 	}
 
 private:
@@ -424,7 +504,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2, class Param3, class Param4> 
-class DelegateMemberAsync<void(TClass(Param1, Param2, Param3, Param4))> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4))>, public IDelegateInvoker {
+class DelegateMemberAsync<void(TClass(Param1, Param2, Param3, Param4))> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef TClass* ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2, Param3, Param4);
@@ -457,6 +537,15 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3, p4);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
@@ -464,15 +553,22 @@ public:
 		Param4 heapParam4 = DelegateParam<Param4>::New(p4);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4);
+		auto msg = MakeShared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -501,6 +597,21 @@ public:
 		DelegateParam<Param2>::Delete(param2);
 		DelegateParam<Param3>::Delete(param3);
 		DelegateParam<Param4>::Delete(param4);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg4<Param1, Param2, Param3, Param4>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
+		DelegateParam<Param4>::Delete(delegateMsg->GetParam4());
 	}
 
 private:
@@ -509,7 +620,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5> 
-class DelegateMemberAsync<void(TClass(Param1, Param2, Param3, Param4, Param5))> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4, Param5))>, public IDelegateInvoker {
+class DelegateMemberAsync<void(TClass(Param1, Param2, Param3, Param4, Param5))> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4, Param5))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef TClass* ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2, Param3, Param4, Param5);
@@ -542,6 +653,15 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3, p4, p5);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
@@ -550,15 +670,22 @@ public:
 		Param5 heapParam5 = DelegateParam<Param5>::New(p5);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4, heapParam5);
+		auto msg = MakeShared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4, heapParam5);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -590,6 +717,22 @@ public:
 		DelegateParam<Param3>::Delete(param3);
 		DelegateParam<Param4>::Delete(param4);
 		DelegateParam<Param5>::Delete(param5);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
+		DelegateParam<Param4>::Delete(delegateMsg->GetParam4());
+		DelegateParam<Param5>::Delete(delegateMsg->GetParam5());
 	}
 
 private:
@@ -599,7 +742,7 @@ private:
 
 /// @brief Asynchronous free delegate that invokes the target function on the specified thread of control.
 template <class Signature>
-class DelegateFreeAsync : public DelegateFree<void(void)>, public IDelegateInvoker {
+class DelegateFreeAsync : public DelegateFree<void(void)>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef void (*FreeFunc)();
     using ClassType = DelegateFreeAsync<void(void)>;
@@ -623,21 +766,40 @@ public:
 
 	// Invoke delegate function asynchronously
 	virtual void operator()() override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()();
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsgBase>(delegate);
+		auto msg = MakeShared<DelegateMsgBase>(delegate);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
+
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
 	}
 
 	// Called to invoke the delegate function on the target thread of control
 	virtual void DelegateInvoke(std::shared_ptr<DelegateMsgBase> msg) override {
 		// Invoke the delegate function
 		BaseType::operator()();
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
 	}
 
 private:
@@ -645,7 +807,7 @@ private:
 };
 
 template <class Param1> 
-class DelegateFreeAsync<void(Param1)> : public DelegateFree<void(Param1)>, public IDelegateInvoker {
+class DelegateFreeAsync<void(Param1)> : public DelegateFree<void(Param1)>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef void (*FreeFunc)(Param1);
     using ClassType = DelegateFreeAsync<void(Param1)>;
@@ -669,19 +831,35 @@ public:
 
 	// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg1<Param1>>(delegate, heapParam1);
+		auto msg = MakeShared<DelegateMsg1<Param1>>(delegate, heapParam1);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value))),
 			"std::shared_ptr reference argument not allowed");
@@ -701,6 +879,18 @@ public:
 
 		// Delete heap data created inside operator()
 		DelegateParam<Param1>::Delete(param1);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg1<Param1>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
 	}
 
 private:
@@ -708,7 +898,7 @@ private:
 };
 
 template <class Param1, class Param2> 
-class DelegateFreeAsync<void(Param1, Param2)> : public DelegateFree<void(Param1, Param2)>, public IDelegateInvoker {
+class DelegateFreeAsync<void(Param1, Param2)> : public DelegateFree<void(Param1, Param2)>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef void (*FreeFunc)(Param1, Param2);
     using ClassType = DelegateFreeAsync<void(Param1, Param2)>;
@@ -732,20 +922,36 @@ public:
 
 	// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg2<Param1, Param2>>(delegate, heapParam1, heapParam2);
+		auto msg = MakeShared<DelegateMsg2<Param1, Param2>>(delegate, heapParam1, heapParam2);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value))),
@@ -768,6 +974,19 @@ public:
 		// Delete heap data created inside operator()
 		DelegateParam<Param1>::Delete(param1);
 		DelegateParam<Param2>::Delete(param2);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg2<Param1, Param2>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
 	}
 
 private:
@@ -775,7 +994,7 @@ private:
 };
 
 template <class Param1, class Param2, class Param3> 
-class DelegateFreeAsync<void(Param1, Param2, Param3)> : public DelegateFree<void(Param1, Param2, Param3)>, public IDelegateInvoker {
+class DelegateFreeAsync<void(Param1, Param2, Param3)> : public DelegateFree<void(Param1, Param2, Param3)>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef void (*FreeFunc)(Param1, Param2, Param3);
     using ClassType = DelegateFreeAsync<void(Param1, Param2, Param3)>;
@@ -799,21 +1018,37 @@ public:
 
 	// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
 		Param3 heapParam3 = DelegateParam<Param3>::New(p3);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg3<Param1, Param2, Param3>>(delegate, heapParam1, heapParam2, heapParam3);
+		auto msg = MakeShared<DelegateMsg3<Param1, Param2, Param3>>(delegate, heapParam1, heapParam2, heapParam3);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -839,6 +1074,20 @@ public:
 		DelegateParam<Param1>::Delete(param1);
 		DelegateParam<Param2>::Delete(param2);
 		DelegateParam<Param3>::Delete(param3);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg3<Param1, Param2, Param3>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
 	}
 
 private:
@@ -846,7 +1095,7 @@ private:
 };
 
 template <class Param1, class Param2, class Param3, class Param4> 
-class DelegateFreeAsync<void(Param1, Param2, Param3, Param4)> : public DelegateFree<void(Param1, Param2, Param3, Param4)>, public IDelegateInvoker {
+class DelegateFreeAsync<void(Param1, Param2, Param3, Param4)> : public DelegateFree<void(Param1, Param2, Param3, Param4)>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef void (*FreeFunc)(Param1, Param2, Param3, Param4);
     using ClassType = DelegateFreeAsync<void(Param1, Param2, Param3, Param4)>;
@@ -870,6 +1119,15 @@ public:
 
 	// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3, p4);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
@@ -877,15 +1135,22 @@ public:
 		Param4 heapParam4 = DelegateParam<Param4>::New(p4);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4);
+		auto msg = MakeShared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -914,6 +1179,21 @@ public:
 		DelegateParam<Param2>::Delete(param2);
 		DelegateParam<Param3>::Delete(param3);
 		DelegateParam<Param4>::Delete(param4);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg4<Param1, Param2, Param3, Param4>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
+		DelegateParam<Param4>::Delete(delegateMsg->GetParam4());
 	}
 
 private:
@@ -921,7 +1201,7 @@ private:
 };
 
 template <class Param1, class Param2, class Param3, class Param4, class Param5> 
-class DelegateFreeAsync<void(Param1, Param2, Param3, Param4, Param5)> : public DelegateFree<void(Param1, Param2, Param3, Param4, Param5)>, public IDelegateInvoker {
+class DelegateFreeAsync<void(Param1, Param2, Param3, Param4, Param5)> : public DelegateFree<void(Param1, Param2, Param3, Param4, Param5)>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef void (*FreeFunc)(Param1, Param2, Param3, Param4, Param5);
     using ClassType = DelegateFreeAsync<void(Param1, Param2, Param3, Param4, Param5)>;
@@ -945,6 +1225,15 @@ public:
 
 	// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3, p4, p5);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
@@ -953,15 +1242,22 @@ public:
 		Param5 heapParam5 = DelegateParam<Param5>::New(p5);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4, heapParam5);
+		auto msg = MakeShared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4, heapParam5);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -993,6 +1289,22 @@ public:
 		DelegateParam<Param3>::Delete(param3);
 		DelegateParam<Param4>::Delete(param4);
 		DelegateParam<Param5>::Delete(param5);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
+		DelegateParam<Param4>::Delete(delegateMsg->GetParam4());
+		DelegateParam<Param5>::Delete(delegateMsg->GetParam5());
 	}
 
 private:
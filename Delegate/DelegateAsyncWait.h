@@ -9,6 +9,8 @@
 #include "IDelegateThread.h"
 #include "DelegateInvoker.h"
 #include "Semaphore.h"
+#include "DelegateLatency.h"
+#include "DelegateTrace.h"
 #include <memory>
 #ifdef USE_CXX17
 #include <optional>
@@ -144,20 +146,26 @@ public:
 			return BaseType::operator()();
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsgBase>(delegate);
+			auto msg = MakeShared<DelegateMsgBase>(delegate);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -185,6 +193,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -268,20 +284,26 @@ public:
 			return BaseType::operator()(p1);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg1<Param1>>(delegate, p1);
+			auto msg = MakeShared<DelegateMsg1<Param1>>(delegate, p1);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -316,6 +338,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -399,20 +429,26 @@ public:
 			return BaseType::operator()(p1, p2);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg2<Param1, Param2>>(delegate, p1, p2);
+			auto msg = MakeShared<DelegateMsg2<Param1, Param2>>(delegate, p1, p2);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -448,6 +484,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -531,20 +575,26 @@ public:
 			return BaseType::operator()(p1, p2, p3);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg3<Param1, Param2, Param3>>(delegate, p1, p2, p3);
+			auto msg = MakeShared<DelegateMsg3<Param1, Param2, Param3>>(delegate, p1, p2, p3);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -581,6 +631,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2, param3);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -664,20 +722,26 @@ public:
 			return BaseType::operator()(p1, p2, p3, p4);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, p1, p2, p3, p4);
+			auto msg = MakeShared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, p1, p2, p3, p4);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -715,6 +779,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2, param3, param4);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -798,20 +870,26 @@ public:
 			return BaseType::operator()(p1, p2, p3, p4, p5);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, p1, p2, p3, p4, p5);
+			auto msg = MakeShared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, p1, p2, p3, p4, p5);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -850,6 +928,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2, param3, param4, param5);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -931,20 +1017,26 @@ public:
 			return BaseType::operator()();
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsgBase>(delegate);
+			auto msg = MakeShared<DelegateMsgBase>(delegate);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 }
@@ -972,6 +1064,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -1043,20 +1143,26 @@ public:
 			return BaseType::operator()(p1);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg1<Param1>>(delegate, p1);
+			auto msg = MakeShared<DelegateMsg1<Param1>>(delegate, p1);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -1091,6 +1197,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -1163,20 +1277,26 @@ public:
 			return BaseType::operator()(p1, p2);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg2<Param1, Param2>>(delegate, p1, p2);
+			auto msg = MakeShared<DelegateMsg2<Param1, Param2>>(delegate, p1, p2);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -1212,6 +1332,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -1283,20 +1411,26 @@ public:
 			return BaseType::operator()(p1, p2, p3);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg3<Param1, Param2, Param3>>(delegate, p1, p2, p3);
+			auto msg = MakeShared<DelegateMsg3<Param1, Param2, Param3>>(delegate, p1, p2, p3);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -1333,6 +1467,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2, param3);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -1404,20 +1546,26 @@ public:
 			return BaseType::operator()(p1, p2, p3, p4);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, p1, p2, p3, p4);
+			auto msg = MakeShared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, p1, p2, p3, p4);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -1455,6 +1603,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2, param3, param4);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -1526,20 +1682,26 @@ public:
 			return BaseType::operator()(p1, p2, p3, p4, p5);
 		else {
 			// Create a clone instance of this delegate 
-			auto delegate = std::shared_ptr<ClassType>(Clone());
+			auto delegate = MakeSharedClone(Clone());
 			delegate->m_sema.Create();
 			delegate->m_sema.Reset();
 
 			// Create a new message instance 
-			auto msg = std::make_shared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, p1, p2, p3, p4, p5);
+			auto msg = MakeShared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, p1, p2, p3, p4, p5);
+			msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), DelegateLatency::Now());
+
+			// Trace the round trip if DelegateTrace is enabled
+			DelegateTrace::WaitBegin(msg->GetTarget());
 
 			// Dispatch message onto the callback destination thread. DelegateInvoke()
 			// will be called by the target thread. 
 			m_thread.DispatchDelegate(msg);
 
-			// Wait for target thread to execute the delegate function
-			if ((m_success = delegate->m_sema.Wait(this->m_timeout)))
+			// Wait for target thread to execute the delegate function. A discarded 
+			// message releases the wait without success.
+			if ((m_success = delegate->m_sema.Wait(this->m_timeout) && delegate->m_success))
 				m_invoke = delegate->m_invoke;
+			DelegateTrace::WaitEnd(msg->GetTarget());
 
 			return m_invoke.GetRetVal();
 		}
@@ -1578,6 +1740,14 @@ public:
 		// Invoke the delegate function then signal the waiting thread
 		m_sync = true;
 		m_invoke(this, param1, param2, param3, param4, param5);
+		m_success = true;
+		this->m_sema.Signal();
+	}
+
+	/// Called by the target thread instead of DelegateInvoke() when the message is 
+	/// discarded. Releases the waiting thread without success.
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) override {
+		m_success = false;
 		this->m_sema.Signal();
 	}
 
@@ -0,0 +1,194 @@
+#include "DelegateBatchTransport.h"
+#include "DelegateRemoteInvoker.h"
+#include "DelegateEncodeBuffer.h"
+#include "Fault.h"
+#include <cstring>
+#include <stdint.h>
+
+namespace DelegateLib
+{
+    DelegateBatchTransport::DelegateBatchTransport(IDelegateSpanTransport& transport, size_t batchSize,
+        std::chrono::microseconds maxDelay) :
+        m_transport(transport),
+        m_batchSize(batchSize),
+        m_maxDelay(maxDelay),
+        m_messages(0),
+        m_batches(0),
+        m_bytes(0)
+    {
+        m_thread = std::thread(&DelegateBatchTransport::Process, this);
+    }
+
+    DelegateBatchTransport::~DelegateBatchTransport()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_exit = true;
+        }
+        m_ioReady.notify_one();
+        m_thread.join();
+    }
+
+    char* DelegateBatchTransport::BeginMessage(std::unique_lock<std::mutex>& lock, size_t size)
+    {
+        // Wait for the I/O thread if it has fallen behind
+        m_sendersReady.wait(lock, [this]() { return m_pending.size() < MAX_PENDING_BATCHES; });
+
+        if (m_current.empty())
+        {
+            m_currentStart = std::chrono::steady_clock::now();
+            m_ioReady.notify_one();
+        }
+
+        // Length header in little-endian byte order
+        size_t offset = m_current.size();
+        m_current.resize(offset + FRAME_HEADER_SIZE + size);
+        uint32_t length = static_cast<uint32_t>(size);
+        for (int i = 0; i < FRAME_HEADER_SIZE; i++)
+            m_current[offset + i] = static_cast<char>(length >> (8 * i));
+        return m_current.data() + offset + FRAME_HEADER_SIZE;
+    }
+
+    void DelegateBatchTransport::EndMessage()
+    {
+        m_messages.fetch_add(1, std::memory_order_relaxed);
+        if (m_current.size() >= m_batchSize)
+            Seal();
+    }
+
+    void DelegateBatchTransport::Seal()
+    {
+        if (m_current.empty())
+            return;
+
+        m_pending.push_back(std::move(m_current));
+        m_current.clear();
+        if (!m_spare.empty())
+        {
+            m_current.swap(m_spare.back());
+            m_spare.pop_back();
+        }
+        m_sealed++;
+        m_ioReady.notify_one();
+    }
+
+    void DelegateBatchTransport::DispatchDelegate(std::iostream& s)
+    {
+        // A leased encode stream holds exactly one message
+        DelegateEncodeStream* encodeStream = dynamic_cast<DelegateEncodeStream*>(&s);
+        if (encodeStream)
+        {
+            DelegateSpan span = { encodeStream->GetData(), encodeStream->GetSize() };
+            DispatchDelegate(&span, 1);
+            return;
+        }
+
+        // Any other stream is read from its read position to its end
+        std::streampos begin = s.tellg();
+        ASSERT_TRUE(begin != std::streampos(-1));
+        s.seekg(0, std::ios_base::end);
+        std::streamoff size = s.tellg() - begin;
+        s.seekg(begin);
+        ASSERT_TRUE(size >= 0 && (unsigned long long)size <= UINT32_MAX);
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        char* message = BeginMessage(lock, (size_t)size);
+        s.read(message, size);
+        EndMessage();
+    }
+
+    void DelegateBatchTransport::DispatchDelegate(const DelegateSpan* spans, size_t count)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < count; i++)
+            size += spans[i].size;
+        ASSERT_TRUE(size <= UINT32_MAX);
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        char* message = BeginMessage(lock, size);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (spans[i].size)
+                memcpy(message, spans[i].data, spans[i].size);
+            message += spans[i].size;
+        }
+        EndMessage();
+    }
+
+    void DelegateBatchTransport::Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        Seal();
+        unsigned long long sealed = m_sealed;
+        m_sendersReady.wait(lock, [this, sealed]() { return m_written >= sealed; });
+    }
+
+    void DelegateBatchTransport::Process()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;)
+        {
+            // Seal the current batch once its oldest message has waited long enough
+            while (m_pending.empty())
+            {
+                if (!m_current.empty())
+                {
+                    auto deadline = m_currentStart + m_maxDelay;
+                    if (m_exit || std::chrono::steady_clock::now() >= deadline)
+                        Seal();
+                    else
+                        m_ioReady.wait_until(lock, deadline);
+                }
+                else if (m_exit)
+                {
+                    return;
+                }
+                else
+                {
+                    m_ioReady.wait(lock);
+                }
+            }
+
+            std::vector<char> batch = std::move(m_pending.front());
+            m_pending.pop_front();
+
+            // Write without the lock so senders keep filling the next batch
+            lock.unlock();
+            DelegateSpan span = { batch.data(), batch.size() };
+            m_transport.DispatchDelegate(&span, 1);
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            m_bytes.fetch_add(batch.size(), std::memory_order_relaxed);
+            batch.clear();
+            lock.lock();
+
+            m_spare.push_back(std::move(batch));
+            m_written++;
+            m_sendersReady.notify_all();
+        }
+    }
+
+    size_t DelegateBatchTransport::InvokeBatch(const void* data, size_t size)
+    {
+        const unsigned char* next = static_cast<const unsigned char*>(data);
+        const unsigned char* end = next + size;
+        size_t invoked = 0;
+        while (next < end)
+        {
+            // A batch from the remote system may be truncated or corrupted, so 
+            // stop at the first incomplete message rather than fault
+            if (end - next < FRAME_HEADER_SIZE)
+                break;
+            uint32_t length = 0;
+            for (int i = 0; i < FRAME_HEADER_SIZE; i++)
+                length |= (uint32_t)next[i] << (8 * i);
+            next += FRAME_HEADER_SIZE;
+            if ((size_t)(end - next) < length)
+                break;
+
+            if (DelegateRemoteInvoker::Invoke(next, length))
+                invoked++;
+            next += length;
+        }
+        return invoked;
+    }
+}
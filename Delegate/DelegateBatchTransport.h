@@ -0,0 +1,113 @@
+#ifndef _DELEGATE_BATCH_TRANSPORT_H
+#define _DELEGATE_BATCH_TRANSPORT_H
+
+// DelegateBatchTransport.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include "DelegateTransport.h"
+#include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DelegateLib {
+
+/// @brief A transport that packs many remote delegate messages into one write.
+/// Senders use it like any other transport. Each message is copied into the
+/// current batch behind a 4 byte little-endian length. A batch is sealed when it
+/// reaches the batch size, when its oldest message has waited the maximum delay,
+/// or on Flush(). A dedicated I/O thread hands each sealed batch to the downstream
+/// transport as one span, so one write or syscall carries many calls.
+///
+/// @details The remote system passes each received batch to InvokeBatch(), which
+/// invokes every message in order. Senders block only when the I/O thread falls
+/// MAX_PENDING_BATCHES behind. Buffers are reused, so a steady stream of messages
+/// does not allocate. The downstream transport is only called by the I/O thread.
+class DelegateBatchTransport : public IDelegateTransport, public IDelegateSpanTransport
+{
+public:
+	enum { DEFAULT_BATCH_SIZE = 64 * 1024, MAX_PENDING_BATCHES = 8, FRAME_HEADER_SIZE = 4 };
+
+	/// Constructor. Starts the I/O thread.
+	/// @param[in] transport - the downstream transport that sends each batch.
+	/// @param[in] batchSize - seal a batch once it holds this many bytes.
+	/// @param[in] maxDelay - seal a batch once its oldest message has waited this long.
+	explicit DelegateBatchTransport(IDelegateSpanTransport& transport, size_t batchSize = DEFAULT_BATCH_SIZE,
+		std::chrono::microseconds maxDelay = std::chrono::microseconds(1000));
+
+	/// Destructor. Sends the pending messages and stops the I/O thread.
+	~DelegateBatchTransport();
+
+	/// Add a message to the current batch. Reads s to its end.
+	virtual void DispatchDelegate(std::iostream& s) override;
+
+	/// Add a message to the current batch
+	virtual void DispatchDelegate(const DelegateSpan* spans, size_t count) override;
+
+	/// Seal the current batch and wait until every message added before the call
+	/// has been handed to the downstream transport.
+	void Flush();
+
+	/// Invoke each message of a batch received on the remote system. A truncated
+	/// or corrupted batch is invoked up to its first incomplete message.
+	/// @param[in] data - the batch.
+	/// @param[in] size - the batch size in bytes.
+	/// @return The number of messages that found a remote delegate.
+	static size_t InvokeBatch(const void* data, size_t size);
+
+	/// Get the number of messages added
+	unsigned long long GetMessages() const { return m_messages.load(std::memory_order_relaxed); }
+
+	/// Get the number of batches handed to the downstream transport
+	unsigned long long GetBatches() const { return m_batches.load(std::memory_order_relaxed); }
+
+	/// Get the number of bytes handed to the downstream transport
+	unsigned long long GetBytes() const { return m_bytes.load(std::memory_order_relaxed); }
+
+private:
+	// Prevent copying objects
+	DelegateBatchTransport(const DelegateBatchTransport&) = delete;
+	DelegateBatchTransport& operator=(const DelegateBatchTransport&) = delete;
+
+	/// Reserve room for a message in the current batch. Lock held.
+	/// @return The message storage, after its length header.
+	char* BeginMessage(std::unique_lock<std::mutex>& lock, size_t size);
+
+	/// Count the message and seal the batch if full. Lock held.
+	void EndMessage();
+
+	/// Move the current batch to the pending queue. Lock held.
+	void Seal();
+
+	/// I/O thread entry function
+	void Process();
+
+	IDelegateSpanTransport& m_transport;
+	const size_t m_batchSize;
+	const std::chrono::microseconds m_maxDelay;
+
+	std::mutex m_lock;
+	std::condition_variable m_ioReady;				// Signals the I/O thread
+	std::condition_variable m_sendersReady;			// Signals blocked senders and Flush()
+	std::vector<char> m_current;					// Batch being filled
+	std::chrono::steady_clock::time_point m_currentStart;	// When the first message was added
+	std::deque<std::vector<char>> m_pending;		// Sealed batches, oldest first
+	std::vector<std::vector<char>> m_spare;			// Written batches kept for reuse
+	unsigned long long m_sealed = 0;
+	unsigned long long m_written = 0;
+	bool m_exit = false;
+
+	std::atomic<unsigned long long> m_messages;
+	std::atomic<unsigned long long> m_batches;
+	std::atomic<unsigned long long> m_bytes;
+
+	std::thread m_thread;
+};
+
+}
+
+#endif
@@ -0,0 +1,516 @@
+#ifndef _DELEGATE_CODEC_H
+#define _DELEGATE_CODEC_H
+
+// DelegateCodec.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+//
+// A codec encodes the delegate id and arguments of a remote delegate into the
+// std::iostream handed to IDelegateTransport, and decodes them on the remote system.
+// The codec is a template argument of DelegateRemoteSend<>, DelegateFreeRemoteRecv<>
+// and DelegateMemberRemoteRecv<>, so each delegate selects its own. Sender and
+// receiver of a delegate id must use the same codec.
+//
+// DelegateTextCodec is the default. Each value is formatted with operator<< and
+// parsed with operator>>, terminated by a null character.
+//
+// DelegateBinaryCodec writes a compact little-endian encoding:
+//  - bool and 1 byte integers as one byte
+//  - other integers and enums as varints, signed values zigzag encoded
+//  - float and double as fixed width IEEE 754 values
+//  - std::string and containers as a varint length followed by the elements;
+//    vectors of trivially copyable elements are copied in one block
+//  - DelegateBytes as a varint length followed by the viewed bytes
+//  - structs declaring DELEGATE_REFLECT(...) field by field
+//  - any other trivially copyable type as its memory image, which assumes both
+//    systems share the type layout and byte order
+// Pointer and reference arguments are encoded as the value referred to. A length
+// longer than the rest of the message fails the stream, and the receiver drops
+// the message.
+//
+// The binary codec also writes to a DelegateSpanWriter for an IDelegateSpanTransport.
+// Large blocks are then referenced in place rather than copied.
+
+#include "DelegateRemoteInvoker.h"
+#include "DelegateSpan.h"
+#include "Fault.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <set>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+/// Declare the fields the binary codec encodes, in order. Place inside the struct
+/// after the fields. Pointer fields are not supported.
+/// @code
+/// struct Position
+/// {
+///     int x;
+///     int y;
+///     std::string name;
+///     DELEGATE_REFLECT(x, y, name)
+/// };
+/// @endcode
+#define DELEGATE_REFLECT(...) \
+    public: \
+        auto DelegateFields() -> decltype(std::tie(__VA_ARGS__)) { return std::tie(__VA_ARGS__); } \
+        auto DelegateFields() const -> decltype(std::tie(__VA_ARGS__)) { return std::tie(__VA_ARGS__); }
+
+namespace DelegateLib {
+
+/// @brief The default codec. Formats values as text with the stream operators.
+struct DelegateTextCodec
+{
+    static void WriteId(std::ostream& s, DelegateIdType id) { s << id << std::ends; }
+
+    static void ReadId(std::istream& s, DelegateIdType& id) {
+        s >> id;
+        s.seekg(s.tellg() + std::streampos(1));
+    }
+
+    template <class T>
+    static void Write(std::ostream& s, const T& value) { s << value << std::ends; }
+
+    template <class T>
+    static void Read(std::istream& s, T& value) {
+        s >> value;
+        s.seekg(s.tellg() + std::streampos(1));
+    }
+};
+
+template <class T, class Enable = void>
+struct BinaryValue;     // Specialized for each supported type below
+
+/// @brief A compact binary codec. See the top of DelegateCodec.h for the encoding.
+struct DelegateBinaryCodec
+{
+    /// The first byte of every binary frame. Text frames start with a digit or '-'.
+    enum { MAGIC = 0xB5 };
+
+    template <class Out>
+    static void WriteId(Out& s, DelegateIdType id) {
+        s.put((char)MAGIC);
+        Write(s, id);
+    }
+
+    static void ReadId(std::istream& s, DelegateIdType& id) {
+        // A text frame sent to a binary codec delegate is dropped like other malformed input
+        if (s.get() != MAGIC)
+        {
+            s.setstate(std::ios_base::failbit);
+            return;
+        }
+        Read(s, id);
+    }
+
+    template <class Out, class T>
+    static void Write(Out& s, const T& value) { BinaryValue<T>::Write(s, value); }
+
+    template <class Out, class T>
+    static void Write(Out& s, T* value) { Write(s, *value); }
+
+    template <class T>
+    static void Read(std::istream& s, T& value) { BinaryValue<T>::Read(s, value); }
+
+    template <class T>
+    static void Read(std::istream& s, T* value) { Read(s, *value); }
+
+    /// Decode a const pointer or reference argument into its non-const storage
+    template <class T>
+    static void Read(std::istream& s, const T& value) { Read(s, const_cast<T&>(value)); }
+
+    template <class Out>
+    static void WriteVarint(Out& s, uint64_t value) {
+        char buf[10];
+        size_t len = 0;
+        while (value >= 0x80)
+        {
+            buf[len++] = (char)(value | 0x80);
+            value >>= 7;
+        }
+        buf[len++] = (char)value;
+        s.write(buf, len);
+    }
+
+    static uint64_t ReadVarint(std::istream& s) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            int c = s.get();
+            if (c == std::char_traits<char>::eof())
+                break;
+            value |= (uint64_t)(c & 0x7F) << shift;
+            if (!(c & 0x80))
+                break;
+        }
+        return value;
+    }
+
+    /// Values are read at most this many bytes at a time
+    enum { READ_CHUNK = 65536 };
+
+    /// Read a string or container length. A length longer than the bytes left in the 
+    /// message is malformed, so fail the stream rather than allocate it.
+    /// @param[in] s - the input stream.
+    /// @param[in] elementSize - the fewest bytes each element is encoded in.
+    /// @return The length, or 0 if malformed.
+    static size_t ReadLength(std::istream& s, size_t elementSize = 1) {
+        uint64_t length = ReadVarint(s);
+        if (!s || length > (uint64_t)SIZE_MAX / elementSize)
+        {
+            s.setstate(std::ios_base::failbit);
+            return 0;
+        }
+
+        // Bytes already buffered are certainly in the message, so only look further 
+        // when the length runs past them
+        std::streambuf* buf = s.rdbuf();
+        std::streamsize avail = buf->in_avail();
+        if (avail >= 0 && length <= (uint64_t)avail / elementSize)
+            return (size_t)length;
+
+        std::streamoff remaining = Remaining(s);
+        if (remaining >= 0 && length > (uint64_t)remaining / elementSize)
+        {
+            s.setstate(std::ios_base::failbit);
+            return 0;
+        }
+        return (size_t)length;
+    }
+
+    /// Get the bytes left in the message. in_avail() is only the buffered window of a
+    /// file or socket stream, so seek to the end instead.
+    /// @return The bytes left, or -1 if the stream cannot seek. Readers then grow the 
+    /// value as the bytes arrive, so a bogus length fails on the missing bytes.
+    static std::streamoff Remaining(std::istream& s) {
+        std::streambuf* buf = s.rdbuf();
+        std::streampos pos = buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        if (pos == std::streampos(-1))
+            return -1;
+        std::streampos end = buf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+        buf->pubseekpos(pos, std::ios_base::in);
+        if (end == std::streampos(-1))
+            return -1;
+        return end - pos;
+    }
+
+    /// Read length elements of a string or vector encoded as their memory image. The
+    /// value grows one chunk at a time so it is never larger than the bytes received.
+    template <class Container>
+    static void ReadBlocks(std::istream& s, Container& value, size_t length) {
+        typedef typename Container::value_type T;
+        const size_t chunk = READ_CHUNK / sizeof(T) ? READ_CHUNK / sizeof(T) : 1;
+        value.clear();
+        while (value.size() < length && s)
+        {
+            size_t offset = value.size();
+            size_t count = length - offset < chunk ? length - offset : chunk;
+            value.resize(offset + count);
+            s.read(reinterpret_cast<char*>(&value[offset]), count * sizeof(T));
+        }
+    }
+
+    /// Read length elements of a container one at a time
+    template <class Container>
+    static void ReadElements(std::istream& s, Container& value, size_t length) {
+        value.clear();
+        for (size_t i = 0; i < length && s; i++)
+        {
+            value.emplace_back();
+            Read(s, value.back());
+        }
+    }
+
+    /// Write a fixed width value in little-endian byte order
+    template <class Out>
+    static void WriteFixed(Out& s, const void* value, size_t size) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        const char* bytes = static_cast<const char*>(value);
+        for (size_t i = size; i > 0; i--)
+            s.put(bytes[i - 1]);
+#else
+        s.write(static_cast<const char*>(value), size);
+#endif
+    }
+
+    /// Write a block of bytes. A DelegateSpanWriter references a large block in place.
+    static void WriteBlock(std::ostream& s, const void* data, size_t size) { s.write(static_cast<const char*>(data), size); }
+    static void WriteBlock(DelegateSpanWriter& s, const void* data, size_t size) { s.WriteBlock(data, size); }
+
+    /// Read a fixed width value in little-endian byte order
+    static void ReadFixed(std::istream& s, void* value, size_t size) {
+        s.read(static_cast<char*>(value), size);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        char* bytes = static_cast<char*>(value);
+        for (size_t i = 0; i < size / 2; i++)
+            std::swap(bytes[i], bytes[size - 1 - i]);
+#endif
+    }
+};
+
+/// True if T declares DELEGATE_REFLECT(...)
+template <class T>
+struct has_delegate_fields
+{
+private:
+    template <class U> static auto Test(int) -> decltype(std::declval<U&>().DelegateFields(), std::true_type());
+    template <class U> static std::false_type Test(...);
+public:
+    static const bool value = decltype(Test<T>(0))::value;
+};
+
+/// True if the binary codec encodes T as its memory image
+template <class T>
+struct is_binary_image
+{
+    static const bool value = std::is_class<T>::value && std::is_trivially_copyable<T>::value &&
+        !has_delegate_fields<T>::value && !std::is_same<T, DelegateBytes>::value;
+};
+
+/// bool and 1 byte integers
+template <class T>
+struct BinaryValue<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 1>::type>
+{
+    template <class Out>
+    static void Write(Out& s, T value) { s.put((char)value); }
+    static void Read(std::istream& s, T& value) { value = (T)s.get(); }
+};
+
+/// Unsigned integers as varints
+template <class T>
+struct BinaryValue<T, typename std::enable_if<std::is_integral<T>::value && (sizeof(T) > 1) && std::is_unsigned<T>::value>::type>
+{
+    template <class Out>
+    static void Write(Out& s, T value) { DelegateBinaryCodec::WriteVarint(s, value); }
+    static void Read(std::istream& s, T& value) { value = (T)DelegateBinaryCodec::ReadVarint(s); }
+};
+
+/// Signed integers as zigzag varints so small negative values stay short
+template <class T>
+struct BinaryValue<T, typename std::enable_if<std::is_integral<T>::value && (sizeof(T) > 1) && std::is_signed<T>::value>::type>
+{
+    template <class Out>
+    static void Write(Out& s, T value) {
+        int64_t v = value;
+        DelegateBinaryCodec::WriteVarint(s, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+    }
+    static void Read(std::istream& s, T& value) {
+        uint64_t v = DelegateBinaryCodec::ReadVarint(s);
+        value = (T)(int64_t)((v >> 1) ^ (~(v & 1) + 1));
+    }
+};
+
+/// Enums as their underlying integer
+template <class T>
+struct BinaryValue<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+    typedef typename std::underlying_type<T>::type Underlying;
+    template <class Out>
+    static void Write(Out& s, T value) { BinaryValue<Underlying>::Write(s, (Underlying)value); }
+    static void Read(std::istream& s, T& value) {
+        Underlying v;
+        BinaryValue<Underlying>::Read(s, v);
+        value = (T)v;
+    }
+};
+
+/// float and double
+template <class T>
+struct BinaryValue<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    template <class Out>
+    static void Write(Out& s, T value) { DelegateBinaryCodec::WriteFixed(s, &value, sizeof(T)); }
+    static void Read(std::istream& s, T& value) { DelegateBinaryCodec::ReadFixed(s, &value, sizeof(T)); }
+};
+
+/// Structs declaring DELEGATE_REFLECT(...)
+template <size_t I, size_t N>
+struct BinaryFields
+{
+    template <class Out, class Tuple>
+    static void Write(Out& s, const Tuple& fields) {
+        DelegateBinaryCodec::Write(s, std::get<I>(fields));
+        BinaryFields<I + 1, N>::Write(s, fields);
+    }
+    template <class Tuple>
+    static void Read(std::istream& s, Tuple& fields) {
+        DelegateBinaryCodec::Read(s, std::get<I>(fields));
+        BinaryFields<I + 1, N>::Read(s, fields);
+    }
+};
+
+template <size_t N>
+struct BinaryFields<N, N>
+{
+    template <class Out, class Tuple> static void Write(Out&, const Tuple&) {}
+    template <class Tuple> static void Read(std::istream&, Tuple&) {}
+};
+
+template <class T>
+struct BinaryValue<T, typename std::enable_if<has_delegate_fields<T>::value>::type>
+{
+    template <class Out>
+    static void Write(Out& s, const T& value) {
+        auto fields = value.DelegateFields();
+        BinaryFields<0, std::tuple_size<decltype(fields)>::value>::Write(s, fields);
+    }
+    static void Read(std::istream& s, T& value) {
+        auto fields = value.DelegateFields();
+        BinaryFields<0, std::tuple_size<decltype(fields)>::value>::Read(s, fields);
+    }
+};
+
+/// Other trivially copyable types as their memory image
+template <class T>
+struct BinaryValue<T, typename std::enable_if<is_binary_image<T>::value>::type>
+{
+    template <class Out>
+    static void Write(Out& s, const T& value) { DelegateBinaryCodec::WriteBlock(s, &value, sizeof(T)); }
+    static void Read(std::istream& s, T& value) { s.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+};
+
+template <>
+struct BinaryValue<std::string>
+{
+    template <class Out>
+    static void Write(Out& s, const std::string& value) {
+        DelegateBinaryCodec::WriteVarint(s, value.size());
+        DelegateBinaryCodec::WriteBlock(s, value.data(), value.size());
+    }
+    static void Read(std::istream& s, std::string& value) {
+        DelegateBinaryCodec::ReadBlocks(s, value, DelegateBinaryCodec::ReadLength(s));
+    }
+};
+
+/// Byte views. Sent in place by a DelegateSpanWriter and received as a view of the
+/// DelegateSpanReader buffer, so the payload is never copied.
+template <>
+struct BinaryValue<DelegateBytes>
+{
+    template <class Out>
+    static void Write(Out& s, const DelegateBytes& value) {
+        DelegateBinaryCodec::WriteVarint(s, value.size);
+        DelegateBinaryCodec::WriteBlock(s, value.data, value.size);
+    }
+    static void Read(std::istream& s, DelegateBytes& value) {
+        size_t size = (size_t)DelegateBinaryCodec::ReadVarint(s);
+
+        // Only a message passed to DelegateRemoteInvoker::Invoke(const void*, size_t) can be viewed
+        DelegateSpanReader* reader = dynamic_cast<DelegateSpanReader*>(&s);
+        ASSERT_TRUE(reader != nullptr);
+
+        // Take() fails the stream if the message is shorter than the length
+        const char* data = reader->Take(size);
+        value = data ? DelegateBytes(data, size) : DelegateBytes();
+    }
+};
+
+template <class T1, class T2>
+struct BinaryValue<std::pair<T1, T2>>
+{
+    template <class Out>
+    static void Write(Out& s, const std::pair<T1, T2>& value) {
+        DelegateBinaryCodec::Write(s, value.first);
+        DelegateBinaryCodec::Write(s, value.second);
+    }
+    static void Read(std::istream& s, std::pair<T1, T2>& value) {
+        DelegateBinaryCodec::Read(s, value.first);
+        DelegateBinaryCodec::Read(s, value.second);
+    }
+};
+
+/// Vectors. Elements that encode as their memory image are copied in one block.
+template <class T, class A>
+struct BinaryValue<std::vector<T, A>>
+{
+    static const bool BLOCK = (std::is_integral<T>::value && sizeof(T) == 1) ||
+        is_binary_image<T>::value;
+
+    template <class Out>
+    static void Write(Out& s, const std::vector<T, A>& value) {
+        DelegateBinaryCodec::WriteVarint(s, value.size());
+        Write(s, value, std::integral_constant<bool, BLOCK>());
+    }
+    static void Read(std::istream& s, std::vector<T, A>& value) {
+        size_t length = DelegateBinaryCodec::ReadLength(s, BLOCK ? sizeof(T) : 1);
+        Read(s, value, length, std::integral_constant<bool, BLOCK>());
+    }
+
+private:
+    template <class Out>
+    static void Write(Out& s, const std::vector<T, A>& value, std::true_type) {
+        if (!value.empty())
+            DelegateBinaryCodec::WriteBlock(s, value.data(), value.size() * sizeof(T));
+    }
+    template <class Out>
+    static void Write(Out& s, const std::vector<T, A>& value, std::false_type) {
+        for (const auto& element : value)
+            DelegateBinaryCodec::Write(s, element);
+    }
+    static void Read(std::istream& s, std::vector<T, A>& value, size_t length, std::true_type) {
+        DelegateBinaryCodec::ReadBlocks(s, value, length);
+    }
+    static void Read(std::istream& s, std::vector<T, A>& value, size_t length, std::false_type) {
+        DelegateBinaryCodec::ReadElements(s, value, length);
+    }
+};
+
+/// Sequence containers other than std::vector
+template <class Container>
+struct BinarySequence
+{
+    template <class Out>
+    static void Write(Out& s, const Container& value) {
+        DelegateBinaryCodec::WriteVarint(s, value.size());
+        for (const auto& element : value)
+            DelegateBinaryCodec::Write(s, element);
+    }
+    static void Read(std::istream& s, Container& value) {
+        DelegateBinaryCodec::ReadElements(s, value, DelegateBinaryCodec::ReadLength(s));
+    }
+};
+
+template <class T, class A>
+struct BinaryValue<std::list<T, A>> : BinarySequence<std::list<T, A>> {};
+
+template <class T, class A>
+struct BinaryValue<std::deque<T, A>> : BinarySequence<std::deque<T, A>> {};
+
+/// Associative containers
+template <class Container, class Element>
+struct BinaryAssociative
+{
+    template <class Out>
+    static void Write(Out& s, const Container& value) {
+        DelegateBinaryCodec::WriteVarint(s, value.size());
+        for (const auto& element : value)
+            DelegateBinaryCodec::Write(s, element);
+    }
+    static void Read(std::istream& s, Container& value) {
+        value.clear();
+        size_t size = DelegateBinaryCodec::ReadLength(s);
+        for (size_t i = 0; i < size && s; i++)
+        {
+            Element element;
+            DelegateBinaryCodec::Read(s, element);
+            value.insert(value.end(), std::move(element));
+        }
+    }
+};
+
+template <class T, class C, class A>
+struct BinaryValue<std::set<T, C, A>> : BinaryAssociative<std::set<T, C, A>, T> {};
+
+template <class K, class V, class C, class A>
+struct BinaryValue<std::map<K, V, C, A>> : BinaryAssociative<std::map<K, V, C, A>, std::pair<K, V>> {};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef _DELEGATE_CONNECTION_H
+#define _DELEGATE_CONNECTION_H
+
+// DelegateConnection.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include "IDelegateThread.h"
+#include "Semaphore.h"
+#include "DelegateMemoryResource.h"
+#include <memory>
+
+namespace DelegateLib {
+
+/// @brief Selects how an asynchronous delegate reaches its target thread. 
+enum class DelegateConnection
+{
+	/// Always invoke the target function synchronously on the caller's thread.
+	DIRECT,
+
+	/// Always copy the arguments and queue the call onto the target thread. Default.
+	QUEUED,
+
+	/// Invoke synchronously if the caller is already executing on the target thread. 
+	/// Otherwise queue the call. The synchronous case has no clone, message or argument copy.
+	AUTO,
+
+	/// Queue the call onto the target thread and block the caller until the target 
+	/// function returns. If the caller is already executing on the target thread the
+	/// function is invoked synchronously instead of deadlocking. 
+	BLOCKING_QUEUED
+};
+
+/// @brief Connection policy shared by the asynchronous delegate classes. The policy
+/// is copied along with the delegate, so it may be set before inserting a delegate
+/// into a container.
+class DelegateConnectionPolicy
+{
+public:
+	DelegateConnectionPolicy() = default;
+	DelegateConnectionPolicy(const DelegateConnectionPolicy& rhs) : m_connection(rhs.m_connection) {}
+	DelegateConnectionPolicy& operator=(const DelegateConnectionPolicy& rhs) {
+		m_connection = rhs.m_connection;
+		return *this;
+	}
+
+	/// A blocking clone that is destroyed without being invoked, for instance 
+	/// discarded by a worker thread exit, still releases the waiting caller. 
+	~DelegateConnectionPolicy() { SignalCompletion(); }
+
+	/// Set how the delegate reaches its target thread. 
+	/// @param[in] connection - the connection policy.
+	void SetConnection(DelegateConnection connection) { m_connection = connection; }
+
+	/// Get the connection policy. 
+	DelegateConnection GetConnection() const { return m_connection; }
+
+protected:
+	/// Check if the target function must be invoked on the caller's thread.
+	/// @param[in] thread - the delegate target thread.
+	/// @return true to invoke synchronously, false to queue onto the target thread.
+	bool IsDirect(DelegateThread& thread) const {
+		switch (m_connection)
+		{
+			case DelegateConnection::DIRECT:
+				return true;
+			case DelegateConnection::QUEUED:
+				return false;
+			default:
+				return thread.IsCurrentThread();
+		}
+	}
+
+	/// Attach a completion semaphore to the delegate clone if the caller must block.
+	/// @param[in] clone - the delegate clone dispatched to the target thread.
+	/// @return The semaphore to pass to WaitCompletion(), or nullptr if not blocking.
+	std::shared_ptr<Semaphore> BindCompletion(DelegateConnectionPolicy& clone) const {
+		if (m_connection != DelegateConnection::BLOCKING_QUEUED)
+			return nullptr;
+		clone.m_complete = MakeShared<Semaphore>();
+		return clone.m_complete;
+	}
+
+	/// Block until the target thread calls SignalCompletion() or the clone is destroyed.
+	/// The caller must release its references to the clone before waiting.
+	/// @param[in] complete - the semaphore returned by BindCompletion().
+	static void WaitCompletion(const std::shared_ptr<Semaphore>& complete) {
+		if (complete)
+			complete->Wait(-1);
+	}
+
+	/// Called by the target thread after invoking the target function. 
+	void SignalCompletion() {
+		if (m_complete)
+			m_complete->Signal();
+	}
+
+private:
+	DelegateConnection m_connection = DelegateConnection::QUEUED;
+	std::shared_ptr<Semaphore> m_complete;		// Set on blocking clones only
+};
+
+}
+
+#endif
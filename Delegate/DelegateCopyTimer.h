@@ -0,0 +1,55 @@
+#ifndef _DELEGATE_COPY_TIMER_H
+#define _DELEGATE_COPY_TIMER_H
+
+// DelegateCopyTimer.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include <chrono>
+
+namespace DelegateLib {
+
+/// @brief Measures the time asynchronous delegates called on this thread spend
+/// copying arguments and cloning themselves before the message is dispatched.
+/// Used by MulticastDelegate subscriber statistics.
+///
+/// @details A timer is active on the creating thread for its lifetime. Timers
+/// nest; only the innermost timer accumulates.
+class DelegateCopyTimer
+{
+public:
+	DelegateCopyTimer() : m_copyTime(0), m_prev(Current()) { Current() = this; }
+	~DelegateCopyTimer() { Current() = m_prev; }
+
+	/// Get the copy time accumulated while this timer was active.
+	std::chrono::nanoseconds GetCopyTime() const { return m_copyTime; }
+
+	/// Returns true if a timer is active on the calling thread.
+	static bool IsActive() { return Current() != nullptr; }
+
+	/// Record the end of an argument copy. Called by DelegateMsgBase::SetOrigin().
+	/// @param[in] callTime - when the asynchronous delegate was called, or a
+	///		default time_point if not measured.
+	static void Record(std::chrono::steady_clock::time_point callTime) {
+		DelegateCopyTimer* timer = Current();
+		if (timer && callTime != std::chrono::steady_clock::time_point())
+			timer->m_copyTime += std::chrono::steady_clock::now() - callTime;
+	}
+
+private:
+	// Prevent copying objects
+	DelegateCopyTimer(const DelegateCopyTimer&) = delete;
+	DelegateCopyTimer& operator=(const DelegateCopyTimer&) = delete;
+
+	/// The innermost timer of the calling thread
+	static DelegateCopyTimer*& Current() {
+		static thread_local DelegateCopyTimer* current = nullptr;
+		return current;
+	}
+
+	std::chrono::nanoseconds m_copyTime;
+	DelegateCopyTimer* m_prev;
+};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "DelegateEncodeBuffer.h"
+#include <climits>
+
+namespace DelegateLib
+{
+    static const size_t MIN_ENCODE_BUFFER = 64;
+
+    DelegateEncodeStream::DelegateEncodeStream() :
+        std::iostream(nullptr)
+    {
+        rdbuf(&m_buffer);
+    }
+
+    void DelegateEncodeStream::Clear()
+    {
+        m_buffer.Clear();
+        clear();
+    }
+
+    void DelegateEncodeStream::Buffer::Clear()
+    {
+        m_end = 0;
+        SetAreas(0, 0, 0);
+    }
+
+    size_t DelegateEncodeStream::Buffer::GetSize() const
+    {
+        size_t put = pptr() - pbase();
+        return put > m_end ? put : m_end;
+    }
+
+    size_t DelegateEncodeStream::Buffer::End()
+    {
+        m_end = GetSize();
+        return m_end;
+    }
+
+    void DelegateEncodeStream::Buffer::SetAreas(size_t put, size_t get, size_t end)
+    {
+        char* begin = m_data.data();
+        setp(begin, begin + m_data.size());
+        for (; put > INT_MAX; put -= INT_MAX)
+            pbump(INT_MAX);
+        pbump(static_cast<int>(put));
+        setg(begin, begin + get, begin + end);
+    }
+
+    std::streambuf::int_type DelegateEncodeStream::Buffer::overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+
+        // Grow the buffer, keeping the positions
+        size_t put = pptr() - pbase();
+        size_t get = gptr() - eback();
+        size_t end = End();
+        m_data.resize(m_data.empty() ? MIN_ENCODE_BUFFER : m_data.size() * 2);
+        SetAreas(put, get, end);
+
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    std::streambuf::int_type DelegateEncodeStream::Buffer::underflow()
+    {
+        // Make the bytes written since the last read available
+        size_t end = End();
+        setg(eback(), gptr(), m_data.data() + end);
+        if (gptr() == egptr())
+            return traits_type::eof();
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streambuf::pos_type DelegateEncodeStream::Buffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+    {
+        off_type base = 0;
+        if (dir == std::ios_base::cur)
+        {
+            // Only one position can be relative to the current position
+            if ((which & std::ios_base::in) && (which & std::ios_base::out))
+                return pos_type(off_type(-1));
+            base = (which & std::ios_base::in) ? gptr() - eback() : pptr() - pbase();
+        }
+        else if (dir == std::ios_base::end)
+        {
+            base = End();
+        }
+        return seekpos(pos_type(base + off), which);
+    }
+
+    std::streambuf::pos_type DelegateEncodeStream::Buffer::seekpos(pos_type pos, std::ios_base::openmode which)
+    {
+        off_type offset = pos;
+        size_t end = End();
+        if (!(which & (std::ios_base::in | std::ios_base::out)) || offset < 0 || (size_t)offset > end)
+            return pos_type(off_type(-1));
+
+        size_t put = (which & std::ios_base::out) ? (size_t)offset : pptr() - pbase();
+        size_t get = (which & std::ios_base::in) ? (size_t)offset : gptr() - eback();
+        SetAreas(put, get, end);
+        return pos;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef _DELEGATE_ENCODE_BUFFER_H
+#define _DELEGATE_ENCODE_BUFFER_H
+
+// DelegateEncodeBuffer.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include <stddef.h>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+namespace DelegateLib {
+
+/// @brief A read/write stream over a reusable byte buffer. Clear() empties the
+/// stream but keeps the memory, so encoding one remote message after another
+/// does not allocate once the buffer has held the largest message. A transport
+/// given a DelegateEncodeStream may send GetData() directly.
+class DelegateEncodeStream : public std::iostream
+{
+public:
+	/// Constructor. No memory is obtained until the first write.
+	DelegateEncodeStream();
+
+	/// Discard the contents and reset the read and write positions
+	void Clear();
+
+	/// Get the bytes written
+	const char* GetData() const { return m_buffer.GetData(); }
+
+	/// Get the number of bytes written
+	size_t GetSize() const { return m_buffer.GetSize(); }
+
+private:
+	// Prevent copying objects
+	DelegateEncodeStream(const DelegateEncodeStream&) = delete;
+	DelegateEncodeStream& operator=(const DelegateEncodeStream&) = delete;
+
+	class Buffer : public std::streambuf
+	{
+	public:
+		void Clear();
+		const char* GetData() const { return m_data.data(); }
+		size_t GetSize() const;
+
+	protected:
+		virtual int_type overflow(int_type c) override;
+		virtual int_type underflow() override;
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+	private:
+		/// Get the end of the written bytes, the furthest write position reached
+		size_t End();
+
+		/// Point the put and get areas at m_data
+		void SetAreas(size_t put, size_t get, size_t end);
+
+		std::vector<char> m_data;
+		size_t m_end = 0;
+	};
+
+	Buffer m_buffer;
+};
+
+/// @brief Lends the calling thread an encode buffer of type T, such as a
+/// DelegateEncodeStream or DelegateSpanWriter, for one remote message. Each thread
+/// keeps its own pool, so concurrent senders never share a buffer and take no lock.
+/// When the lease ends the buffer is cleared and returned with its capacity intact.
+/// A nested send on the same thread, e.g. from a transport that invokes a delegate
+/// locally, leases a second buffer.
+template <class T>
+class DelegateEncodeLease
+{
+public:
+	DelegateEncodeLease() : m_buffer(GetPool().Acquire()) {}
+
+	~DelegateEncodeLease()
+	{
+		m_buffer->Clear();
+		GetPool().Release(m_buffer);
+	}
+
+	/// Get the leased buffer
+	T& Get() const { return *m_buffer; }
+
+private:
+	// Prevent copying objects
+	DelegateEncodeLease(const DelegateEncodeLease&) = delete;
+	DelegateEncodeLease& operator=(const DelegateEncodeLease&) = delete;
+
+	/// The free buffers of one thread, deleted when the thread exits
+	class Pool
+	{
+	public:
+		~Pool()
+		{
+			for (T* buffer : m_free)
+				delete buffer;
+		}
+
+		T* Acquire()
+		{
+			if (m_free.empty())
+				return new T();
+			T* buffer = m_free.back();
+			m_free.pop_back();
+			return buffer;
+		}
+
+		void Release(T* buffer) { m_free.push_back(buffer); }
+
+	private:
+		std::vector<T*> m_free;
+	};
+
+	static Pool& GetPool()
+	{
+		static thread_local Pool pool;
+		return pool;
+	}
+
+	T* const m_buffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "DelegateFlightRecorder.h"
+#include "Fault.h"
+#include <list>
+#include <mutex>
+#include <cstring>
+#include <type_traits>
+
+using namespace std::chrono;
+
+namespace DelegateLib
+{
+    static_assert(std::is_trivially_copyable<DelegateTarget>::value, "DelegateTarget must be trivially copyable");
+
+    // The recorder list is never destroyed so worker threads exiting during static
+    // destruction can still unregister
+    static std::list<DelegateFlightRecorder*>& GetRecorders()
+    {
+        static auto recorders = new std::list<DelegateFlightRecorder*>();
+        return *recorders;
+    }
+
+    static std::mutex& GetRecordersLock()
+    {
+        static auto lock = new std::mutex();
+        return *lock;
+    }
+
+    static long long ToNs(steady_clock::time_point time)
+    {
+        return duration_cast<nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    DelegateFlightRecorder::DelegateFlightRecorder(const std::string& name, size_t size) :
+        m_name(name),
+        m_slots(new Slot[size]),
+        m_size(size),
+        m_head(0),
+        m_enqueueNs(0),
+        m_startNs(0)
+    {
+        ASSERT_TRUE(size > 0);
+        for (size_t i = 0; i < m_size; i++)
+        {
+            m_slots[i].seq = 0;
+            for (size_t w = 0; w < TARGET_WORDS; w++)
+                m_slots[i].target[w] = 0;
+            m_slots[i].enqueueNs = 0;
+            m_slots[i].startNs = 0;
+            m_slots[i].durationNs = 0;
+        }
+
+        std::lock_guard<std::mutex> lk(GetRecordersLock());
+        GetRecorders().push_back(this);
+    }
+
+    DelegateFlightRecorder::~DelegateFlightRecorder()
+    {
+        std::lock_guard<std::mutex> lk(GetRecordersLock());
+        GetRecorders().remove(this);
+    }
+
+    void DelegateFlightRecorder::Write(Slot& slot, const DelegateTarget& target, long long enqueueNs, long long startNs, long long durationNs)
+    {
+        size_t words[TARGET_WORDS] = {};
+        memcpy(words, &target, sizeof(target));
+
+        // Seqlock write: mark the slot odd, fill it, then publish the even sequence
+        unsigned long long seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t w = 0; w < TARGET_WORDS; w++)
+            slot.target[w].store(words[w], std::memory_order_relaxed);
+        slot.enqueueNs.store(enqueueNs, std::memory_order_relaxed);
+        slot.startNs.store(startNs, std::memory_order_relaxed);
+        slot.durationNs.store(durationNs, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    bool DelegateFlightRecorder::Read(const Slot& slot, Entry& entry) const
+    {
+        unsigned long long seq = slot.seq.load(std::memory_order_acquire);
+        if (seq == 0 || (seq & 1))
+            return false;
+
+        size_t words[TARGET_WORDS];
+        for (size_t w = 0; w < TARGET_WORDS; w++)
+            words[w] = slot.target[w].load(std::memory_order_relaxed);
+        long long enqueueNs = slot.enqueueNs.load(std::memory_order_relaxed);
+        long long startNs = slot.startNs.load(std::memory_order_relaxed);
+        long long durationNs = slot.durationNs.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+            return false;
+
+        memcpy(&entry.target, words, sizeof(entry.target));
+        entry.enqueueTime = steady_clock::time_point(nanoseconds(enqueueNs));
+        entry.startTime = steady_clock::time_point(nanoseconds(startNs));
+        entry.running = durationNs < 0;
+        entry.duration = nanoseconds(entry.running ? 0 : durationNs);
+        return true;
+    }
+
+    void DelegateFlightRecorder::Begin(const DelegateTarget& target, steady_clock::time_point enqueueTime, steady_clock::time_point startTime)
+    {
+        m_target = target;
+        m_enqueueNs = ToNs(enqueueTime);
+        m_startNs = ToNs(startTime);
+
+        unsigned long long head = m_head.load(std::memory_order_relaxed);
+        Write(m_slots[head % m_size], m_target, m_enqueueNs, m_startNs, -1);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    void DelegateFlightRecorder::End(steady_clock::time_point endTime)
+    {
+        unsigned long long head = m_head.load(std::memory_order_relaxed);
+        ASSERT_TRUE(head > 0);
+
+        // Complete the entry written by Begin()
+        Write(m_slots[(head - 1) % m_size], m_target, m_enqueueNs, m_startNs, ToNs(endTime) - m_startNs);
+    }
+
+    std::vector<DelegateFlightRecorder::Entry> DelegateFlightRecorder::GetEntries() const
+    {
+        unsigned long long head = m_head.load(std::memory_order_acquire);
+        unsigned long long start = head > m_size ? head - m_size : 0;
+
+        std::vector<Entry> entries;
+        for (unsigned long long i = start; i < head; i++)
+        {
+            Entry entry;
+            if (Read(m_slots[i % m_size], entry))
+                entries.push_back(entry);
+        }
+        return entries;
+    }
+
+    void DelegateFlightRecorder::Dump(FILE* file) const
+    {
+        auto now = steady_clock::now();
+        std::vector<Entry> entries = GetEntries();
+
+        fprintf(file, "Flight recorder %s: last %u messages, oldest first\n", m_name.c_str(), (unsigned)entries.size());
+        for (auto& entry : entries)
+        {
+            long long queuedUs = duration_cast<microseconds>(entry.startTime - entry.enqueueTime).count();
+            long long startedUs = duration_cast<microseconds>(now - entry.startTime).count();
+            if (entry.running)
+            {
+                fprintf(file, "  %s queued %lldus, started %lldus ago, RUNNING\n",
+                    entry.target.ToString().c_str(), queuedUs, startedUs);
+            }
+            else
+            {
+                fprintf(file, "  %s queued %lldus, started %lldus ago, ran %lldus\n",
+                    entry.target.ToString().c_str(), queuedUs, startedUs,
+                    (long long)duration_cast<microseconds>(entry.duration).count());
+            }
+        }
+    }
+
+    void DelegateFlightRecorder::DumpAll(FILE* file)
+    {
+        // A fault may occur while the list is locked so never block here
+        std::unique_lock<std::mutex> lk(GetRecordersLock(), std::try_to_lock);
+        if (!lk.owns_lock())
+        {
+            fprintf(file, "Flight recorders busy, dump skipped\n");
+            return;
+        }
+
+        for (auto recorder : GetRecorders())
+            recorder->Dump(file);
+        fflush(file);
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef _DELEGATE_FLIGHT_RECORDER_H
+#define _DELEGATE_FLIGHT_RECORDER_H
+
+// DelegateFlightRecorder.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include "DelegateTarget.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+
+namespace DelegateLib {
+
+/// @brief An always-on record of the last N delegate messages a thread invoked.
+/// Each entry holds the target function, when the message was queued, when it
+/// started and how long it ran. The message currently running is recorded too,
+/// so a dump taken from FaultHandler() shows what the thread was doing.
+///
+/// @details Only the owning thread writes a recorder. Each slot is guarded by a
+/// sequence counter so GetEntries() and Dump() may run on any thread at any time
+/// without locking the writer; a slot being overwritten during the read is skipped.
+class DelegateFlightRecorder
+{
+public:
+	enum { DEFAULT_SIZE = 64 };
+
+	/// One recorded message
+	struct Entry
+	{
+		DelegateTarget target;
+		std::chrono::steady_clock::time_point enqueueTime;
+		std::chrono::steady_clock::time_point startTime;
+		std::chrono::nanoseconds duration;		///< Zero while running
+		bool running;							///< Message was still executing
+	};
+
+	/// Constructor
+	/// @param[in] name - the owning thread name, shown in dumps.
+	/// @param[in] size - the number of messages retained. Must be greater than 0.
+	DelegateFlightRecorder(const std::string& name, size_t size = DEFAULT_SIZE);
+
+	/// Destructor
+	~DelegateFlightRecorder();
+
+	/// Record the start of a message. Owning thread only.
+	/// @param[in] target - the function invoked.
+	/// @param[in] enqueueTime - when the message was queued.
+	/// @param[in] startTime - when execution started.
+	void Begin(const DelegateTarget& target, std::chrono::steady_clock::time_point enqueueTime,
+		std::chrono::steady_clock::time_point startTime);
+
+	/// Record the end of the message passed to the last Begin(). Owning thread only.
+	/// @param[in] endTime - when execution finished.
+	void End(std::chrono::steady_clock::time_point endTime);
+
+	/// Get the retained entries, oldest first. May be called from any thread.
+	std::vector<Entry> GetEntries() const;
+
+	/// Get the owning thread name.
+	const std::string& GetName() const { return m_name; }
+
+	/// Write the retained entries as text. May be called from any thread.
+	/// @param[in] file - the output file, e.g. stderr.
+	void Dump(FILE* file) const;
+
+	/// Dump every flight recorder. Called by FaultHandler(). Skips the dump
+	/// rather than block if another thread holds the recorder list.
+	/// @param[in] file - the output file, e.g. stderr.
+	static void DumpAll(FILE* file);
+
+private:
+	// Prevent copying objects
+	DelegateFlightRecorder(const DelegateFlightRecorder&) = delete;
+	DelegateFlightRecorder& operator=(const DelegateFlightRecorder&) = delete;
+
+	enum { TARGET_WORDS = (sizeof(DelegateTarget) + sizeof(size_t) - 1) / sizeof(size_t) };
+
+	/// An entry stored as atomic words so readers never see a data race
+	struct Slot
+	{
+		std::atomic<unsigned long long> seq;	// Odd while being written
+		std::atomic<size_t> target[TARGET_WORDS];
+		std::atomic<long long> enqueueNs;
+		std::atomic<long long> startNs;
+		std::atomic<long long> durationNs;		// -1 while running
+	};
+
+	/// Write a slot. Owning thread only.
+	void Write(Slot& slot, const DelegateTarget& target, long long enqueueNs, long long startNs, long long durationNs);
+
+	/// Read a slot.
+	/// @return false if the slot is empty or was overwritten during the read.
+	bool Read(const Slot& slot, Entry& entry) const;
+
+	const std::string m_name;
+	std::unique_ptr<Slot[]> m_slots;
+	const size_t m_size;
+	std::atomic<unsigned long long> m_head;		// Total messages recorded
+
+	// The message passed to Begin(). Owning thread only.
+	DelegateTarget m_target;
+	long long m_enqueueNs;
+	long long m_startNs;
+};
+
+}
+
+#endif
@@ -13,6 +13,11 @@ public:
 	/// Called to invoke the callback by the destination thread of control. 
 	/// @param[in] msg - the incoming delegate message. 
 	virtual void DelegateInvoke(std::shared_ptr<DelegateMsgBase> msg) = 0;
+
+	/// Called by the destination thread instead of DelegateInvoke() when a message 
+	/// is discarded, so the invoker can free data it copied into the message. 
+	/// @param[in] msg - the discarded delegate message. 
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> /*msg*/) {}
 };
 
 }
@@ -0,0 +1,181 @@
+#include "DelegateLatency.h"
+#include "Fault.h"
+#include <map>
+#include <unordered_map>
+
+using namespace std::chrono;
+
+namespace DelegateLib
+{
+    // The containers are never destroyed so worker threads exiting during static
+    // destruction can still record
+    static std::map<DelegateTarget, DelegateLatency::Histograms*>& GetTargets()
+    {
+        static auto targets = new std::map<DelegateTarget, DelegateLatency::Histograms*>();
+        return *targets;
+    }
+
+    static std::map<std::string, DelegateLatency::Histograms*>& GetThreads()
+    {
+        static auto threads = new std::map<std::string, DelegateLatency::Histograms*>();
+        return *threads;
+    }
+
+    static unsigned long long ElapsedNs(DelegateLatency::Clock::time_point start, DelegateLatency::Clock::time_point end)
+    {
+        return end > start ? duration_cast<nanoseconds>(end - start).count() : 0;
+    }
+
+    std::atomic<bool>& DelegateLatency::GetEnabled()
+    {
+        static std::atomic<bool> enabled(false);
+        return enabled;
+    }
+
+    std::mutex& DelegateLatency::GetLock()
+    {
+        static auto lock = new std::mutex();
+        return *lock;
+    }
+
+    void DelegateLatency::SetEnabled(bool enabled)
+    {
+        GetEnabled().store(enabled, std::memory_order_relaxed);
+    }
+
+    DelegateLatency::Histograms* DelegateLatency::GetThreadHistograms(const std::string& threadName)
+    {
+        std::lock_guard<std::mutex> lk(GetLock());
+        Histograms*& histograms = GetThreads()[threadName];
+        if (!histograms)
+            histograms = new Histograms();
+        return histograms;
+    }
+
+    DelegateLatency::Histograms* DelegateLatency::GetTargetHistograms(const DelegateTarget& target)
+    {
+        // Cache lookups per thread so the global lock is only taken for new targets
+        static thread_local std::unordered_map<DelegateTarget, Histograms*, DelegateTarget::Hasher> cache;
+        auto it = cache.find(target);
+        if (it != cache.end())
+            return it->second;
+
+        Histograms* histograms;
+        {
+            std::lock_guard<std::mutex> lk(GetLock());
+            Histograms*& entry = GetTargets()[target];
+            if (!entry)
+                entry = new Histograms();
+            histograms = entry;
+        }
+        cache[target] = histograms;
+        return histograms;
+    }
+
+    void DelegateLatency::Record(Histograms* thread, const DelegateTarget& target, Clock::time_point call,
+        Clock::time_point enqueue, Clock::time_point dequeue, Clock::time_point complete)
+    {
+        ASSERT_TRUE(thread != nullptr);
+
+        unsigned long long queued = ElapsedNs(enqueue, dequeue);
+        unsigned long long execute = ElapsedNs(dequeue, complete);
+        thread->queued.Record(queued);
+        thread->execute.Record(execute);
+
+        // Messages not stamped by the caller have no dispatch or total time
+        if (call == Clock::time_point() || target.Empty())
+            return;
+
+        unsigned long long dispatch = ElapsedNs(call, enqueue);
+        unsigned long long total = ElapsedNs(call, complete);
+        thread->dispatch.Record(dispatch);
+        thread->total.Record(total);
+
+        Histograms* histograms = GetTargetHistograms(target);
+        histograms->dispatch.Record(dispatch);
+        histograms->queued.Record(queued);
+        histograms->execute.Record(execute);
+        histograms->total.Record(total);
+    }
+
+    void DelegateLatency::GetPercentiles(const LatencyHistogram& histogram, Percentiles& percentiles)
+    {
+        percentiles.count = histogram.GetCount();
+        percentiles.p50 = nanoseconds(histogram.GetPercentile(50.0));
+        percentiles.p99 = nanoseconds(histogram.GetPercentile(99.0));
+        percentiles.p999 = nanoseconds(histogram.GetPercentile(99.9));
+        percentiles.max = nanoseconds(histogram.GetMax());
+    }
+
+    void DelegateLatency::ToStats(const Histograms& histograms, Stats& stats)
+    {
+        GetPercentiles(histograms.dispatch, stats.dispatch);
+        GetPercentiles(histograms.queued, stats.queued);
+        GetPercentiles(histograms.execute, stats.execute);
+        GetPercentiles(histograms.total, stats.total);
+    }
+
+    bool DelegateLatency::GetStats(const DelegateTarget& target, Stats& stats)
+    {
+        std::lock_guard<std::mutex> lk(GetLock());
+        auto it = GetTargets().find(target);
+        if (it == GetTargets().end() || it->second->total.GetCount() == 0)
+            return false;
+
+        stats.target = target;
+        stats.threadName.clear();
+        ToStats(*it->second, stats);
+        return true;
+    }
+
+    std::vector<DelegateLatency::Stats> DelegateLatency::GetTargetStats()
+    {
+        std::lock_guard<std::mutex> lk(GetLock());
+
+        std::vector<Stats> stats;
+        for (auto& entry : GetTargets())
+        {
+            Stats targetStats;
+            targetStats.target = entry.first;
+            ToStats(*entry.second, targetStats);
+            stats.push_back(targetStats);
+        }
+        return stats;
+    }
+
+    std::vector<DelegateLatency::Stats> DelegateLatency::GetThreadStats()
+    {
+        std::lock_guard<std::mutex> lk(GetLock());
+
+        std::vector<Stats> stats;
+        for (auto& entry : GetThreads())
+        {
+            Stats threadStats;
+            threadStats.threadName = entry.first;
+            ToStats(*entry.second, threadStats);
+            stats.push_back(threadStats);
+        }
+        return stats;
+    }
+
+    void DelegateLatency::Reset()
+    {
+        std::lock_guard<std::mutex> lk(GetLock());
+
+        // Histograms are reset rather than deleted since threads cache pointers to them
+        for (auto& entry : GetTargets())
+        {
+            entry.second->dispatch.Reset();
+            entry.second->queued.Reset();
+            entry.second->execute.Reset();
+            entry.second->total.Reset();
+        }
+        for (auto& entry : GetThreads())
+        {
+            entry.second->dispatch.Reset();
+            entry.second->queued.Reset();
+            entry.second->execute.Reset();
+            entry.second->total.Reset();
+        }
+    }
+}
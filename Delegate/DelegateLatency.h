@@ -0,0 +1,125 @@
+#ifndef _DELEGATE_LATENCY_H
+#define _DELEGATE_LATENCY_H
+
+// DelegateLatency.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include "DelegateOpt.h"
+#include "DelegateTarget.h"
+#include "DelegateCopyTimer.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace DelegateLib {
+
+/// @brief End-to-end latency histograms for asynchronous delegate invocations. Each
+/// invocation is timestamped when the delegate is called, when the message is
+/// queued, when the target thread dequeues it and when DelegateInvoke() returns.
+/// The stage latencies are recorded per target function and per target thread.
+///
+/// @details Requires USE_DELEGATE_LATENCY at compile time and SetEnabled(true) at
+/// runtime. Histograms are created on first use and live until program exit.
+class DelegateLatency
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	/// Latency percentiles of one stage
+	struct Percentiles
+	{
+		unsigned long long count;
+		std::chrono::nanoseconds p50;
+		std::chrono::nanoseconds p99;
+		std::chrono::nanoseconds p999;
+		std::chrono::nanoseconds max;
+	};
+
+	/// Latency of each stage of an asynchronous invocation
+	struct Stats
+	{
+		DelegateTarget target;		///< Target function. Empty for thread stats.
+		std::string threadName;		///< Target thread. Empty for target stats.
+		Percentiles dispatch;		///< Call to enqueue: argument copies, clone and message creation
+		Percentiles queued;			///< Enqueue to dequeue
+		Percentiles execute;		///< Dequeue to DelegateInvoke() return
+		Percentiles total;			///< Call to DelegateInvoke() return
+	};
+
+	/// The stage histograms of one target function or thread
+	struct Histograms
+	{
+		LatencyHistogram dispatch;
+		LatencyHistogram queued;
+		LatencyHistogram execute;
+		LatencyHistogram total;
+	};
+
+	/// Switch recording on or off at runtime. Has no effect unless compiled
+	/// with USE_DELEGATE_LATENCY.
+	static void SetEnabled(bool enabled);
+
+	/// Returns true if latency is being recorded.
+	static bool IsEnabled() {
+#ifdef USE_DELEGATE_LATENCY
+		return GetEnabled().load(std::memory_order_relaxed);
+#else
+		return false;
+#endif
+	}
+
+	/// Get the current time if recording latency or timing argument copies, 
+	/// otherwise a default time_point.
+	static Clock::time_point Now() { 
+		return IsEnabled() || DelegateCopyTimer::IsActive() ? Clock::now() : Clock::time_point(); 
+	}
+
+	/// Get the histograms of a thread, created on first use.
+	/// @param[in] threadName - the target thread name.
+	/// @return The thread histograms. Valid for the life of the program.
+	static Histograms* GetThreadHistograms(const std::string& threadName);
+
+	/// Record a completed invocation. Called by the target thread. Invocations
+	/// without a call time only record the queued and execute stages.
+	/// @param[in] thread - the target thread histograms.
+	/// @param[in] target - the function invoked.
+	/// @param[in] call - when the delegate was called.
+	/// @param[in] enqueue - when the message was queued.
+	/// @param[in] dequeue - when the target thread dequeued the message.
+	/// @param[in] complete - when DelegateInvoke() returned.
+	static void Record(Histograms* thread, const DelegateTarget& target, Clock::time_point call,
+		Clock::time_point enqueue, Clock::time_point dequeue, Clock::time_point complete);
+
+	/// Get the latency of a target function.
+	/// @param[in] target - the target function.
+	/// @param[out] stats - the latency statistics.
+	/// @return true if any invocations of the target were recorded.
+	static bool GetStats(const DelegateTarget& target, Stats& stats);
+
+	/// Get the latency of a free or member function, e.g. GetStats(&MyClass::Func, stats).
+	template <class Func>
+	static bool GetStats(Func func, Stats& stats) { return GetStats(DelegateTarget(func), stats); }
+
+	/// Get the latency of every target function recorded.
+	static std::vector<Stats> GetTargetStats();
+
+	/// Get the latency of every target thread recorded.
+	static std::vector<Stats> GetThreadStats();
+
+	/// Clear all recorded samples.
+	static void Reset();
+
+private:
+	static std::atomic<bool>& GetEnabled();
+	static std::mutex& GetLock();
+	static Histograms* GetTargetHistograms(const DelegateTarget& target);
+	static void GetPercentiles(const LatencyHistogram& histogram, Percentiles& percentiles);
+	static void ToStats(const Histograms& histograms, Stats& stats);
+};
+
+}
+
+#endif
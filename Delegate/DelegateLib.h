@@ -4,12 +4,15 @@
 // DelegateLib.h is a single include for users to obtain all delegate functionality
 
 #include "DelegateOpt.h"
+#include "DelegateMemoryResource.h"
+#include "DelegateArena.h"
 #include "MulticastDelegateSafe.h"
 #include "SinglecastDelegate.h"
 #include "DelegateAsync.h"
 #include "DelegateAsyncWait.h"
 #include "DelegateRemoteSend.h"
 #include "DelegateRemoteRecv.h"
+#include "DelegateBatchTransport.h"
 #include "DelegateSpAsync.h"
 
 #endif
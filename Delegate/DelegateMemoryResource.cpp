@@ -0,0 +1,311 @@
+#include "DelegateMemoryResource.h"
+#include "Allocator.h"
+#include "Fault.h"
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
+
+namespace DelegateLib
+{
+    // Zero allocation pools. Size class i holds blocks of MIN_POOL_BLOCK << i bytes.
+    enum { POOL_CLASSES = 6, MIN_POOL_BLOCK = 32 };
+
+    struct ZeroAllocPools
+    {
+        char* pMemory;                          // Every size class, smallest first
+        char* pEnd;
+        char* pClassEnd[POOL_CLASSES];
+        Allocator* allocators[POOL_CLASSES];
+    };
+
+    struct ZeroAllocState
+    {
+        ZeroAllocState() : pools(nullptr), armed(false), fallback(HeapFallback::COUNT),
+            poolAllocations(0), heapFallbacks(0), lastFallbackType(nullptr), lastFallbackSize(0) {}
+
+        std::atomic<ZeroAllocPools*> pools;
+        std::atomic<bool> armed;
+        std::atomic<HeapFallback> fallback;
+        std::atomic<unsigned long long> poolAllocations;
+        std::atomic<unsigned long long> heapFallbacks;
+        std::atomic<const char*> lastFallbackType;
+        std::atomic<size_t> lastFallbackSize;
+        std::mutex lock;
+    };
+
+    // Never destroyed so pool blocks freed during static destruction still find their pool
+    static ZeroAllocState& GetZeroAlloc()
+    {
+        static auto state = new ZeroAllocState();
+        return *state;
+    }
+
+    // Get a pool block while armed. A request the pools cannot serve is reported.
+    static void* PoolAllocate(size_t size, const char* type)
+    {
+        ZeroAllocState& state = GetZeroAlloc();
+        if (!state.armed.load(std::memory_order_acquire))
+            return nullptr;
+
+        // Take the next larger size class if one is exhausted
+        ZeroAllocPools* pools = state.pools.load(std::memory_order_acquire);
+        for (int i = 0; i < POOL_CLASSES; i++)
+        {
+            if (size > ((size_t)MIN_POOL_BLOCK << i))
+                continue;
+            void* block = pools->allocators[i]->TryAllocate(size);
+            if (block)
+            {
+                state.poolAllocations.fetch_add(1, std::memory_order_relaxed);
+                return block;
+            }
+        }
+
+        ReportHeapAllocation(type, size);
+        return nullptr;
+    }
+
+    // Return a block to its pool. Returns false if the block is not a pool block.
+    static bool PoolDeallocate(void* ptr)
+    {
+        ZeroAllocPools* pools = GetZeroAlloc().pools.load(std::memory_order_acquire);
+        char* block = static_cast<char*>(ptr);
+        if (!pools || block < pools->pMemory || block >= pools->pEnd)
+            return false;
+
+        int i = 0;
+        while (block >= pools->pClassEnd[i])
+            i++;
+        pools->allocators[i]->Deallocate(ptr);
+        return true;
+    }
+
+    void ArmZeroAllocation(size_t blocks, HeapFallback fallback)
+    {
+        ASSERT_TRUE(blocks > 0);
+
+        ZeroAllocState& state = GetZeroAlloc();
+        std::lock_guard<std::mutex> lk(state.lock);
+        if (!state.pools.load(std::memory_order_relaxed))
+        {
+            size_t bytes = 0;
+            for (int i = 0; i < POOL_CLASSES; i++)
+                bytes += blocks * ((size_t)MIN_POOL_BLOCK << i);
+
+            // Touch the memory now so the first use of a block never page faults
+            ZeroAllocPools* pools = new ZeroAllocPools();
+            pools->pMemory = static_cast<char*>(::operator new(bytes));
+            memset(pools->pMemory, 0, bytes);
+
+            char* pClass = pools->pMemory;
+            for (int i = 0; i < POOL_CLASSES; i++)
+            {
+                size_t blockSize = (size_t)MIN_POOL_BLOCK << i;
+                pools->allocators[i] = new Allocator(blockSize, (UINT)blocks, pClass, "ZeroAllocPool", true);
+                pClass += blockSize * blocks;
+                pools->pClassEnd[i] = pClass;
+            }
+            pools->pEnd = pClass;
+            state.pools.store(pools, std::memory_order_release);
+        }
+
+        state.fallback.store(fallback, std::memory_order_relaxed);
+        state.armed.store(true, std::memory_order_release);
+    }
+
+    void DisarmZeroAllocation()
+    {
+        GetZeroAlloc().armed.store(false, std::memory_order_release);
+    }
+
+    bool IsZeroAllocationArmed()
+    {
+        return GetZeroAlloc().armed.load(std::memory_order_acquire);
+    }
+
+    ZeroAllocStats GetZeroAllocStats()
+    {
+        ZeroAllocState& state = GetZeroAlloc();
+        ZeroAllocStats stats;
+        stats.poolAllocations = state.poolAllocations.load(std::memory_order_relaxed);
+        stats.heapFallbacks = state.heapFallbacks.load(std::memory_order_relaxed);
+        stats.lastFallbackType = state.lastFallbackType.load(std::memory_order_relaxed);
+        stats.lastFallbackSize = state.lastFallbackSize.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void ReportHeapAllocation(const char* type, size_t size)
+    {
+        ZeroAllocState& state = GetZeroAlloc();
+        if (!state.armed.load(std::memory_order_acquire))
+            return;
+
+        state.lastFallbackType.store(type, std::memory_order_relaxed);
+        state.lastFallbackSize.store(size, std::memory_order_relaxed);
+        state.heapFallbacks.fetch_add(1, std::memory_order_relaxed);
+        if (state.fallback.load(std::memory_order_relaxed) == HeapFallback::FAULT)
+        {
+            fprintf(stderr, "Heap allocation while zero allocation mode is armed: %s, %u bytes\n",
+                type ? type : "unknown type", (unsigned)size);
+            ASSERT();
+        }
+    }
+
+#ifdef USE_CXX17
+    // Each DelegateAllocate() block starts with a header recording where it came from
+    struct BlockHeader
+    {
+        std::pmr::memory_resource* resource;
+        size_t size;
+    };
+
+    static const size_t HEADER_SIZE = (sizeof(BlockHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    static std::atomic<std::pmr::memory_resource*>& GetResource()
+    {
+        static std::atomic<std::pmr::memory_resource*> resource(nullptr);
+        return resource;
+    }
+
+    // Never destroyed so objects freed during static destruction still find it
+    static std::pmr::memory_resource* GetUpstreamResource()
+    {
+#ifdef USE_XALLOCATOR
+        static auto resource = new XallocatorResource();
+        return resource;
+#else
+        return std::pmr::new_delete_resource();
+#endif
+    }
+
+    // The default resource. Serves containers from the zero allocation pools while armed.
+    class PoolResource : public std::pmr::memory_resource
+    {
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* block = alignment <= alignof(std::max_align_t) ? PoolAllocate(bytes, "std::pmr container") : nullptr;
+            return block ? block : GetUpstreamResource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+            if (!PoolDeallocate(ptr))
+                GetUpstreamResource()->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    static std::pmr::memory_resource* GetDefaultResource()
+    {
+        static auto resource = new PoolResource();
+        return resource;
+    }
+
+    std::pmr::memory_resource* GetDelegateResource()
+    {
+        std::pmr::memory_resource* resource = GetResource().load(std::memory_order_acquire);
+        return resource ? resource : GetDefaultResource();
+    }
+
+    void SetDelegateResource(std::pmr::memory_resource* resource)
+    {
+        GetResource().store(resource, std::memory_order_release);
+    }
+
+    void* DelegateAllocate(size_t size, const char* type)
+    {
+        void* pool = PoolAllocate(size, type);
+        if (pool)
+            return pool;
+
+        // The pools were tried already, so bypass the default resource
+        std::pmr::memory_resource* resource = GetResource().load(std::memory_order_acquire);
+        if (!resource)
+            resource = GetUpstreamResource();
+        char* block = static_cast<char*>(resource->allocate(HEADER_SIZE + size, alignof(std::max_align_t)));
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+        header->resource = resource;
+        header->size = size;
+        return block + HEADER_SIZE;
+    }
+
+    void DelegateDeallocate(void* ptr)
+    {
+        if (!ptr || PoolDeallocate(ptr))
+            return;
+        char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+        header->resource->deallocate(block, HEADER_SIZE + header->size, alignof(std::max_align_t));
+    }
+
+#ifdef USE_XALLOCATOR
+    XallocatorResource::XallocatorResource(std::pmr::memory_resource* upstream) :
+        m_upstream(upstream),
+        m_maxSize(0)
+    {
+        XallocClass classes[XALLOC_MAX_CLASSES];
+        INT count = xalloc_get_classes(classes, XALLOC_MAX_CLASSES);
+        if (count > 0)
+            m_maxSize = classes[count - 1].blockSize - sizeof(void*);
+    }
+
+    void* XallocatorResource::do_allocate(size_t bytes, size_t alignment)
+    {
+        // xmalloc() aligns to a pointer. Over-allocate for more and record the
+        // offset to the xmalloc() block in the byte before the returned address.
+        size_t extra = alignment > alignof(void*) ? alignment : 0;
+        if (bytes + extra > m_maxSize || alignment > 128)
+            return m_upstream->allocate(bytes, alignment);
+
+        char* block = static_cast<char*>(xmalloc(bytes + extra));
+        if (!extra)
+            return block;
+        char* aligned = reinterpret_cast<char*>((reinterpret_cast<size_t>(block) + alignment) & ~(alignment - 1));
+        aligned[-1] = (char)(aligned - block);
+        return aligned;
+    }
+
+    void XallocatorResource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+    {
+        size_t extra = alignment > alignof(void*) ? alignment : 0;
+        if (bytes + extra > m_maxSize || alignment > 128)
+            m_upstream->deallocate(ptr, bytes, alignment);
+        else if (!extra)
+            xfree(ptr);
+        else
+        {
+            char* aligned = static_cast<char*>(ptr);
+            xfree(aligned - (unsigned char)aligned[-1]);
+        }
+    }
+#endif
+
+#else
+    void* DelegateAllocate(size_t size, const char* type)
+    {
+        void* pool = PoolAllocate(size, type);
+        if (pool)
+            return pool;
+#ifdef USE_XALLOCATOR
+        return xmalloc(size);
+#else
+        return ::operator new(size);
+#endif
+    }
+
+    void DelegateDeallocate(void* ptr)
+    {
+        if (PoolDeallocate(ptr))
+            return;
+#ifdef USE_XALLOCATOR
+        xfree(ptr);
+#else
+        ::operator delete(ptr);
+#endif
+    }
+#endif  // USE_CXX17
+}
@@ -0,0 +1,268 @@
+#ifndef _DELEGATE_MEMORY_RESOURCE_H
+#define _DELEGATE_MEMORY_RESOURCE_H
+
+// DelegateMemoryResource.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+//
+// Every object the library allocates while dispatching a delegate comes from
+// DelegateAllocate(): delegate clones, messages, argument copies, shared_ptr control
+// blocks, worker thread queue nodes and multicast delegate lists. With USE_CXX17 the
+// memory comes from a std::pmr::memory_resource set with SetDelegateResource(),
+// otherwise from the xallocator if USE_XALLOCATOR is defined, otherwise the heap.
+//
+// ArmZeroAllocation() routes every DelegateAllocate() request through preallocated 
+// lock-free pools, so a process can forbid heap allocation after initialization.
+// A request the pools cannot serve falls back to the heap and is counted, or faults.
+
+#include "DelegateOpt.h"
+#include <stddef.h>
+#include <cstddef>
+#include <memory>
+#include <list>
+#include <deque>
+#include <typeinfo>
+#ifdef USE_XALLOCATOR
+	#include "xallocator.h"
+#endif
+#ifdef USE_CXX17
+	#include "Allocator.h"
+	#include <memory_resource>
+	#include <mutex>
+#endif
+
+namespace DelegateLib {
+
+/// Allocate storage for a library object.
+/// @param[in] size - the number of bytes.
+/// @param[in] type - the type allocated, reported if the request falls back to
+///     the heap while zero allocation mode is armed. May be nullptr.
+/// @return The storage, aligned for any fundamental type.
+void* DelegateAllocate(size_t size, const char* type = nullptr);
+
+/// Free storage obtained with DelegateAllocate().
+/// @param[in] ptr - the storage or nullptr.
+void DelegateDeallocate(void* ptr);
+
+/// Action taken when a request falls back to the heap while zero allocation 
+/// mode is armed.
+enum class HeapFallback
+{
+	/// Count the request and continue.
+	COUNT,
+
+	/// Count the request and call FaultHandler().
+	FAULT
+};
+
+/// Zero allocation mode statistics. Counts include requests made while armed only.
+struct ZeroAllocStats
+{
+	unsigned long long poolAllocations;		///< Requests served by the pools
+	unsigned long long heapFallbacks;		///< Requests that fell back to the heap
+	const char* lastFallbackType;			///< Type of the last fallback, or nullptr if unknown
+	size_t lastFallbackSize;				///< Size in bytes of the last fallback
+};
+
+/// Arm zero allocation mode. The first call preallocates a lock-free pool of 
+/// 32 to 1024 byte blocks for each size class; later calls reuse the pools. While
+/// armed, DelegateAllocate() serves every request that fits from the pools and 
+/// reports any other request, and any library allocation reported with 
+/// ReportHeapAllocation(), as a heap fallback. Pool blocks are returned to the
+/// pools whether or not the mode is still armed.
+/// @param[in] blocks - the blocks in each size class pool. Must be greater than 0.
+/// @param[in] fallback - the action taken on a heap fallback.
+void ArmZeroAllocation(size_t blocks, HeapFallback fallback = HeapFallback::COUNT);
+
+/// Disarm zero allocation mode. DelegateAllocate() no longer uses the pools.
+void DisarmZeroAllocation();
+
+/// Returns true if zero allocation mode is armed.
+bool IsZeroAllocationArmed();
+
+/// Get the zero allocation mode statistics.
+ZeroAllocStats GetZeroAllocStats();
+
+/// Report a library allocation that bypasses DelegateAllocate() and comes from
+/// the heap, e.g. a DelegateArena chunk. Ignored unless zero allocation mode is armed.
+/// @param[in] type - the type allocated, or nullptr if unknown.
+/// @param[in] size - the number of bytes.
+void ReportHeapAllocation(const char* type, size_t size);
+
+#ifdef USE_CXX17
+/// Get the memory resource library objects are allocated from. Defaults to an
+/// XallocatorResource if USE_XALLOCATOR is defined, otherwise
+/// std::pmr::new_delete_resource().
+std::pmr::memory_resource* GetDelegateResource();
+
+/// Set the memory resource library objects are allocated from, e.g. a
+/// std::pmr::synchronized_pool_resource or an AllocatorResource. Objects are
+/// freed to the resource they came from, so the resource may be replaced at any
+/// time but must outlive every object allocated from it. Containers keep the
+/// resource current when they were created. The resource must be thread safe if
+/// delegates are dispatched between threads. Containers created with the default 
+/// resource use the zero allocation pools while armed; a resource set here does not.
+/// @param[in] resource - the resource, or nullptr to restore the default.
+void SetDelegateResource(std::pmr::memory_resource* resource);
+
+/// @brief A std::pmr::memory_resource over a fixed block Allocator. Requests larger
+/// than the block size or needing more alignment than a block has are passed to
+/// the upstream resource, as are requests made while a fixed pool is exhausted. 
+/// Thread safe; a lock is taken unless the Allocator is lock-free.
+class AllocatorResource : public std::pmr::memory_resource
+{
+public:
+	/// Constructor
+	/// @param[in] allocator - the allocator serving requests that fit a block.
+	/// @param[in] upstream - the resource serving all other requests.
+	AllocatorResource(Allocator& allocator, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+		m_allocator(allocator), m_upstream(upstream) {}
+
+private:
+	bool Fits(size_t bytes, size_t alignment) {
+		size_t blockSize = m_allocator.GetBlockSize();
+		return bytes <= blockSize && alignment <= alignof(std::max_align_t) && blockSize % alignment == 0;
+	}
+
+	/// Get a block without reporting an exhausted pool. Heap blocks grow as needed.
+	void* AllocateBlock(size_t bytes) {
+		return m_allocator.IsPool() ? m_allocator.TryAllocate(bytes) : m_allocator.Allocate(bytes);
+	}
+
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		if (!Fits(bytes, alignment))
+			return m_upstream->allocate(bytes, alignment);
+
+		void* ptr;
+		if (m_allocator.IsLockFree())
+			ptr = AllocateBlock(bytes);
+		else
+		{
+			std::lock_guard<std::mutex> lk(m_lock);
+			ptr = AllocateBlock(bytes);
+		}
+		if (ptr)
+			return ptr;
+
+		// A pool block is recognized by its address, so an exhausted pool can 
+		// overflow to the upstream resource
+		if (!m_allocator.IsPool())
+			throw std::bad_alloc();
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+		bool owned = Fits(bytes, alignment) && (!m_allocator.IsPool() || m_allocator.IsPoolBlock(ptr));
+		if (!owned)
+			m_upstream->deallocate(ptr, bytes, alignment);
+		else if (m_allocator.IsLockFree())
+			m_allocator.Deallocate(ptr);
+		else
+		{
+			std::lock_guard<std::mutex> lk(m_lock);
+			m_allocator.Deallocate(ptr);
+		}
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+
+	Allocator& m_allocator;
+	std::pmr::memory_resource* m_upstream;
+	std::mutex m_lock;
+};
+
+#ifdef USE_XALLOCATOR
+/// @brief A std::pmr::memory_resource over the xallocator. Thread safe. Requests
+/// larger than the largest size class are passed to the upstream resource, so
+/// create the resource after any xalloc_configure() call.
+class XallocatorResource : public std::pmr::memory_resource
+{
+public:
+	/// Constructor
+	/// @param[in] upstream - the resource serving requests too large for the xallocator.
+	XallocatorResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+
+	std::pmr::memory_resource* m_upstream;
+	size_t m_maxSize;
+};
+#endif
+
+/// Allocator the library containers are constructed with
+inline std::pmr::polymorphic_allocator<std::byte> GetContainerAllocator() {
+	return std::pmr::polymorphic_allocator<std::byte>(GetDelegateResource());
+}
+
+template <class T> using DelegateList = std::pmr::list<T>;
+template <class T> using DelegateDeque = std::pmr::deque<T>;
+#endif	// USE_CXX17
+
+/// @brief A standard allocator over DelegateAllocate(). Used for shared_ptr control
+/// blocks and, without USE_CXX17, the library containers.
+template <class T>
+class DelegateAllocator
+{
+public:
+	typedef T value_type;
+
+	DelegateAllocator() = default;
+	template <class U> DelegateAllocator(const DelegateAllocator<U>&) {}
+
+	T* allocate(size_t n) { return static_cast<T*>(DelegateAllocate(n * sizeof(T), typeid(T).name())); }
+	void deallocate(T* ptr, size_t) { DelegateDeallocate(ptr); }
+};
+
+template <class T, class U>
+bool operator==(const DelegateAllocator<T>&, const DelegateAllocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const DelegateAllocator<T>&, const DelegateAllocator<U>&) { return false; }
+
+#ifndef USE_CXX17
+/// Allocator the library containers are constructed with
+inline DelegateAllocator<char> GetContainerAllocator() { return DelegateAllocator<char>(); }
+
+template <class T> using DelegateList = std::list<T, DelegateAllocator<T>>;
+template <class T> using DelegateDeque = std::deque<T, DelegateAllocator<T>>;
+#endif
+
+/// Create a shared object and its control block in one DelegateAllocate() block.
+template <class T, class... Args>
+std::shared_ptr<T> MakeShared(Args&&... args) {
+	return std::allocate_shared<T>(DelegateAllocator<T>(), std::forward<Args>(args)...);
+}
+
+/// Take shared ownership of an object, allocating the control block with DelegateAllocate().
+template <class T>
+std::shared_ptr<T> MakeSharedClone(T* object) {
+	return std::shared_ptr<T>(object, std::default_delete<T>(), DelegateAllocator<T>());
+}
+
+}
+
+// Macro to overload new/delete of a library class with DelegateAllocate()
+#define DELEGATE_ALLOCATOR \
+    public: \
+        void* operator new(size_t size) { \
+            return DelegateLib::DelegateAllocate(size); \
+        } \
+        void operator delete(void* pObject) { \
+            DelegateLib::DelegateDeallocate(pObject); \
+        } \
+        void* operator new(size_t, void* mem) { \
+            return mem; \
+        } \
+        void* operator new[](size_t size) { \
+            return DelegateLib::DelegateAllocate(size); \
+        } \
+        void operator delete[](void* pData) { \
+            DelegateLib::DelegateDeallocate(pData); \
+        }
+
+#endif
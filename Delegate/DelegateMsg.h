@@ -3,10 +3,11 @@
 
 #include "Fault.h"
 #include "DelegateInvoker.h"
+#include "DelegateTarget.h"
+#include "DelegateCopyTimer.h"
 #include <memory>
-#ifdef USE_XALLOCATOR
-	#include "xallocator.h"
-#endif
+#include "DelegateMemoryResource.h"
+#include <chrono>
 
 namespace DelegateLib {
 
@@ -14,9 +15,7 @@ class DelegateBase;
 
 class DelegateMsgBase
 {
-#ifdef USE_XALLOCATOR
-	XALLOCATOR
-#endif
+	DELEGATE_ALLOCATOR
 public:
 	/// Constructor
 	/// @param[in] invoker - the invoker instance the delegate is registered with.
@@ -32,10 +31,29 @@ public:
 	/// Get the delegate invoker instance the delegate is registered with.
 	/// @return The invoker instance. 
     std::shared_ptr<IDelegateInvoker> GetDelegateInvoker() const { return m_invoker; }
+
+	/// Record where the message came from. Used by the diagnostics features.
+	/// @param[in] target - the function the delegate invokes.
+	/// @param[in] callTime - when the delegate was called, or a default 
+	///		time_point if not measured.
+	void SetOrigin(const DelegateTarget& target, std::chrono::steady_clock::time_point callTime) {
+		m_target = target;
+		m_callTime = callTime;
+		DelegateCopyTimer::Record(callTime);
+	}
+
+	/// Get the function the delegate invokes. Empty if not set.
+	const DelegateTarget& GetTarget() const { return m_target; }
+
+	/// Get the time the delegate was called. Default time_point if not measured.
+	std::chrono::steady_clock::time_point GetCallTime() const { return m_callTime; }
 	
 private:
     /// The IDelegateInvoker instance 
     std::shared_ptr<IDelegateInvoker> m_invoker;
+
+	DelegateTarget m_target;
+	std::chrono::steady_clock::time_point m_callTime;
 };
 
 /// @brief A class containing the delegate information passed through 
@@ -5,7 +5,9 @@
 // Define either USE_WIN32_THREADS or USE_STD_THREADS to specify WIN32 or std::thread threading model.
 // Define USE_XALLOCATOR to use fixed block memory allocation.
 
-// Define USE_CXX17 is using a C++17 and want additional Delegate library features
+// Define USE_CXX17 is using a C++17 and want additional Delegate library features. With 
+// USE_CXX17 the library allocates from a std::pmr::memory_resource. 
+// @see DelegateMemoryResource.h
 //#define USE_CXX17
 
 #if _MSC_VER >= 1700
@@ -39,4 +41,16 @@
 // @see https://github.com/endurodave/xallocator
 //#define USE_XALLOCATOR 
 
+// Define USE_DELEGATE_LATENCY to compile in end-to-end asynchronous delegate latency 
+// histograms. Recording must also be switched on at runtime with DelegateLatency::SetEnabled().
+// When undefined the instrumentation compiles away.
+// @see DelegateLatency.h
+//#define USE_DELEGATE_LATENCY
+
+// Define USE_DELEGATE_TRACE to compile in tracing of asynchronous delegate activity to 
+// Chrome trace event JSON. Tracing must also be switched on at runtime with 
+// DelegateTrace::SetEnabled(). When undefined the instrumentation compiles away.
+// @see DelegateTrace.h
+//#define USE_DELEGATE_TRACE
+
 #endif
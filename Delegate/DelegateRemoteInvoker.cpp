@@ -1,42 +1,324 @@
 #include "DelegateRemoteInvoker.h"
+#include "DelegateCodec.h"
+#include "DelegateSpan.h"
 #include "Fault.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
 
-namespace DelegateLib 
+namespace DelegateLib
 {
+    enum { MIN_TABLE_SIZE = 16, MAX_NESTED_INVOKES = 4 };
+
+    // A slot's id never changes once the slot is used, so a reader that matched an
+    // id can only ever see an instance registered under that id.
+    struct InvokerSlot
+    {
+        InvokerSlot() : used(false), id(0), invoker(nullptr) {}
+
+        std::atomic<bool> used;
+        DelegateIdType id;                          // Written once before used is set
+        std::atomic<DelegateRemoteInvoker*> invoker; // Null once unregistered
+    };
+
+    // Open-addressed table with linear probing. Kept at most 3/4 full.
+    struct InvokerTable
+    {
+        explicit InvokerTable(size_t size) : mask(size - 1), usedSlots(0), slots(new InvokerSlot[size]) {}
+        ~InvokerTable() { delete[] slots; }
+
+        const size_t mask;
+        size_t usedSlots;                           // Writer only
+        InvokerSlot* const slots;
+    };
+
+    // Hazard pointers of one thread. A record is reused by a later thread once its
+    // owner exits and is never freed.
+    struct HazardRecord
+    {
+        HazardRecord() : active(true), table(nullptr), depth(0), pNext(nullptr)
+        {
+            for (int i = 0; i < MAX_NESTED_INVOKES; i++)
+                invokers[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        std::atomic<bool> active;
+        std::atomic<InvokerTable*> table;           // Table being searched
+        std::atomic<DelegateRemoteInvoker*> invokers[MAX_NESTED_INVOKES]; // Instances being invoked
+        int depth;                                  // Owner only
+        HazardRecord* pNext;                        // Set before the record is published
+    };
+
+    struct InvokerRegistry
+    {
+        InvokerRegistry() : table(nullptr), records(nullptr) {}
+
+        std::atomic<InvokerTable*> table;
+        std::atomic<HazardRecord*> records;
+        std::vector<InvokerTable*> retired;         // Replaced tables still in use by a reader
+        std::mutex lock;                            // Serializes writers
+    };
+
+    // Never destroyed so instances destroyed during static destruction still find it
+    static InvokerRegistry& GetRegistry()
+    {
+        static auto registry = new InvokerRegistry();
+        return *registry;
+    }
+
+    // Releases the thread's hazard record for reuse when the thread exits
+    struct HazardRecordOwner
+    {
+        HazardRecordOwner() : record(nullptr) {}
+        ~HazardRecordOwner()
+        {
+            if (record)
+                record->active.store(false, std::memory_order_release);
+        }
+
+        HazardRecord* record;
+    };
+
+    static thread_local HazardRecordOwner _hazardOwner;
+
+    //------ GetHazardRecord ------
+    static HazardRecord* GetHazardRecord()
+    {
+        if (_hazardOwner.record)
+            return _hazardOwner.record;
+
+        // Reuse the record of an exited thread, else publish a new one
+        InvokerRegistry& registry = GetRegistry();
+        HazardRecord* record = registry.records.load(std::memory_order_acquire);
+        for (; record; record = record->pNext)
+        {
+            bool expected = false;
+            if (!record->active.load(std::memory_order_relaxed) &&
+                record->active.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                break;
+        }
+
+        if (!record)
+        {
+            record = new HazardRecord();
+            HazardRecord* head = registry.records.load(std::memory_order_relaxed);
+            do
+            {
+                record->pNext = head;
+            } while (!registry.records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        _hazardOwner.record = record;
+        return record;
+    }
+
+    //------ HashId ------
+    static size_t HashId(DelegateIdType id)
+    {
+        // Spread ids that differ only in their high bits
+        uint32_t h = static_cast<uint32_t>(id);
+        h ^= h >> 16;
+        h *= 0x45d9f3bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    //------ FindSlot ------
+    // Get the slot used by an id, or nullptr if the id never had one
+    static InvokerSlot* FindSlot(InvokerTable* table, DelegateIdType id)
+    {
+        for (size_t i = HashId(id) & table->mask; ; i = (i + 1) & table->mask)
+        {
+            InvokerSlot& slot = table->slots[i];
+            if (!slot.used.load(std::memory_order_acquire))
+                return nullptr;
+            if (slot.id == id)
+                return &slot;
+        }
+    }
+
+    //------ ClaimSlot ------
+    // Get the slot for an id, using an empty slot if the id has none. Writer lock held.
+    static InvokerSlot* ClaimSlot(InvokerTable* table, DelegateIdType id)
+    {
+        for (size_t i = HashId(id) & table->mask; ; i = (i + 1) & table->mask)
+        {
+            InvokerSlot& slot = table->slots[i];
+            if (!slot.used.load(std::memory_order_relaxed))
+            {
+                slot.id = id;
+                slot.used.store(true, std::memory_order_release);
+                table->usedSlots++;
+                return &slot;
+            }
+            if (slot.id == id)
+                return &slot;
+        }
+    }
+
+    //------ ReclaimTables ------
+    // Free replaced tables no reader is searching. Writer lock held.
+    static void ReclaimTables(InvokerRegistry& registry)
+    {
+        for (size_t i = 0; i < registry.retired.size(); )
+        {
+            bool inUse = false;
+            for (HazardRecord* r = registry.records.load(std::memory_order_acquire); r && !inUse; r = r->pNext)
+                inUse = r->table.load(std::memory_order_seq_cst) == registry.retired[i];
+
+            if (inUse)
+            {
+                i++;
+            }
+            else
+            {
+                delete registry.retired[i];
+                registry.retired[i] = registry.retired.back();
+                registry.retired.pop_back();
+            }
+        }
+    }
+
+    //------ ReserveSlot ------
+    // Get the current table with room for one more id. A full table is replaced by
+    // a copy holding only the registered ids. Writer lock held.
+    static InvokerTable* ReserveSlot(InvokerRegistry& registry)
+    {
+        InvokerTable* table = registry.table.load(std::memory_order_relaxed);
+        if (table && (table->usedSlots + 1) * 4 <= (table->mask + 1) * 3)
+            return table;
+
+        size_t live = 0;
+        for (size_t i = 0; table && i <= table->mask; i++)
+        {
+            if (table->slots[i].invoker.load(std::memory_order_relaxed))
+                live++;
+        }
+
+        size_t size = MIN_TABLE_SIZE;
+        while ((live + 1) * 2 > size)
+            size *= 2;
+
+        InvokerTable* newTable = new InvokerTable(size);
+        for (size_t i = 0; table && i <= table->mask; i++)
+        {
+            DelegateRemoteInvoker* invoker = table->slots[i].invoker.load(std::memory_order_relaxed);
+            if (invoker)
+                ClaimSlot(newTable, table->slots[i].id)->invoker.store(invoker, std::memory_order_relaxed);
+        }
+
+        registry.table.store(newTable, std::memory_order_seq_cst);
+        if (table)
+            registry.retired.push_back(table);
+        ReclaimTables(registry);
+        return newTable;
+    }
+
     DelegateRemoteInvoker::DelegateRemoteInvoker(DelegateIdType id) : m_id(id)
     {
-        LockGuard lockGuard(GetLock());
+    }
+
+    DelegateRemoteInvoker::~DelegateRemoteInvoker()
+    {
+        Unregister();
+    }
+
+    void DelegateRemoteInvoker::Register()
+    {
+        InvokerRegistry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.lock);
 
         // Don't allow duplicate entries
-        std::map<DelegateIdType, DelegateRemoteInvoker*>::iterator it = GetMap().find(m_id);
-        ASSERT_TRUE(it == GetMap().end());
+        InvokerTable* table = registry.table.load(std::memory_order_relaxed);
+        InvokerSlot* slot = table ? FindSlot(table, m_id) : nullptr;
+        if (!slot)
+            slot = ClaimSlot(ReserveSlot(registry), m_id);
+        ASSERT_TRUE(slot->invoker.load(std::memory_order_relaxed) == nullptr);
 
-        GetMap()[m_id] = this;
+        slot->invoker.store(this, std::memory_order_seq_cst);
     }
 
-    DelegateRemoteInvoker::~DelegateRemoteInvoker()
+    void DelegateRemoteInvoker::Unregister()
     {
-        LockGuard lockGuard(GetLock());
-        GetMap().erase(m_id);
+        InvokerRegistry& registry = GetRegistry();
+        {
+            std::lock_guard<std::mutex> lock(registry.lock);
+
+            // A copy of a registered instance was never registered itself
+            InvokerTable* table = registry.table.load(std::memory_order_relaxed);
+            InvokerSlot* slot = table ? FindSlot(table, m_id) : nullptr;
+            if (!slot || slot->invoker.load(std::memory_order_relaxed) != this)
+                return;
+
+            slot->invoker.store(nullptr, std::memory_order_seq_cst);
+            ReclaimTables(registry);
+        }
+
+        // Wait for invokes on other threads. The calling thread is skipped so a
+        // delegate may destroy its own receiver.
+        HazardRecord* self = _hazardOwner.record;
+        for (HazardRecord* r = registry.records.load(std::memory_order_acquire); r; r = r->pNext)
+        {
+            if (r == self)
+                continue;
+            for (int i = 0; i < MAX_NESTED_INVOKES; i++)
+            {
+                while (r->invokers[i].load(std::memory_order_seq_cst) == this)
+                    std::this_thread::yield();
+            }
+        }
     }
-    
+
     bool DelegateRemoteInvoker::Invoke(std::istream& s)
     {
-        // Get id from stream
+        // Get id from stream. A binary codec frame starts with a marker byte.
         DelegateIdType id;
-        s >> id;
+        if (s.peek() == DelegateBinaryCodec::MAGIC)
+            DelegateBinaryCodec::ReadId(s, id);
+        else
+            s >> id;
         s.seekg(0);
 
-        // Find invoker instance matching the id
-        std::map<DelegateIdType, DelegateRemoteInvoker*>::iterator it;
+        InvokerRegistry& registry = GetRegistry();
+        HazardRecord* record = GetHazardRecord();
+        ASSERT_TRUE(record->depth < MAX_NESTED_INVOKES);
+        std::atomic<DelegateRemoteInvoker*>& hazard = record->invokers[record->depth];
+
+        // Find invoker instance matching the id. Protect the table, then the instance,
+        // and retry if either was replaced or unregistered in between.
+        DelegateRemoteInvoker* invoker = nullptr;
+        for (;;)
         {
-            LockGuard lockGuard(GetLock());
-            it = GetMap().find(id);
+            InvokerTable* table = registry.table.load(std::memory_order_seq_cst);
+            if (!table)
+                break;
+            record->table.store(table, std::memory_order_seq_cst);
+            if (registry.table.load(std::memory_order_seq_cst) != table)
+                continue;
+
+            InvokerSlot* slot = FindSlot(table, id);
+            invoker = slot ? slot->invoker.load(std::memory_order_seq_cst) : nullptr;
+            if (!invoker)
+                break;
+
+            hazard.store(invoker, std::memory_order_seq_cst);
+            if (registry.table.load(std::memory_order_seq_cst) == table &&
+                slot->invoker.load(std::memory_order_seq_cst) == invoker)
+                break;
+            hazard.store(nullptr, std::memory_order_release);
+            invoker = nullptr;
         }
-        if (it != GetMap().end())
+        record->table.store(nullptr, std::memory_order_release);
+
+        if (invoker)
         {
             // Invoke the delegate instance
-            (*it).second->DelegateInvoke(s);
+            record->depth++;
+            invoker->DelegateInvoke(s);
+            record->depth--;
+            hazard.store(nullptr, std::memory_order_release);
             return true;
         }
         else
@@ -45,4 +327,10 @@ namespace DelegateLib
             return false;
         }
     }
-}
\ No newline at end of file
+
+    bool DelegateRemoteInvoker::Invoke(const void* data, size_t size)
+    {
+        DelegateSpanReader reader(data, size);
+        return Invoke(reader);
+    }
+}
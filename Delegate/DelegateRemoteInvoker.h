@@ -1,15 +1,20 @@
 #ifndef _DELEGATE_REMOTE_INVOKER_H
 #define _DELEGATE_REMOTE_INVOKER_H
 
-#include "LockGuard.h"
+#include <stddef.h>
 #include <istream>
-#include <map>
 
 namespace DelegateLib {
 
 typedef int DelegateIdType;
 
 /// @brief An abstract base class used to invoke a delegate on a remote system. 
+/// @details Instances register by id in an open-addressed table. Invoke() finds the
+/// instance without locking, so any number of receive threads may dispatch at once.
+/// Each dispatching thread publishes a hazard pointer to the instance it calls, and
+/// the destructor waits until no other thread holds one, so an instance may be
+/// destroyed while remote messages are still arriving. Registration and destruction
+/// are serialized with each other but never block Invoke().
 class DelegateRemoteInvoker
 {
 public:
@@ -20,30 +25,33 @@ public:
     /// Destructor
     ~DelegateRemoteInvoker();
 
-    /// Invoke a remote delegate
+    /// Invoke a remote delegate. Accepts frames of any codec in DelegateCodec.h.
     /// @param[in] s - the incoming remote message stream. 
     static bool Invoke(std::istream& s);
 
+    /// Invoke a remote delegate from a message held in contiguous memory, such as
+    /// a socket or shared memory receive buffer. Decodes in place without copying
+    /// the message into a stream.
+    /// @param[in] data - the incoming remote message.
+    /// @param[in] size - the message size in bytes.
+    static bool Invoke(const void* data, size_t size);
+
 protected:
     /// Called to invoke the callback by the remote system. 
     /// @param[in] s - the incoming remote message stream. 
     virtual void DelegateInvoke(std::istream& s) = 0;
 
+    /// Add this instance to the dispatch table. Derived constructors call it last so
+    /// Invoke() never finds a partly constructed object.
+    void Register();
+
+    /// Remove this instance from the dispatch table and wait for Invoke() calls on
+    /// other threads to return. Derived destructors call it first so DelegateInvoke()
+    /// never runs on a partly destroyed object. Safe to call more than once.
+    void Unregister();
+
 private:
     DelegateIdType m_id;
-
-    static std::map<DelegateIdType, DelegateRemoteInvoker*>& GetMap()
-    {
-        static std::map<DelegateIdType, DelegateRemoteInvoker*> map;
-        return map;
-    }
-
-    static LOCK* GetLock()
-    {
-        static LOCK lock;
-        static LockCreateDestroy lockCreateDestroy(lock);
-        return &lock;
-    }
 };
 
 }
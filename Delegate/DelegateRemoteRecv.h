@@ -8,6 +8,8 @@
 #include "Delegate.h"
 #include "DelegateTransport.h"
 #include "DelegateRemoteInvoker.h"
+#include "DelegateCodec.h"
+#include <type_traits>
 
 namespace DelegateLib {
 
@@ -20,13 +22,14 @@ private:
     Param m_param;
 };
 
+// Storage is non-const so const pointer and reference arguments can be decoded
 template <class Param>
 class RemoteParam<Param*>
 {
 public:
     Param* Get() { return &m_param; }
 private:
-    Param m_param;
+    typename std::remove_const<Param>::type m_param;
 };
 
 template <class Param>
@@ -36,7 +39,7 @@ public:
     RemoteParam() { m_pParam = &m_param; }
     Param ** Get() { return &m_pParam; }
 private:
-    Param m_param;
+    typename std::remove_const<Param>::type m_param;
     Param* m_pParam;
 };
 
@@ -46,30 +49,31 @@ class RemoteParam<Param&>
 public:
     Param & Get() { return m_param; }
 private:
-    Param m_param;
+    typename std::remove_const<Param>::type m_param;
 };
 
 // Declare DelegateMemberRemoteRecv as a class template. It will be specialized for all number of arguments.
-template <typename Signature>
+template <typename Signature, class Codec = DelegateTextCodec>
 class DelegateMemberRemoteRecv;
 
-/// @brief Receive a delegate from a remote system and invoke the bound function. 
-template <class TClass, class Param1>
-class DelegateMemberRemoteRecv<void(TClass(Param1))> : public DelegateMember<void(TClass(Param1))>, public DelegateRemoteInvoker {
+/// @brief Receive a delegate from a remote system and invoke the bound function. The 
+/// Codec decodes the arguments and must match the sender's. 
+template <class TClass, class Param1, class Codec>
+class DelegateMemberRemoteRecv<void(TClass(Param1)), Codec> : public DelegateMember<void(TClass(Param1))>, public DelegateRemoteInvoker {
 public:
     typedef TClass* ObjectPtr;
     typedef void (TClass::*MemberFunc)(Param1);
     typedef void (TClass::*ConstMemberFunc)(Param1) const;
-    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1))>;
+    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1)), Codec>;
     using BaseType = DelegateMember<void(TClass(Param1))>;
 
     // Contructors take a class instance, member function, and delegete id 
     DelegateMemberRemoteRecv(ObjectPtr object, MemberFunc func, DelegateIdType id) : 
         BaseType(object, func),
-        DelegateRemoteInvoker(id) { Bind(object, func, id); }
+        DelegateRemoteInvoker(id) { Bind(object, func, id); Register(); }
     DelegateMemberRemoteRecv(ObjectPtr object, ConstMemberFunc func, DelegateIdType id) : 
         BaseType(object, func),
-        DelegateRemoteInvoker(id) { Bind(object, func, id); }
+        DelegateRemoteInvoker(id) { Bind(object, func, id); Register(); }
 
     /// Bind a member function to a delegate. 
     void Bind(ObjectPtr object, MemberFunc func, DelegateIdType id) {
@@ -83,6 +87,9 @@ public:
         BaseType::Bind(object, func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateMemberRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -91,10 +98,13 @@ public:
 
         Param1 p1 = param1.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1);
     }
@@ -110,13 +120,13 @@ public:
         DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class TClass, class Param1, class Param2>
-class DelegateMemberRemoteRecv<void(TClass(Param1, Param2))> : public DelegateMember<void(TClass(Param1, Param2))>, public DelegateRemoteInvoker {
+template <class TClass, class Param1, class Param2, class Codec>
+class DelegateMemberRemoteRecv<void(TClass(Param1, Param2)), Codec> : public DelegateMember<void(TClass(Param1, Param2))>, public DelegateRemoteInvoker {
 public:
     typedef TClass* ObjectPtr;
     typedef void (TClass::*MemberFunc)(Param1, Param2);
     typedef void (TClass::*ConstMemberFunc)(Param1, Param2) const;
-    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2))>;
+    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2)), Codec>;
     using BaseType = DelegateMember<void(TClass(Param1, Param2))>;
 
     // Contructors take a class instance, member function, and delegete id 
@@ -124,11 +134,13 @@ public:
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
     DelegateMemberRemoteRecv(ObjectPtr object, ConstMemberFunc func, DelegateIdType id) :
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
 
     /// Bind a member function to a delegate. 
@@ -143,6 +155,9 @@ public:
         BaseType::Bind(object, func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateMemberRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -153,12 +168,14 @@ public:
         Param1 p1 = param1.Get();
         Param2 p2 = param2.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2);
     }
@@ -174,13 +191,13 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class TClass, class Param1, class Param2, class Param3>
-class DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3))> : public DelegateMember<void(TClass(Param1, Param2, Param3))>, public DelegateRemoteInvoker {
+template <class TClass, class Param1, class Param2, class Param3, class Codec>
+class DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3)), Codec> : public DelegateMember<void(TClass(Param1, Param2, Param3))>, public DelegateRemoteInvoker {
 public:
     typedef TClass* ObjectPtr;
     typedef void (TClass::*MemberFunc)(Param1, Param2, Param3);
     typedef void (TClass::*ConstMemberFunc)(Param1, Param2, Param3) const;
-    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3))>;
+    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3)), Codec>;
     using BaseType = DelegateMember<void(TClass(Param1, Param2, Param3))>;
 
     // Contructors take a class instance, member function, and delegete id 
@@ -188,11 +205,13 @@ public:
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
     DelegateMemberRemoteRecv(ObjectPtr object, ConstMemberFunc func, DelegateIdType id) :
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
 
     /// Bind a member function to a delegate. 
@@ -207,6 +226,9 @@ public:
         BaseType::Bind(object, func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateMemberRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this);
     }
 
@@ -220,14 +242,15 @@ public:
         Param2 p2 = param2.Get();
         Param3 p3 = param3.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p3;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+        Codec::Read(stream, p3);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2, p3);
     }
@@ -243,13 +266,13 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class TClass, class Param1, class Param2, class Param3, class Param4>
-class DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4))> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4))>, public DelegateRemoteInvoker {
+template <class TClass, class Param1, class Param2, class Param3, class Param4, class Codec>
+class DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4)), Codec> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4))>, public DelegateRemoteInvoker {
 public:
     typedef TClass* ObjectPtr;
     typedef void (TClass::*MemberFunc)(Param1, Param2, Param3, Param4);
     typedef void (TClass::*ConstMemberFunc)(Param1, Param2, Param3, Param4) const;
-    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4))>;
+    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4)), Codec>;
     using BaseType = DelegateMember<void(TClass(Param1, Param2, Param3, Param4))>;
 
     // Contructors take a class instance, member function, and delegete id 
@@ -257,11 +280,13 @@ public:
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
     DelegateMemberRemoteRecv(ObjectPtr object, ConstMemberFunc func, DelegateIdType id) :
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
 
     /// Bind a member function to a delegate. 
@@ -276,6 +301,9 @@ public:
         BaseType::Bind(object, func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateMemberRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -290,16 +318,16 @@ public:
         Param3 p3 = param3.Get();
         Param4 p4 = param4.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p3;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p4;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+        Codec::Read(stream, p3);
+        Codec::Read(stream, p4);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2, p3, p4);
     }
@@ -315,13 +343,13 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5>
-class DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5))> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4, Param5))>, public DelegateRemoteInvoker {
+template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+class DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5)), Codec> : public DelegateMember<void(TClass(Param1, Param2, Param3, Param4, Param5))>, public DelegateRemoteInvoker {
 public:
     typedef TClass* ObjectPtr;
     typedef void (TClass::*MemberFunc)(Param1, Param2, Param3, Param4, Param5);
     typedef void (TClass::*ConstMemberFunc)(Param1, Param2, Param3, Param4, Param5) const;
-    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5))>;
+    using ClassType = DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5)), Codec>;
     using BaseType = DelegateMember<void(TClass(Param1, Param2, Param3, Param4, Param5))>;
 
     // Contructors take a class instance, member function, and delegete id 
@@ -329,11 +357,13 @@ public:
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
     DelegateMemberRemoteRecv(ObjectPtr object, ConstMemberFunc func, DelegateIdType id) :
         BaseType(object, func),
         DelegateRemoteInvoker(id) {
         Bind(object, func, id);
+        Register();
     }
 
     /// Bind a member function to a delegate. 
@@ -348,6 +378,9 @@ public:
         BaseType::Bind(object, func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateMemberRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this);
     }
 
@@ -365,18 +398,17 @@ public:
         Param4 p4 = param4.Get();
         Param4 p5 = param5.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p3;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p4;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p5;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+        Codec::Read(stream, p3);
+        Codec::Read(stream, p4);
+        Codec::Read(stream, p5);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2, p3, p4, p5);
     }
@@ -393,20 +425,20 @@ private:
 };
 
 // Declare DelegateFreeRemoteRecv as a class template. It will be specialized for all number of arguments.
-template <typename Signature>
+template <typename Signature, class Codec = DelegateTextCodec>
 class DelegateFreeRemoteRecv;
 
-template <class Param1>
-class DelegateFreeRemoteRecv<void(Param1)> : public DelegateFree<void(Param1)>, public DelegateRemoteInvoker {
+template <class Param1, class Codec>
+class DelegateFreeRemoteRecv<void(Param1), Codec> : public DelegateFree<void(Param1)>, public DelegateRemoteInvoker {
 public:
     typedef void(*FreeFunc)(Param1);
-    using ClassType = DelegateFreeRemoteRecv<void(Param1)>;
+    using ClassType = DelegateFreeRemoteRecv<void(Param1), Codec>;
     using BaseType = DelegateFree<void(Param1)>;
 
     // Contructors take a free function and delegete id 
     DelegateFreeRemoteRecv(FreeFunc func, DelegateIdType id) : 
         BaseType(func), 
-        DelegateRemoteInvoker(id) { Bind(func, id); }
+        DelegateRemoteInvoker(id) { Bind(func, id); Register(); }
 
     /// Bind a free function to the delegate.
     void Bind(FreeFunc func, DelegateIdType id) {
@@ -414,6 +446,9 @@ public:
         BaseType::Bind(func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateFreeRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -422,10 +457,13 @@ public:
 
         Param1 p1 = param1.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1);
     }
@@ -441,17 +479,17 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class Param1, class Param2>
-class DelegateFreeRemoteRecv<void(Param1, Param2)> : public DelegateFree<void(Param1, Param2)>, public DelegateRemoteInvoker {
+template <class Param1, class Param2, class Codec>
+class DelegateFreeRemoteRecv<void(Param1, Param2), Codec> : public DelegateFree<void(Param1, Param2)>, public DelegateRemoteInvoker {
 public:
     typedef void(*FreeFunc)(Param1, Param2);
-    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2)>;
+    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2), Codec>;
     using BaseType = DelegateFree<void(Param1, Param2)>;
 
     // Contructors take a free function and delegete id 
     DelegateFreeRemoteRecv(FreeFunc func, DelegateIdType id) : 
         BaseType(func), 
-        DelegateRemoteInvoker(id) { Bind(func, id); }
+        DelegateRemoteInvoker(id) { Bind(func, id); Register(); }
 
     /// Bind a free function to the delegate.
     void Bind(FreeFunc func, DelegateIdType id) {
@@ -459,6 +497,9 @@ public:
         BaseType::Bind(func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateFreeRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -469,12 +510,14 @@ public:
         Param1 p1 = param1.Get();
         Param2 p2 = param2.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2);
     }
@@ -490,17 +533,17 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class Param1, class Param2, class Param3>
-class DelegateFreeRemoteRecv<void(Param1, Param2, Param3)> : public DelegateFree<void(Param1, Param2, Param3)>, public DelegateRemoteInvoker {
+template <class Param1, class Param2, class Param3, class Codec>
+class DelegateFreeRemoteRecv<void(Param1, Param2, Param3), Codec> : public DelegateFree<void(Param1, Param2, Param3)>, public DelegateRemoteInvoker {
 public:
     typedef void(*FreeFunc)(Param1, Param2, Param3);
-    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2, Param3)>;
+    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2, Param3), Codec>;
     using BaseType = DelegateFree<void(Param1, Param2, Param3)>;
 
     // Contructors take a free function and delegete id 
     DelegateFreeRemoteRecv(FreeFunc func, DelegateIdType id) : 
         BaseType(func), 
-        DelegateRemoteInvoker(id) { Bind(func, id); }
+        DelegateRemoteInvoker(id) { Bind(func, id); Register(); }
 
     /// Bind a free function to the delegate.
     void Bind(FreeFunc func, DelegateIdType id) {
@@ -508,6 +551,9 @@ public:
         BaseType::Bind(func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateFreeRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -520,14 +566,15 @@ public:
         Param2 p2 = param2.Get();
         Param3 p3 = param3.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p3;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+        Codec::Read(stream, p3);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2, p3);
     }
@@ -543,17 +590,17 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class Param1, class Param2, class Param3, class Param4>
-class DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4)> : public DelegateFree<void(Param1, Param2, Param3, Param4)>, public DelegateRemoteInvoker {
+template <class Param1, class Param2, class Param3, class Param4, class Codec>
+class DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4), Codec> : public DelegateFree<void(Param1, Param2, Param3, Param4)>, public DelegateRemoteInvoker {
 public:
     typedef void(*FreeFunc)(Param1, Param2, Param3, Param4);
-    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4)>;
+    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4), Codec>;
     using BaseType = DelegateFree<void(Param1, Param2, Param3, Param4)>;
 
     // Contructors take a free function and delegete id 
     DelegateFreeRemoteRecv(FreeFunc func, DelegateIdType id) : 
         BaseType(func), 
-        DelegateRemoteInvoker(id) { Bind(func, id); }
+        DelegateRemoteInvoker(id) { Bind(func, id); Register(); }
 
     /// Bind a free function to the delegate.
     void Bind(FreeFunc func, DelegateIdType id) {
@@ -561,6 +608,9 @@ public:
         BaseType::Bind(func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateFreeRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -575,16 +625,16 @@ public:
         Param3 p3 = param3.Get();
         Param4 p4 = param4.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p3;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p4;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+        Codec::Read(stream, p3);
+        Codec::Read(stream, p4);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2, p3, p4);
     }
@@ -600,17 +650,17 @@ private:
     DelegateIdType m_id = 0;               // Remote delegate identifier
 };
 
-template <class Param1, class Param2, class Param3, class Param4, class Param5>
-class DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5)> : public DelegateFree<void(Param1, Param2, Param3, Param4, Param5)>, public DelegateRemoteInvoker {
+template <class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+class DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5), Codec> : public DelegateFree<void(Param1, Param2, Param3, Param4, Param5)>, public DelegateRemoteInvoker {
 public:
     typedef void(*FreeFunc)(Param1, Param2, Param3, Param4, Param5);
-    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5)>;
+    using ClassType = DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5), Codec>;
     using BaseType = DelegateFree<void(Param1, Param2, Param3, Param4, Param5)>;
 
     // Contructors take a free function and delegete id 
     DelegateFreeRemoteRecv(FreeFunc func, DelegateIdType id) : 
         BaseType(func), 
-        DelegateRemoteInvoker(id) { Bind(func, id); }
+        DelegateRemoteInvoker(id) { Bind(func, id); Register(); }
 
     /// Bind a free function to the delegate.
     void Bind(FreeFunc func, DelegateIdType id) {
@@ -618,6 +668,9 @@ public:
         BaseType::Bind(func);
     }
 
+    // Unregister while the derived object is intact so in-flight invokes finish first
+    ~DelegateFreeRemoteRecv() { Unregister(); }
+
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Called by the remote system to invoke the delegate function
@@ -634,18 +687,17 @@ public:
         Param4 p4 = param4.Get();
         Param5 p5 = param5.Get();
 
-        stream >> m_id;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p1;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p2;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p3;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p4;
-        stream.seekg(stream.tellg() + std::streampos(1));
-        stream >> p5;
-        stream.seekg(stream.tellg() + std::streampos(1));
+        DelegateIdType id;
+        Codec::ReadId(stream, id);
+        Codec::Read(stream, p1);
+        Codec::Read(stream, p2);
+        Codec::Read(stream, p3);
+        Codec::Read(stream, p4);
+        Codec::Read(stream, p5);
+
+        // Drop a message that could not be decoded
+        if (stream.fail())
+            return;
 
         BaseType::operator()(p1, p2, p3, p4, p5);
     }
@@ -677,6 +729,21 @@ DelegateFreeRemoteRecv<void(Param1)> MakeDelegate(void(*func)(Param1 p1), Delega
     return DelegateFreeRemoteRecv<void(Param1)>(func, id);
 }
 
+template <class TClass, class Param1, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1), DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1)), Codec>(object, func, id);
+}
+
+template <class TClass, class Param1, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1) const, DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1)), Codec>(object, func, id);
+}
+
+template <class Param1, class Codec>
+DelegateFreeRemoteRecv<void(Param1), Codec> MakeDelegate(void(*func)(Param1 p1), DelegateIdType id, Codec) {
+    return DelegateFreeRemoteRecv<void(Param1), Codec>(func, id);
+}
+
 //N=2
 template <class TClass, class Param1, class Param2>
 DelegateMemberRemoteRecv<void(TClass(Param1, Param2))> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2), DelegateIdType id) {
@@ -693,6 +760,21 @@ DelegateFreeRemoteRecv<void(Param1, Param2)> MakeDelegate(void(*func)(Param1 p1,
     return DelegateFreeRemoteRecv<void(Param1, Param2)>(func, id);
 }
 
+template <class TClass, class Param1, class Param2, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2), DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2)), Codec>(object, func, id);
+}
+
+template <class TClass, class Param1, class Param2, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2) const, DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2)), Codec>(object, func, id);
+}
+
+template <class Param1, class Param2, class Codec>
+DelegateFreeRemoteRecv<void(Param1, Param2), Codec> MakeDelegate(void(*func)(Param1 p1, Param2 p2), DelegateIdType id, Codec) {
+    return DelegateFreeRemoteRecv<void(Param1, Param2), Codec>(func, id);
+}
+
 //N=3
 template <class TClass, class Param1, class Param2, class Param3>
 DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3))> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3), DelegateIdType id) {
@@ -709,6 +791,21 @@ DelegateFreeRemoteRecv<void(Param1, Param2, Param3)> MakeDelegate(void(*func)(Pa
     return DelegateFreeRemoteRecv<void(Param1, Param2, Param3)>(func, id);
 }
 
+template <class TClass, class Param1, class Param2, class Param3, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3), DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3)), Codec>(object, func, id);
+}
+
+template <class TClass, class Param1, class Param2, class Param3, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3) const, DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3)), Codec>(object, func, id);
+}
+
+template <class Param1, class Param2, class Param3, class Codec>
+DelegateFreeRemoteRecv<void(Param1, Param2, Param3), Codec> MakeDelegate(void(*func)(Param1 p1, Param2 p2, Param3 p3), DelegateIdType id, Codec) {
+    return DelegateFreeRemoteRecv<void(Param1, Param2, Param3), Codec>(func, id);
+}
+
 //N=4
 template <class TClass, class Param1, class Param2, class Param3, class Param4>
 DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4))> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4), DelegateIdType id) {
@@ -725,6 +822,21 @@ DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4)> MakeDelegate(void(*
     return DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4)>(func, id);
 }
 
+template <class TClass, class Param1, class Param2, class Param3, class Param4, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4), DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4)), Codec>(object, func, id);
+}
+
+template <class TClass, class Param1, class Param2, class Param3, class Param4, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4) const, DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4)), Codec>(object, func, id);
+}
+
+template <class Param1, class Param2, class Param3, class Param4, class Codec>
+DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4), Codec> MakeDelegate(void(*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4), DelegateIdType id, Codec) {
+    return DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4), Codec>(func, id);
+}
+
 //N=5
 template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5>
 DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5))> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5), DelegateIdType id) {
@@ -741,6 +853,21 @@ DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5)> MakeDelegat
     return DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5)>(func, id);
 }
 
+template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5), DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5)), Codec>(object, func, id);
+}
+
+template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5)), Codec> MakeDelegate(TClass* object, void (TClass::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) const, DelegateIdType id, Codec) {
+    return DelegateMemberRemoteRecv<void(TClass(Param1, Param2, Param3, Param4, Param5)), Codec>(object, func, id);
+}
+
+template <class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5), Codec> MakeDelegate(void(*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5), DelegateIdType id, Codec) {
+    return DelegateFreeRemoteRecv<void(Param1, Param2, Param3, Param4, Param5), Codec>(func, id);
+}
+
 }
 
 #endif
@@ -8,29 +8,38 @@
 #include "Delegate.h"
 #include "DelegateTransport.h"
 #include "DelegateRemoteInvoker.h"
+#include "DelegateCodec.h"
+#include "DelegateEncodeBuffer.h"
 
 namespace DelegateLib {
 
 // Declare DelegateRemoteSend as a class template. It will be specialized for all number of arguments.
-template <typename Signature>
+template <typename Signature, class Codec = DelegateTextCodec>
 class DelegateRemoteSend;
 
-/// @brief Send a delegate to invoke a function on a remote system. 
-template <class Param1>
-class DelegateRemoteSend<void(Param1)> : public Delegate<void(Param1)> {
+/// @brief Send a delegate to invoke a function on a remote system. The Codec, e.g. 
+/// DelegateBinaryCodec, encodes the arguments and must match the receiver's. 
+template <class Param1, class Codec>
+class DelegateRemoteSend<void(Param1), Codec> : public Delegate<void(Param1)> {
 public:
-    using ClassType = DelegateRemoteSend<void(Param1)>;
+    using ClassType = DelegateRemoteSend<void(Param1), Codec>;
 
     DelegateRemoteSend(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) : 
-        m_transport(transport), m_stream(stream), m_id(id) { }
+        m_transport(transport), m_stream(&stream), m_id(id) { }
+
+    /// Encode each call into a buffer leased from the calling thread, so the delegate
+    /// may be invoked from any number of threads at once.
+    DelegateRemoteSend(IDelegateTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_stream(nullptr), m_id(id) { }
 
 	virtual ClassType* Clone() const override { return new ClassType(*this); }
 
 	/// Invoke the bound delegate function. 
 	virtual void operator()(Param1 p1) override {
-        m_stream << m_id << std::ends;
-        m_stream << p1 << std::ends;
-        m_transport.DispatchDelegate(m_stream);
+        if (m_stream)
+            Send(*m_stream, p1);
+        else
+            Send(DelegateEncodeLease<DelegateEncodeStream>().Get(), p1);
     }
 
 	virtual bool operator==(const DelegateBase& rhs) const override {
@@ -40,27 +49,39 @@ public:
             &m_transport == &derivedRhs->m_transport; }
 
 private:
+    /// Encode one call and hand the complete message to the transport
+    void Send(std::iostream& stream, Param1& p1) {
+        Codec::WriteId(stream, m_id);
+        Codec::Write(stream, p1);
+        m_transport.DispatchDelegate(stream);
+    }
+
 	IDelegateTransport& m_transport;    // Object sends data to remote
-    std::iostream& m_stream;            // Storage for remote message 
+    std::iostream* m_stream;            // Storage for remote message, or nullptr to lease one per call
     DelegateIdType m_id = 0;                // Remote delegate identifier
 };
 
-template <class Param1, class Param2>
-class DelegateRemoteSend<void(Param1, Param2)> : public Delegate<void(Param1, Param2)> {
+template <class Param1, class Param2, class Codec>
+class DelegateRemoteSend<void(Param1, Param2), Codec> : public Delegate<void(Param1, Param2)> {
 public:
-    using ClassType = DelegateRemoteSend<void(Param1, Param2)>;
+    using ClassType = DelegateRemoteSend<void(Param1, Param2), Codec>;
 
     DelegateRemoteSend(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) :
-        m_transport(transport), m_stream(stream), m_id(id) { }
+        m_transport(transport), m_stream(&stream), m_id(id) { }
+
+    /// Encode each call into a buffer leased from the calling thread, so the delegate
+    /// may be invoked from any number of threads at once.
+    DelegateRemoteSend(IDelegateTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_stream(nullptr), m_id(id) { }
 
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Invoke the bound delegate function. 
     virtual void operator()(Param1 p1, Param2 p2) override {
-        m_stream << m_id << std::ends;
-        m_stream << p1 << std::ends;
-        m_stream << p2 << std::ends;
-        m_transport.DispatchDelegate(m_stream);
+        if (m_stream)
+            Send(*m_stream, p1, p2);
+        else
+            Send(DelegateEncodeLease<DelegateEncodeStream>().Get(), p1, p2);
     }
 
     virtual bool operator==(const DelegateBase& rhs) const override {
@@ -71,28 +92,40 @@ public:
     }
 
 private:
+    /// Encode one call and hand the complete message to the transport
+    void Send(std::iostream& stream, Param1& p1, Param2& p2) {
+        Codec::WriteId(stream, m_id);
+        Codec::Write(stream, p1);
+        Codec::Write(stream, p2);
+        m_transport.DispatchDelegate(stream);
+    }
+
     IDelegateTransport & m_transport;   // Object sends data to remote
-    std::iostream& m_stream;            // Storage for remote message 
+    std::iostream* m_stream;            // Storage for remote message, or nullptr to lease one per call
     DelegateIdType m_id = 0;                // Remote delegate identifier
 };
 
-template <class Param1, class Param2, class Param3>
-class DelegateRemoteSend<void(Param1, Param2, Param3)> : public Delegate<void(Param1, Param2, Param3)> {
+template <class Param1, class Param2, class Param3, class Codec>
+class DelegateRemoteSend<void(Param1, Param2, Param3), Codec> : public Delegate<void(Param1, Param2, Param3)> {
 public:
-    using ClassType = DelegateRemoteSend<void(Param1, Param2, Param3)>;
+    using ClassType = DelegateRemoteSend<void(Param1, Param2, Param3), Codec>;
 
     DelegateRemoteSend(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) :
-        m_transport(transport), m_stream(stream), m_id(id) { }
+        m_transport(transport), m_stream(&stream), m_id(id) { }
+
+    /// Encode each call into a buffer leased from the calling thread, so the delegate
+    /// may be invoked from any number of threads at once.
+    DelegateRemoteSend(IDelegateTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_stream(nullptr), m_id(id) { }
 
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Invoke the bound delegate function. 
     virtual void operator()(Param1 p1, Param2 p2, Param3 p3) override {
-        m_stream << m_id << std::ends;
-        m_stream << p1 << std::ends;
-        m_stream << p2 << std::ends;
-        m_stream << p3 << std::ends;
-        m_transport.DispatchDelegate(m_stream);
+        if (m_stream)
+            Send(*m_stream, p1, p2, p3);
+        else
+            Send(DelegateEncodeLease<DelegateEncodeStream>().Get(), p1, p2, p3);
     }
 
     virtual bool operator==(const DelegateBase& rhs) const override {
@@ -103,29 +136,41 @@ public:
     }
 
 private:
+    /// Encode one call and hand the complete message to the transport
+    void Send(std::iostream& stream, Param1& p1, Param2& p2, Param3& p3) {
+        Codec::WriteId(stream, m_id);
+        Codec::Write(stream, p1);
+        Codec::Write(stream, p2);
+        Codec::Write(stream, p3);
+        m_transport.DispatchDelegate(stream);
+    }
+
     IDelegateTransport & m_transport;   // Object sends data to remote
-    std::iostream& m_stream;            // Storage for remote message 
+    std::iostream* m_stream;            // Storage for remote message, or nullptr to lease one per call
     DelegateIdType m_id = 0;                // Remote delegate identifier
 };
 
-template <class Param1, class Param2, class Param3, class Param4>
-class DelegateRemoteSend<void(Param1, Param2, Param3, Param4)> : public Delegate<void(Param1, Param2, Param3, Param4)> {
+template <class Param1, class Param2, class Param3, class Param4, class Codec>
+class DelegateRemoteSend<void(Param1, Param2, Param3, Param4), Codec> : public Delegate<void(Param1, Param2, Param3, Param4)> {
 public:
-    using ClassType = DelegateRemoteSend<void(Param1, Param2, Param3, Param4)>;
+    using ClassType = DelegateRemoteSend<void(Param1, Param2, Param3, Param4), Codec>;
 
     DelegateRemoteSend(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) :
-        m_transport(transport), m_stream(stream), m_id(id) { }
+        m_transport(transport), m_stream(&stream), m_id(id) { }
+
+    /// Encode each call into a buffer leased from the calling thread, so the delegate
+    /// may be invoked from any number of threads at once.
+    DelegateRemoteSend(IDelegateTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_stream(nullptr), m_id(id) { }
 
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Invoke the bound delegate function. 
     virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4) override {
-        m_stream << m_id << std::ends;
-        m_stream << p1 << std::ends;
-        m_stream << p2 << std::ends;
-        m_stream << p3 << std::ends;
-        m_stream << p4 << std::ends;
-        m_transport.DispatchDelegate(m_stream);
+        if (m_stream)
+            Send(*m_stream, p1, p2, p3, p4);
+        else
+            Send(DelegateEncodeLease<DelegateEncodeStream>().Get(), p1, p2, p3, p4);
     }
 
     virtual bool operator==(const DelegateBase& rhs) const override {
@@ -136,30 +181,42 @@ public:
     }
 
 private:
+    /// Encode one call and hand the complete message to the transport
+    void Send(std::iostream& stream, Param1& p1, Param2& p2, Param3& p3, Param4& p4) {
+        Codec::WriteId(stream, m_id);
+        Codec::Write(stream, p1);
+        Codec::Write(stream, p2);
+        Codec::Write(stream, p3);
+        Codec::Write(stream, p4);
+        m_transport.DispatchDelegate(stream);
+    }
+
     IDelegateTransport & m_transport;   // Object sends data to remote
-    std::iostream& m_stream;            // Storage for remote message 
+    std::iostream* m_stream;            // Storage for remote message, or nullptr to lease one per call
     DelegateIdType m_id = 0;                // Remote delegate identifier
 };
 
-template <class Param1, class Param2, class Param3, class Param4, class Param5>
-class DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5)> : public Delegate<void(Param1, Param2, Param3, Param4, Param5)> {
+template <class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+class DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5), Codec> : public Delegate<void(Param1, Param2, Param3, Param4, Param5)> {
 public:
-    using ClassType = DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5)>;
+    using ClassType = DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5), Codec>;
 
     DelegateRemoteSend(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) :
-        m_transport(transport), m_stream(stream), m_id(id) { }
+        m_transport(transport), m_stream(&stream), m_id(id) { }
+
+    /// Encode each call into a buffer leased from the calling thread, so the delegate
+    /// may be invoked from any number of threads at once.
+    DelegateRemoteSend(IDelegateTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_stream(nullptr), m_id(id) { }
 
     virtual ClassType* Clone() const override { return new ClassType(*this); }
 
     /// Invoke the bound delegate function. 
     virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) override {
-        m_stream << m_id << std::ends;
-        m_stream << p1 << std::ends;
-        m_stream << p2 << std::ends;
-        m_stream << p3 << std::ends;
-        m_stream << p4 << std::ends;
-        m_stream << p5 << std::ends;
-        m_transport.DispatchDelegate(m_stream);
+        if (m_stream)
+            Send(*m_stream, p1, p2, p3, p4, p5);
+        else
+            Send(DelegateEncodeLease<DelegateEncodeStream>().Get(), p1, p2, p3, p4, p5);
     }
 
     virtual bool operator==(const DelegateBase& rhs) const override {
@@ -170,8 +227,192 @@ public:
     }
 
 private:
+    /// Encode one call and hand the complete message to the transport
+    void Send(std::iostream& stream, Param1& p1, Param2& p2, Param3& p3, Param4& p4, Param5& p5) {
+        Codec::WriteId(stream, m_id);
+        Codec::Write(stream, p1);
+        Codec::Write(stream, p2);
+        Codec::Write(stream, p3);
+        Codec::Write(stream, p4);
+        Codec::Write(stream, p5);
+        m_transport.DispatchDelegate(stream);
+    }
+
     IDelegateTransport & m_transport;   // Object sends data to remote
-    std::iostream& m_stream;            // Storage for remote message 
+    std::iostream* m_stream;            // Storage for remote message, or nullptr to lease one per call
+    DelegateIdType m_id = 0;                // Remote delegate identifier
+};
+
+// Declare DelegateRemoteSpanSend as a class template. It will be specialized for all number of arguments.
+template <typename Signature, class Codec = DelegateBinaryCodec>
+class DelegateRemoteSpanSend;
+
+/// @brief Send a delegate to invoke a function on a remote system through an 
+/// IDelegateSpanTransport. Small values are encoded into a buffer leased from the
+/// calling thread and large blocks are handed to the transport in place. The 
+/// delegate may be invoked from any number of threads at once. 
+template <class Param1, class Codec>
+class DelegateRemoteSpanSend<void(Param1), Codec> : public Delegate<void(Param1)> {
+public:
+    using ClassType = DelegateRemoteSpanSend<void(Param1), Codec>;
+
+    DelegateRemoteSpanSend(IDelegateSpanTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_id(id) { }
+
+    virtual ClassType* Clone() const override { return new ClassType(*this); }
+
+    /// Invoke the bound delegate function. 
+    virtual void operator()(Param1 p1) override {
+        DelegateEncodeLease<DelegateSpanWriter> lease;
+        DelegateSpanWriter& writer = lease.Get();
+        Codec::WriteId(writer, m_id);
+        Codec::Write(writer, p1);
+        m_transport.DispatchDelegate(writer.GetSpans(), writer.GetSpanCount());
+    }
+
+    virtual bool operator==(const DelegateBase& rhs) const override {
+        auto derivedRhs = dynamic_cast<const ClassType*>(&rhs);
+        return derivedRhs &&
+            m_id == derivedRhs->m_id &&
+            &m_transport == &derivedRhs->m_transport;
+    }
+
+private:
+    IDelegateSpanTransport& m_transport;    // Object sends data to remote
+    DelegateIdType m_id = 0;                // Remote delegate identifier
+};
+
+template <class Param1, class Param2, class Codec>
+class DelegateRemoteSpanSend<void(Param1, Param2), Codec> : public Delegate<void(Param1, Param2)> {
+public:
+    using ClassType = DelegateRemoteSpanSend<void(Param1, Param2), Codec>;
+
+    DelegateRemoteSpanSend(IDelegateSpanTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_id(id) { }
+
+    virtual ClassType* Clone() const override { return new ClassType(*this); }
+
+    /// Invoke the bound delegate function. 
+    virtual void operator()(Param1 p1, Param2 p2) override {
+        DelegateEncodeLease<DelegateSpanWriter> lease;
+        DelegateSpanWriter& writer = lease.Get();
+        Codec::WriteId(writer, m_id);
+        Codec::Write(writer, p1);
+        Codec::Write(writer, p2);
+        m_transport.DispatchDelegate(writer.GetSpans(), writer.GetSpanCount());
+    }
+
+    virtual bool operator==(const DelegateBase& rhs) const override {
+        auto derivedRhs = dynamic_cast<const ClassType*>(&rhs);
+        return derivedRhs &&
+            m_id == derivedRhs->m_id &&
+            &m_transport == &derivedRhs->m_transport;
+    }
+
+private:
+    IDelegateSpanTransport& m_transport;    // Object sends data to remote
+    DelegateIdType m_id = 0;                // Remote delegate identifier
+};
+
+template <class Param1, class Param2, class Param3, class Codec>
+class DelegateRemoteSpanSend<void(Param1, Param2, Param3), Codec> : public Delegate<void(Param1, Param2, Param3)> {
+public:
+    using ClassType = DelegateRemoteSpanSend<void(Param1, Param2, Param3), Codec>;
+
+    DelegateRemoteSpanSend(IDelegateSpanTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_id(id) { }
+
+    virtual ClassType* Clone() const override { return new ClassType(*this); }
+
+    /// Invoke the bound delegate function. 
+    virtual void operator()(Param1 p1, Param2 p2, Param3 p3) override {
+        DelegateEncodeLease<DelegateSpanWriter> lease;
+        DelegateSpanWriter& writer = lease.Get();
+        Codec::WriteId(writer, m_id);
+        Codec::Write(writer, p1);
+        Codec::Write(writer, p2);
+        Codec::Write(writer, p3);
+        m_transport.DispatchDelegate(writer.GetSpans(), writer.GetSpanCount());
+    }
+
+    virtual bool operator==(const DelegateBase& rhs) const override {
+        auto derivedRhs = dynamic_cast<const ClassType*>(&rhs);
+        return derivedRhs &&
+            m_id == derivedRhs->m_id &&
+            &m_transport == &derivedRhs->m_transport;
+    }
+
+private:
+    IDelegateSpanTransport& m_transport;    // Object sends data to remote
+    DelegateIdType m_id = 0;                // Remote delegate identifier
+};
+
+template <class Param1, class Param2, class Param3, class Param4, class Codec>
+class DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4), Codec> : public Delegate<void(Param1, Param2, Param3, Param4)> {
+public:
+    using ClassType = DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4), Codec>;
+
+    DelegateRemoteSpanSend(IDelegateSpanTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_id(id) { }
+
+    virtual ClassType* Clone() const override { return new ClassType(*this); }
+
+    /// Invoke the bound delegate function. 
+    virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4) override {
+        DelegateEncodeLease<DelegateSpanWriter> lease;
+        DelegateSpanWriter& writer = lease.Get();
+        Codec::WriteId(writer, m_id);
+        Codec::Write(writer, p1);
+        Codec::Write(writer, p2);
+        Codec::Write(writer, p3);
+        Codec::Write(writer, p4);
+        m_transport.DispatchDelegate(writer.GetSpans(), writer.GetSpanCount());
+    }
+
+    virtual bool operator==(const DelegateBase& rhs) const override {
+        auto derivedRhs = dynamic_cast<const ClassType*>(&rhs);
+        return derivedRhs &&
+            m_id == derivedRhs->m_id &&
+            &m_transport == &derivedRhs->m_transport;
+    }
+
+private:
+    IDelegateSpanTransport& m_transport;    // Object sends data to remote
+    DelegateIdType m_id = 0;                // Remote delegate identifier
+};
+
+template <class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+class DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4, Param5), Codec> : public Delegate<void(Param1, Param2, Param3, Param4, Param5)> {
+public:
+    using ClassType = DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4, Param5), Codec>;
+
+    DelegateRemoteSpanSend(IDelegateSpanTransport& transport, DelegateIdType id) :
+        m_transport(transport), m_id(id) { }
+
+    virtual ClassType* Clone() const override { return new ClassType(*this); }
+
+    /// Invoke the bound delegate function. 
+    virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) override {
+        DelegateEncodeLease<DelegateSpanWriter> lease;
+        DelegateSpanWriter& writer = lease.Get();
+        Codec::WriteId(writer, m_id);
+        Codec::Write(writer, p1);
+        Codec::Write(writer, p2);
+        Codec::Write(writer, p3);
+        Codec::Write(writer, p4);
+        Codec::Write(writer, p5);
+        m_transport.DispatchDelegate(writer.GetSpans(), writer.GetSpanCount());
+    }
+
+    virtual bool operator==(const DelegateBase& rhs) const override {
+        auto derivedRhs = dynamic_cast<const ClassType*>(&rhs);
+        return derivedRhs &&
+            m_id == derivedRhs->m_id &&
+            &m_transport == &derivedRhs->m_transport;
+    }
+
+private:
+    IDelegateSpanTransport& m_transport;    // Object sends data to remote
     DelegateIdType m_id = 0;                // Remote delegate identifier
 };
 
@@ -181,30 +422,135 @@ DelegateRemoteSend<void(Param1)> MakeDelegate(IDelegateTransport& transport, std
     return DelegateRemoteSend<void(Param1)>(transport, stream, id);
 }
 
+template <class Param1, class Codec>
+DelegateRemoteSend<void(Param1), Codec> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1), Codec>(transport, stream, id);
+}
+
+template <class Param1>
+DelegateRemoteSend<void(Param1)> MakeDelegate(IDelegateTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSend<void(Param1)>(transport, id);
+}
+
+template <class Param1, class Codec>
+DelegateRemoteSend<void(Param1), Codec> MakeDelegate(IDelegateTransport& transport, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1), Codec>(transport, id);
+}
+
 //N=2
 template <class Param1, class Param2>
 DelegateRemoteSend<void(Param1, Param2)> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) {
     return DelegateRemoteSend<void(Param1, Param2)>(transport, stream, id);
 }
 
+template <class Param1, class Param2, class Codec>
+DelegateRemoteSend<void(Param1, Param2), Codec> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2), Codec>(transport, stream, id);
+}
+
+template <class Param1, class Param2>
+DelegateRemoteSend<void(Param1, Param2)> MakeDelegate(IDelegateTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSend<void(Param1, Param2)>(transport, id);
+}
+
+template <class Param1, class Param2, class Codec>
+DelegateRemoteSend<void(Param1, Param2), Codec> MakeDelegate(IDelegateTransport& transport, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2), Codec>(transport, id);
+}
+
 //N=3
 template <class Param1, class Param2, class Param3>
 DelegateRemoteSend<void(Param1, Param2, Param3)> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) {
     return DelegateRemoteSend<void(Param1, Param2, Param3)>(transport, stream, id);
 }
 
+template <class Param1, class Param2, class Param3, class Codec>
+DelegateRemoteSend<void(Param1, Param2, Param3), Codec> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3), Codec>(transport, stream, id);
+}
+
+template <class Param1, class Param2, class Param3>
+DelegateRemoteSend<void(Param1, Param2, Param3)> MakeDelegate(IDelegateTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3)>(transport, id);
+}
+
+template <class Param1, class Param2, class Param3, class Codec>
+DelegateRemoteSend<void(Param1, Param2, Param3), Codec> MakeDelegate(IDelegateTransport& transport, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3), Codec>(transport, id);
+}
+
 //N=4
 template <class Param1, class Param2, class Param3, class Param4>
 DelegateRemoteSend<void(Param1, Param2, Param3, Param4)> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) {
     return DelegateRemoteSend<void(Param1, Param2, Param3, Param4)>(transport, stream, id);
 }
 
+template <class Param1, class Param2, class Param3, class Param4, class Codec>
+DelegateRemoteSend<void(Param1, Param2, Param3, Param4), Codec> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3, Param4), Codec>(transport, stream, id);
+}
+
+template <class Param1, class Param2, class Param3, class Param4>
+DelegateRemoteSend<void(Param1, Param2, Param3, Param4)> MakeDelegate(IDelegateTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3, Param4)>(transport, id);
+}
+
+template <class Param1, class Param2, class Param3, class Param4, class Codec>
+DelegateRemoteSend<void(Param1, Param2, Param3, Param4), Codec> MakeDelegate(IDelegateTransport& transport, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3, Param4), Codec>(transport, id);
+}
+
 //N=5
 template <class Param1, class Param2, class Param3, class Param4, class Param5>
 DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5)> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id) {
     return DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5)>(transport, stream, id);
 }
 
+template <class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5), Codec> MakeDelegate(IDelegateTransport& transport, std::iostream& stream, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5), Codec>(transport, stream, id);
+}
+
+template <class Param1, class Param2, class Param3, class Param4, class Param5>
+DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5)> MakeDelegate(IDelegateTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5)>(transport, id);
+}
+
+template <class Param1, class Param2, class Param3, class Param4, class Param5, class Codec>
+DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5), Codec> MakeDelegate(IDelegateTransport& transport, DelegateIdType id, Codec) {
+    return DelegateRemoteSend<void(Param1, Param2, Param3, Param4, Param5), Codec>(transport, id);
+}
+
+//N=1
+template <class Param1>
+DelegateRemoteSpanSend<void(Param1)> MakeDelegate(IDelegateSpanTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSpanSend<void(Param1)>(transport, id);
+}
+
+//N=2
+template <class Param1, class Param2>
+DelegateRemoteSpanSend<void(Param1, Param2)> MakeDelegate(IDelegateSpanTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSpanSend<void(Param1, Param2)>(transport, id);
+}
+
+//N=3
+template <class Param1, class Param2, class Param3>
+DelegateRemoteSpanSend<void(Param1, Param2, Param3)> MakeDelegate(IDelegateSpanTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSpanSend<void(Param1, Param2, Param3)>(transport, id);
+}
+
+//N=4
+template <class Param1, class Param2, class Param3, class Param4>
+DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4)> MakeDelegate(IDelegateSpanTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4)>(transport, id);
+}
+
+//N=5
+template <class Param1, class Param2, class Param3, class Param4, class Param5>
+DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4, Param5)> MakeDelegate(IDelegateSpanTransport& transport, DelegateIdType id) {
+    return DelegateRemoteSpanSend<void(Param1, Param2, Param3, Param4, Param5)>(transport, id);
+}
+
 }
 
 #endif
@@ -62,6 +62,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty();  }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   	// Pointer to an instance member function
@@ -111,6 +114,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty();  }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   	// Pointer to an instance member function
@@ -160,6 +166,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty();  }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   	// Pointer to an instance member function
@@ -209,6 +218,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty();  }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   	// Pointer to an instance member function
@@ -258,6 +270,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty();  }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   	// Pointer to an instance member function
@@ -307,6 +322,9 @@ public:
 	void Clear() { m_object = 0; m_func = 0; }
 	explicit operator bool() const { return !Empty();  }
 
+	/// Get the bound function. Identifies the delegate target.
+	MemberFunc GetFunc() const { return m_func; }
+
 private:
 	ObjectPtr m_object = nullptr;		// Pointer to a class object
 	MemberFunc m_func = nullptr;   	// Pointer to an instance member function
@@ -11,6 +11,8 @@
 #include "DelegateSp.h"
 #include "IDelegateThread.h"
 #include "DelegateInvoker.h"
+#include "DelegateConnection.h"
+#include "DelegateLatency.h"
 
 namespace DelegateLib {
 
@@ -20,7 +22,7 @@ class DelegateMemberSpAsync;
 
 /// @brief Asynchronous member delegate that invokes the target function on the specified thread of control.
 template <class TClass> 
-class DelegateMemberSpAsync<void(TClass(void))> : public DelegateMemberSp<void(TClass(void))>, public IDelegateInvoker {
+class DelegateMemberSpAsync<void(TClass(void))> : public DelegateMemberSp<void(TClass(void))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef std::shared_ptr<TClass> ObjectPtr;
 	typedef void (TClass::*MemberFunc)();
@@ -53,21 +55,40 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()() override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()();
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsgBase>(delegate);
+		auto msg = MakeShared<DelegateMsgBase>(delegate);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
+
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
 	}
 
 	/// Called by the target thread to invoke the delegate function 
 	virtual void DelegateInvoke(std::shared_ptr<DelegateMsgBase> msg) override {
 		// Invoke the delegate function
 		BaseType::operator()();
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
 	}
 
 private:
@@ -76,7 +97,7 @@ private:
 };
 
 template <class TClass, class Param1> 
-class DelegateMemberSpAsync<void(TClass(Param1))> : public DelegateMemberSp<void(TClass(Param1))>, public IDelegateInvoker {
+class DelegateMemberSpAsync<void(TClass(Param1))> : public DelegateMemberSp<void(TClass(Param1))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef std::shared_ptr<TClass> ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1);
@@ -109,19 +130,35 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg1<Param1>>(delegate, heapParam1);
+		auto msg = MakeShared<DelegateMsg1<Param1>>(delegate, heapParam1);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value == true || std::is_pointer<Param1>::value == true))),
 			"std::shared_ptr reference argument not allowed");
@@ -141,6 +178,18 @@ public:
 
 		// Delete heap data created inside operator()
 		DelegateParam<Param1>::Delete(param1);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg1<Param1>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
 	}
 
 private:
@@ -149,7 +198,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2> 
-class DelegateMemberSpAsync<void(TClass(Param1, Param2))> : public DelegateMemberSp<void(TClass(Param1, Param2))>, public IDelegateInvoker {
+class DelegateMemberSpAsync<void(TClass(Param1, Param2))> : public DelegateMemberSp<void(TClass(Param1, Param2))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef std::shared_ptr<TClass> ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2);
@@ -182,20 +231,36 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg2<Param1, Param2>>(delegate, heapParam1, heapParam2);
+		auto msg = MakeShared<DelegateMsg2<Param1, Param2>>(delegate, heapParam1, heapParam2);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value))),
@@ -218,6 +283,19 @@ public:
 		// Delete heap data created inside operator()
 		DelegateParam<Param1>::Delete(param1);
 		DelegateParam<Param2>::Delete(param2);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg2<Param1, Param2>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
 	}
 
 private:
@@ -226,7 +304,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2, class Param3> 
-class DelegateMemberSpAsync<void(TClass(Param1, Param2, Param3))> : public DelegateMemberSp<void(TClass(Param1, Param2, Param3))>, public IDelegateInvoker {
+class DelegateMemberSpAsync<void(TClass(Param1, Param2, Param3))> : public DelegateMemberSp<void(TClass(Param1, Param2, Param3))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef std::shared_ptr<TClass> ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2, Param3);
@@ -259,21 +337,37 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
 		Param3 heapParam3 = DelegateParam<Param3>::New(p3);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg3<Param1, Param2, Param3>>(delegate, heapParam1, heapParam2, heapParam3);
+		auto msg = MakeShared<DelegateMsg3<Param1, Param2, Param3>>(delegate, heapParam1, heapParam2, heapParam3);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -299,6 +393,20 @@ public:
 		DelegateParam<Param1>::Delete(param1);
 		DelegateParam<Param2>::Delete(param2);
 		DelegateParam<Param3>::Delete(param3);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg3<Param1, Param2, Param3>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
 	}
 
 private:
@@ -307,7 +415,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2, class Param3, class Param4> 
-class DelegateMemberSpAsync<void(TClass(Param1, Param2, Param3, Param4))> : public DelegateMemberSp<void (TClass(Param1, Param2, Param3, Param4))>, public IDelegateInvoker {
+class DelegateMemberSpAsync<void(TClass(Param1, Param2, Param3, Param4))> : public DelegateMemberSp<void (TClass(Param1, Param2, Param3, Param4))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef std::shared_ptr<TClass> ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2, Param3, Param4);
@@ -340,6 +448,15 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3, p4);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
@@ -347,15 +464,22 @@ public:
 		Param4 heapParam4 = DelegateParam<Param4>::New(p4);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4);
+		auto msg = MakeShared<DelegateMsg4<Param1, Param2, Param3, Param4>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -384,6 +508,21 @@ public:
 		DelegateParam<Param2>::Delete(param2);
 		DelegateParam<Param3>::Delete(param3);
 		DelegateParam<Param4>::Delete(param4);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg4<Param1, Param2, Param3, Param4>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
+		DelegateParam<Param4>::Delete(delegateMsg->GetParam4());
 	}
 
 private:
@@ -392,7 +531,7 @@ private:
 };
 
 template <class TClass, class Param1, class Param2, class Param3, class Param4, class Param5> 
-class DelegateMemberSpAsync<void(TClass(Param1, Param2, Param3, Param4, Param5))> : public DelegateMemberSp<void(TClass(Param1, Param2, Param3, Param4, Param5))>, public IDelegateInvoker {
+class DelegateMemberSpAsync<void(TClass(Param1, Param2, Param3, Param4, Param5))> : public DelegateMemberSp<void(TClass(Param1, Param2, Param3, Param4, Param5))>, public IDelegateInvoker, public DelegateConnectionPolicy {
 public:
 	typedef std::shared_ptr<TClass> ObjectPtr;
 	typedef void (TClass::*MemberFunc)(Param1, Param2, Param3, Param4, Param5);
@@ -425,6 +564,15 @@ public:
 
 	/// Invoke delegate function asynchronously
 	virtual void operator()(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) override {
+		// Invoke on the caller's thread if the connection policy allows
+		if (IsDirect(m_thread)) {
+			BaseType::operator()(p1, p2, p3, p4, p5);
+			return;
+		}
+
+		// Time the call before copying arguments when measuring DelegateLatency
+		auto callTime = DelegateLatency::Now();
+
 		// Create a new instance of the function argument data and copy
 		Param1 heapParam1 = DelegateParam<Param1>::New(p1);
 		Param2 heapParam2 = DelegateParam<Param2>::New(p2);
@@ -433,15 +581,22 @@ public:
 		Param5 heapParam5 = DelegateParam<Param5>::New(p5);
 
 		// Create a clone instance of this delegate 
-		auto delegate = std::shared_ptr<ClassType>(Clone());
+		auto delegate = MakeSharedClone(Clone());
+		auto complete = BindCompletion(*delegate);
 
 		// Create a new message instance 
-		auto msg = std::make_shared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4, heapParam5);
+		auto msg = MakeShared<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(delegate, heapParam1, heapParam2, heapParam3, heapParam4, heapParam5);
+		msg->SetOrigin(DelegateTarget(BaseType::GetFunc()), callTime);
 
 		// Dispatch message onto the callback destination thread. DelegateInvoke()
 		// will be called by the target thread. 
 		m_thread.DispatchDelegate(msg);
 
+		// Block until invoked or discarded if using DelegateConnection::BLOCKING_QUEUED
+		msg.reset();
+		delegate.reset();
+		WaitCompletion(complete);
+
 		static_assert(!(
 			(is_shared_ptr<Param1>::value && (std::is_lvalue_reference<Param1>::value || std::is_pointer<Param1>::value)) ||
 			(is_shared_ptr<Param2>::value && (std::is_lvalue_reference<Param2>::value || std::is_pointer<Param2>::value)) ||
@@ -473,6 +628,22 @@ public:
 		DelegateParam<Param3>::Delete(param3);
 		DelegateParam<Param4>::Delete(param4);
 		DelegateParam<Param5>::Delete(param5);
+
+		// Release a caller blocked in operator()
+		SignalCompletion();
+	}
+
+	/// Called by the target thread when the message is discarded without being invoked
+	virtual void DelegateDiscard(std::shared_ptr<DelegateMsgBase> msg) override {
+		auto delegateMsg = std::dynamic_pointer_cast<DelegateMsg5<Param1, Param2, Param3, Param4, Param5>>(msg);
+		ASSERT_TRUE(delegateMsg != nullptr);
+
+		// Delete heap data created inside operator()
+		DelegateParam<Param1>::Delete(delegateMsg->GetParam1());
+		DelegateParam<Param2>::Delete(delegateMsg->GetParam2());
+		DelegateParam<Param3>::Delete(delegateMsg->GetParam3());
+		DelegateParam<Param4>::Delete(delegateMsg->GetParam4());
+		DelegateParam<Param5>::Delete(delegateMsg->GetParam5());
 	}
 
 private:
@@ -0,0 +1,100 @@
+#include "DelegateSpan.h"
+
+namespace DelegateLib
+{
+    DelegateSpanWriter::DelegateSpanWriter(size_t referenceSize) :
+        m_referenceSize(referenceSize)
+    {
+    }
+
+    void DelegateSpanWriter::write(const char* data, size_t size)
+    {
+        if (size == 0)
+            return;
+        if (m_entries.empty() || m_entries.back().external)
+            m_entries.push_back(Entry{ nullptr, m_buffer.size(), 0 });
+        m_buffer.insert(m_buffer.end(), data, data + size);
+        m_entries.back().size += size;
+        m_size += size;
+    }
+
+    void DelegateSpanWriter::WriteBlock(const void* data, size_t size)
+    {
+        if (size < m_referenceSize)
+        {
+            write(static_cast<const char*>(data), size);
+            return;
+        }
+        m_entries.push_back(Entry{ static_cast<const char*>(data), 0, size });
+        m_size += size;
+    }
+
+    void DelegateSpanWriter::Clear()
+    {
+        m_buffer.clear();
+        m_entries.clear();
+        m_size = 0;
+    }
+
+    const DelegateSpan* DelegateSpanWriter::GetSpans()
+    {
+        m_spans.resize(m_entries.size());
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            const Entry& entry = m_entries[i];
+            m_spans[i].data = entry.external ? entry.external : m_buffer.data() + entry.offset;
+            m_spans[i].size = entry.size;
+        }
+        return m_spans.data();
+    }
+
+    DelegateSpanReader::DelegateSpanReader(const void* data, size_t size) :
+        std::istream(nullptr),
+        m_buffer(data, size)
+    {
+        rdbuf(&m_buffer);
+    }
+
+    const char* DelegateSpanReader::Take(size_t size)
+    {
+        const char* data = m_buffer.Take(size);
+        if (!data)
+            setstate(std::ios_base::failbit);
+        return data;
+    }
+
+    DelegateSpanReader::Buffer::Buffer(const void* data, size_t size)
+    {
+        // The get area is never written through
+        char* begin = const_cast<char*>(static_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+
+    const char* DelegateSpanReader::Buffer::Take(size_t size)
+    {
+        if ((size_t)(egptr() - gptr()) < size)
+            return nullptr;
+        const char* data = gptr();
+        setg(eback(), gptr() + size, egptr());
+        return data;
+    }
+
+    std::streambuf::pos_type DelegateSpanReader::Buffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+    {
+        off_type base = 0;
+        if (dir == std::ios_base::cur)
+            base = gptr() - eback();
+        else if (dir == std::ios_base::end)
+            base = egptr() - eback();
+        return seekpos(pos_type(base + off), which);
+    }
+
+    std::streambuf::pos_type DelegateSpanReader::Buffer::seekpos(pos_type pos, std::ios_base::openmode which)
+    {
+        off_type offset = pos;
+        if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+            return pos_type(off_type(-1));
+        setg(eback(), eback() + offset, egptr());
+        return pos;
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef _DELEGATE_SPAN_H
+#define _DELEGATE_SPAN_H
+
+// DelegateSpan.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include <stddef.h>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+namespace DelegateLib {
+
+/// @brief A run of bytes in memory. Has the layout of a POSIX struct iovec, so a
+/// transport may pass an array of spans straight to writev() or sendmsg().
+struct DelegateSpan
+{
+	const void* data;
+	size_t size;
+};
+
+/// @brief A remote delegate argument that views bytes owned by someone else. The
+/// binary codec sends the bytes in place and the receiver gets a view of the
+/// receive buffer, so the payload is never copied. On the remote system the view
+/// is only valid until the receiving delegate function returns.
+struct DelegateBytes
+{
+	DelegateBytes() : data(nullptr), size(0) {}
+	DelegateBytes(const void* d, size_t s) : data(d), size(s) {}
+
+	const void* data;
+	size_t size;
+};
+
+/// @brief Encodes a remote delegate message into a list of DelegateSpans for an
+/// IDelegateSpanTransport. Small values are copied into an internal buffer. A
+/// block of at least the reference size, such as a large string, vector or
+/// DelegateBytes argument, is referenced in place instead. The buffer is reused,
+/// so a writer stops allocating once it has held its largest message.
+class DelegateSpanWriter
+{
+public:
+	enum { DEFAULT_REFERENCE_SIZE = 256 };
+
+	/// Constructor
+	/// @param[in] referenceSize - blocks of this many bytes or more are not copied.
+	explicit DelegateSpanWriter(size_t referenceSize = DEFAULT_REFERENCE_SIZE);
+
+	/// Copy one byte into the message
+	void put(char c)
+	{
+		if (m_entries.empty() || m_entries.back().external)
+			m_entries.push_back(Entry{ nullptr, m_buffer.size(), 0 });
+		m_buffer.push_back(c);
+		m_entries.back().size++;
+		m_size++;
+	}
+
+	/// Copy bytes into the message
+	void write(const char* data, size_t size);
+
+	/// Add bytes to the message, referencing them in place if the block is large.
+	/// A referenced block must stay unchanged until the message is dispatched.
+	void WriteBlock(const void* data, size_t size);
+
+	/// Discard the message, keeping the buffer for the next one
+	void Clear();
+
+	/// Get the message spans, valid until the writer is next changed
+	const DelegateSpan* GetSpans();
+
+	/// Get the number of spans returned by GetSpans()
+	size_t GetSpanCount() const { return m_entries.size(); }
+
+	/// Get the message size in bytes
+	size_t GetSize() const { return m_size; }
+
+private:
+	/// A span in the internal buffer, held as an offset since the buffer may move
+	struct Entry
+	{
+		const char* external;		// Referenced block, or nullptr if in m_buffer
+		size_t offset;
+		size_t size;
+	};
+
+	size_t m_referenceSize;
+	size_t m_size = 0;
+	std::vector<char> m_buffer;
+	std::vector<Entry> m_entries;
+	std::vector<DelegateSpan> m_spans;
+};
+
+/// @brief An input stream over a received message held in contiguous memory.
+/// Values are decoded straight from the buffer, and DelegateBytes arguments view
+/// it in place. See DelegateRemoteInvoker::Invoke(const void*, size_t).
+class DelegateSpanReader : public std::istream
+{
+public:
+	/// Constructor. The buffer must outlive the reader.
+	DelegateSpanReader(const void* data, size_t size);
+
+	/// Get the next bytes and skip past them.
+	/// @param[in] size - the number of bytes.
+	/// @return The bytes in the buffer, or nullptr with failbit set if fewer remain.
+	const char* Take(size_t size);
+
+private:
+	class Buffer : public std::streambuf
+	{
+	public:
+		Buffer(const void* data, size_t size);
+		const char* Take(size_t size);
+
+	protected:
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+	};
+
+	Buffer m_buffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _DELEGATE_TARGET_H
+#define _DELEGATE_TARGET_H
+
+// DelegateTarget.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include <cstring>
+#include <cstddef>
+#include <string>
+#include <typeinfo>
+
+namespace DelegateLib {
+
+/// @brief Identifies the function a delegate invokes, independent of the object
+/// instance or target thread. Two delegates bound to the same free or member
+/// function have equal targets. Used as a key by the diagnostics features.
+class DelegateTarget
+{
+public:
+	DelegateTarget() : m_size(0), m_type(nullptr) {
+		memset(m_bytes, 0, sizeof(m_bytes));
+	}
+
+	/// Constructor
+	/// @param[in] func - a free function or member function pointer.
+	template <class Func>
+	explicit DelegateTarget(Func func) : m_size(sizeof(Func)), m_type(&typeid(Func)) {
+		static_assert(sizeof(Func) <= MAX_SIZE, "Function pointer too large");
+		memset(m_bytes, 0, sizeof(m_bytes));
+		memcpy(m_bytes, &func, sizeof(Func));
+	}
+
+	/// Returns true if no function is identified.
+	bool Empty() const { return m_size == 0; }
+
+	bool operator==(const DelegateTarget& rhs) const {
+		return m_size == rhs.m_size && memcmp(m_bytes, rhs.m_bytes, sizeof(m_bytes)) == 0;
+	}
+	bool operator!=(const DelegateTarget& rhs) const { return !(*this == rhs); }
+
+	/// Strict ordering so the target can key a std::map.
+	bool operator<(const DelegateTarget& rhs) const {
+		if (m_size != rhs.m_size)
+			return m_size < rhs.m_size;
+		return memcmp(m_bytes, rhs.m_bytes, sizeof(m_bytes)) < 0;
+	}
+
+	/// Get a hash of the function pointer for use with unordered containers.
+	size_t Hash() const {
+		// FNV-1a
+		size_t hash = (size_t)14695981039346656037ULL;
+		for (size_t i = 0; i < m_size; i++)
+			hash = (hash ^ m_bytes[i]) * (size_t)1099511628211ULL;
+		return hash;
+	}
+
+	/// Get a printable description, the function pointer type and address.
+	std::string ToString() const {
+		if (Empty())
+			return "<none>";
+
+		static const char HEX[] = "0123456789abcdef";
+		std::string str = m_type->name();
+		str += "@0x";
+
+		// The function address is the leading pointer sized bytes, most significant first
+		size_t addrSize = m_size < sizeof(void*) ? m_size : sizeof(void*);
+		void* addr = nullptr;
+		memcpy(&addr, m_bytes, addrSize);
+		size_t value = (size_t)addr;
+		for (int shift = (int)(sizeof(size_t) * 8) - 4; shift >= 0; shift -= 4)
+			str += HEX[(value >> shift) & 0xF];
+		return str;
+	}
+
+	/// Functor so DelegateTarget can key a std::unordered_map.
+	struct Hasher {
+		size_t operator()(const DelegateTarget& target) const { return target.Hash(); }
+	};
+
+private:
+	enum { MAX_SIZE = 3 * sizeof(void*) };
+
+	unsigned char m_bytes[MAX_SIZE];	// Raw function pointer bytes, zero padded
+	size_t m_size;						// sizeof the function pointer type
+	const std::type_info* m_type;		// Function pointer type
+};
+
+}
+
+#endif
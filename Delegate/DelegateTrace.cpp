@@ -0,0 +1,333 @@
+#include "DelegateTrace.h"
+#include "Fault.h"
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <cstdio>
+
+using namespace std::chrono;
+
+namespace DelegateLib
+{
+    struct DelegateTrace::Event
+    {
+        long long timeNs;               // steady_clock time
+        unsigned long long id;          // Flow ID or timer instance
+        DelegateTarget target;
+        EventType type;
+    };
+
+    enum { TARGET_WORDS = (sizeof(DelegateTarget) + sizeof(size_t) - 1) / sizeof(size_t) };
+
+    /// An event stored as atomic words so WriteChromeTrace() never sees a data race
+    struct DelegateTrace::EventSlot
+    {
+        EventSlot() : seq(0) {}
+        std::atomic<unsigned long long> seq;    // Odd while being written
+        std::atomic<unsigned long long> index;  // Event number held by the slot
+        std::atomic<long long> timeNs;
+        std::atomic<unsigned long long> id;
+        std::atomic<size_t> target[TARGET_WORDS];
+        std::atomic<int> type;
+    };
+
+    struct DelegateTrace::ThreadBuffer
+    {
+        std::string name;
+        unsigned int tid;
+        std::unique_ptr<EventSlot[]> events;
+        size_t size;
+        std::atomic<unsigned long long> head;   // Total events written. Owner thread only writes.
+        std::atomic<unsigned long long> tail;   // Events before tail are cleared. Clear() only writes.
+        bool exited;                            // Owner thread exited so the buffer can be reused
+    };
+
+    // Returns the thread's buffer for reuse when the thread exits
+    struct DelegateTrace::ThreadBufferRelease
+    {
+        ~ThreadBufferRelease() { ReleaseThreadBuffer(); }
+    };
+
+    static std::atomic<size_t> _bufferSize(16384);
+    static thread_local std::string _threadName;
+    static thread_local bool _threadBufferReleased = false;
+
+    thread_local DelegateTrace::ThreadBuffer* DelegateTrace::m_threadBuffer = nullptr;
+    thread_local DelegateTrace::ThreadBufferRelease DelegateTrace::m_threadBufferRelease;
+
+    // The buffer list is never destroyed so threads exiting during static
+    // destruction can still record
+    std::vector<DelegateTrace::ThreadBuffer*>& DelegateTrace::GetBuffers()
+    {
+        static auto buffers = new std::vector<ThreadBuffer*>();
+        return *buffers;
+    }
+
+    std::mutex& DelegateTrace::GetBuffersLock()
+    {
+        static auto lock = new std::mutex();
+        return *lock;
+    }
+
+    static void WriteString(std::ostream& os, const std::string& str)
+    {
+        os << '"';
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+                os << '\\' << c;
+            else if ((unsigned char)c < 0x20)
+            {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+                os << esc;
+            }
+            else
+                os << c;
+        }
+        os << '"';
+    }
+
+    std::atomic<bool>& DelegateTrace::GetEnabled()
+    {
+        static std::atomic<bool> enabled(false);
+        return enabled;
+    }
+
+    std::atomic<unsigned long long>& DelegateTrace::GetNextFlowId()
+    {
+        static std::atomic<unsigned long long> nextFlowId(1);
+        return nextFlowId;
+    }
+
+    void DelegateTrace::SetEnabled(bool enabled)
+    {
+        GetEnabled().store(enabled, std::memory_order_relaxed);
+    }
+
+    void DelegateTrace::SetBufferSize(size_t events)
+    {
+        ASSERT_TRUE(events > 0);
+        _bufferSize = events;
+    }
+
+    void DelegateTrace::SetThreadName(const std::string& name)
+    {
+        _threadName = name;
+
+        // Rename the buffer if this thread already recorded events
+        if (m_threadBuffer)
+        {
+            std::lock_guard<std::mutex> lk(GetBuffersLock());
+            m_threadBuffer->name = name;
+        }
+    }
+
+    DelegateTrace::ThreadBuffer* DelegateTrace::GetThreadBuffer()
+    {
+        if (m_threadBuffer || _threadBufferReleased)
+            return m_threadBuffer;
+
+        // Construct the thread exit hook
+        (void)&m_threadBufferRelease;
+
+        std::lock_guard<std::mutex> lk(GetBuffersLock());
+
+        // First event on this thread so take the ring buffer of an exited 
+        // thread, or create one if none
+        ThreadBuffer* buffer = nullptr;
+        for (auto exitedBuffer : GetBuffers())
+        {
+            if (exitedBuffer->exited)
+            {
+                buffer = exitedBuffer;
+                break;
+            }
+        }
+        if (!buffer)
+        {
+            buffer = new ThreadBuffer();
+            buffer->size = 0;
+            buffer->tid = (unsigned int)GetBuffers().size() + 1;
+            GetBuffers().push_back(buffer);
+        }
+
+        if (buffer->size != _bufferSize)
+        {
+            buffer->size = _bufferSize;
+            buffer->events.reset(new EventSlot[buffer->size]);
+        }
+        buffer->head = 0;
+        buffer->tail = 0;
+        buffer->exited = false;
+        buffer->name = _threadName.empty() ? "Thread " + std::to_string(buffer->tid) : _threadName;
+        m_threadBuffer = buffer;
+        return buffer;
+    }
+
+    void DelegateTrace::ReleaseThreadBuffer()
+    {
+        // Events recorded later during thread exit are dropped
+        _threadBufferReleased = true;
+        if (!m_threadBuffer)
+            return;
+
+        // Keep the events so they are written until another thread reuses the buffer
+        std::lock_guard<std::mutex> lk(GetBuffersLock());
+        m_threadBuffer->exited = true;
+        m_threadBuffer = nullptr;
+    }
+
+    void DelegateTrace::Record(EventType type, const DelegateTarget& target, unsigned long long id)
+    {
+        ThreadBuffer* buffer = GetThreadBuffer();
+        if (!buffer)
+            return;
+
+        Event event;
+        event.timeNs = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        event.id = id;
+        event.target = target;
+        event.type = type;
+
+        // Only this thread writes head so a plain load and store suffice
+        unsigned long long head = buffer->head.load(std::memory_order_relaxed);
+        WriteSlot(buffer->events[head % buffer->size], head, event);
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    void DelegateTrace::WriteSlot(EventSlot& slot, unsigned long long index, const Event& event)
+    {
+        size_t words[TARGET_WORDS] = {};
+        memcpy(words, &event.target, sizeof(event.target));
+
+        // Seqlock write: mark the slot odd, fill it, then publish the even sequence
+        unsigned long long seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.index.store(index, std::memory_order_relaxed);
+        slot.timeNs.store(event.timeNs, std::memory_order_relaxed);
+        slot.id.store(event.id, std::memory_order_relaxed);
+        for (size_t w = 0; w < TARGET_WORDS; w++)
+            slot.target[w].store(words[w], std::memory_order_relaxed);
+        slot.type.store(event.type, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    bool DelegateTrace::ReadSlot(const EventSlot& slot, unsigned long long index, Event& event)
+    {
+        unsigned long long seq = slot.seq.load(std::memory_order_acquire);
+        if (seq == 0 || (seq & 1))
+            return false;
+
+        unsigned long long slotIndex = slot.index.load(std::memory_order_relaxed);
+        long long timeNs = slot.timeNs.load(std::memory_order_relaxed);
+        unsigned long long id = slot.id.load(std::memory_order_relaxed);
+        size_t words[TARGET_WORDS];
+        for (size_t w = 0; w < TARGET_WORDS; w++)
+            words[w] = slot.target[w].load(std::memory_order_relaxed);
+        int type = slot.type.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq || slotIndex != index)
+            return false;
+
+        event.timeNs = timeNs;
+        event.id = id;
+        memcpy(&event.target, words, sizeof(event.target));
+        event.type = static_cast<EventType>(type);
+        return true;
+    }
+
+    void DelegateTrace::WriteEvent(std::ostream& os, const ThreadBuffer& buffer, const Event& event)
+    {
+        char ts[32];
+        snprintf(ts, sizeof(ts), "%lld.%03lld", event.timeNs / 1000, event.timeNs % 1000);
+
+        std::string name = event.target.ToString();
+        const char* phase = "i";
+        switch (event.type)
+        {
+            case ENQUEUE: phase = "X"; name = "Enqueue " + name; break;
+            case DEQUEUE: phase = "i"; name = "Dequeue " + name; break;
+            case EXECUTE_BEGIN: phase = "B"; break;
+            case EXECUTE_END: phase = "E"; break;
+            case WAIT_BEGIN: phase = "B"; name = "AsyncWait " + name; break;
+            case WAIT_END: phase = "E"; name = "AsyncWait " + name; break;
+            case TIMER_EXPIRED: phase = "i"; name = "Timer expired"; break;
+        }
+
+        os << ",\n{\"name\":";
+        WriteString(os, name);
+        os << ",\"cat\":\"delegate\",\"ph\":\"" << phase << "\",\"ts\":" << ts
+            << ",\"pid\":1,\"tid\":" << buffer.tid;
+        if (event.type == ENQUEUE)
+            os << ",\"dur\":0";
+        if (event.type == DEQUEUE || event.type == TIMER_EXPIRED)
+            os << ",\"s\":\"t\"";
+        if (event.type == TIMER_EXPIRED)
+            os << ",\"args\":{\"timer\":" << event.id << "}";
+        os << "}";
+
+        // Flow arrows from the enqueue slice to the execute slice on the target thread
+        if (event.type == ENQUEUE && event.id != 0)
+        {
+            os << ",\n{\"name\":\"flow\",\"cat\":\"delegate\",\"ph\":\"s\",\"id\":" << event.id
+                << ",\"ts\":" << ts << ",\"pid\":1,\"tid\":" << buffer.tid << "}";
+        }
+        else if (event.type == EXECUTE_BEGIN && event.id != 0)
+        {
+            os << ",\n{\"name\":\"flow\",\"cat\":\"delegate\",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << event.id
+                << ",\"ts\":" << ts << ",\"pid\":1,\"tid\":" << buffer.tid << "}";
+        }
+    }
+
+    void DelegateTrace::WriteChromeTrace(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lk(GetBuffersLock());
+
+        os << "{\"traceEvents\":[\n";
+        os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"DelegateLib\"}}";
+        for (auto buffer : GetBuffers())
+        {
+            os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+            WriteString(os, buffer->name);
+            os << "}}";
+
+            // Oldest retained event first. Slots overwritten by the owner thread 
+            // while being read are skipped.
+            unsigned long long head = buffer->head.load(std::memory_order_acquire);
+            size_t size = buffer->size;
+            unsigned long long start = head > size ? head - size : 0;
+            start = std::max(start, buffer->tail.load(std::memory_order_relaxed));
+            for (unsigned long long i = start; i < head; i++)
+            {
+                Event event;
+                if (ReadSlot(buffer->events[i % size], i, event))
+                    WriteEvent(os, *buffer, event);
+            }
+        }
+        os << "\n]}\n";
+    }
+
+    bool DelegateTrace::WriteChromeTrace(const std::string& fileName)
+    {
+        std::ofstream file(fileName.c_str());
+        if (!file)
+            return false;
+        WriteChromeTrace(file);
+        return file.good();
+    }
+
+    void DelegateTrace::Clear()
+    {
+        std::lock_guard<std::mutex> lk(GetBuffersLock());
+        // Only the owner thread writes head, so mark the events cleared instead
+        for (auto buffer : GetBuffers())
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
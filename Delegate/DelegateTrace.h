@@ -0,0 +1,158 @@
+#ifndef _DELEGATE_TRACE_H
+#define _DELEGATE_TRACE_H
+
+// DelegateTrace.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include "DelegateOpt.h"
+#include "DelegateTarget.h"
+#include <atomic>
+#include <string>
+#include <ostream>
+#include <vector>
+#include <mutex>
+
+namespace DelegateLib {
+
+/// @brief Optional tracing of asynchronous delegate activity. Records message
+/// enqueue, dequeue and execution, DelegateAsyncWait round trips and timer
+/// expirations into per-thread ring buffers, then writes them as Chrome trace
+/// event JSON viewable in chrome://tracing or https://ui.perfetto.dev. Flow
+/// events link each enqueue on the producer thread to its execution on the
+/// target thread.
+///
+/// @details Requires USE_DELEGATE_TRACE at compile time and SetEnabled(true) at
+/// runtime. Each thread writes only its own ring buffer so recording takes no
+/// lock. When a buffer fills the oldest events are overwritten. Disable tracing
+/// and let the threads go idle before calling WriteChromeTrace() for a
+/// consistent trace. When a thread exits its buffer is reused by the next thread
+/// that records, so events of an exited thread are written until then and
+/// thread churn does not grow memory.
+class DelegateTrace
+{
+public:
+	/// Switch tracing on or off at runtime. Has no effect unless compiled with
+	/// USE_DELEGATE_TRACE.
+	static void SetEnabled(bool enabled);
+
+	/// Returns true if events are being recorded.
+	static bool IsEnabled() {
+#ifdef USE_DELEGATE_TRACE
+		return GetEnabled().load(std::memory_order_relaxed);
+#else
+		return false;
+#endif
+	}
+
+	/// Set the number of events each thread's ring buffer holds. Applies to
+	/// threads that start recording afterwards. Default is 16384 events.
+	/// @param[in] events - the ring buffer capacity. Must be greater than 0.
+	static void SetBufferSize(size_t events);
+
+	/// Set the calling thread's name as shown in the trace.
+	/// @param[in] name - the thread name.
+	static void SetThreadName(const std::string& name);
+
+	/// Record a message queued to a target thread. Called by the producer thread.
+	/// @param[in] target - the function the message invokes.
+	/// @return A flow ID to pass to ExecuteBegin(), or 0 if not tracing.
+	static unsigned long long Enqueue(const DelegateTarget& target) {
+		if (!IsEnabled())
+			return 0;
+		unsigned long long flowId = GetNextFlowId().fetch_add(1, std::memory_order_relaxed);
+		Record(ENQUEUE, target, flowId);
+		return flowId;
+	}
+
+	/// Record a message removed from the queue by the target thread.
+	static void Dequeue(const DelegateTarget& target, unsigned long long flowId) {
+		if (IsEnabled())
+			Record(DEQUEUE, target, flowId);
+	}
+
+	/// Record the start of a delegate invocation on the target thread.
+	static void ExecuteBegin(const DelegateTarget& target, unsigned long long flowId) {
+		if (IsEnabled())
+			Record(EXECUTE_BEGIN, target, flowId);
+	}
+
+	/// Record the end of a delegate invocation on the target thread.
+	static void ExecuteEnd(const DelegateTarget& target) {
+		if (IsEnabled())
+			Record(EXECUTE_END, target, 0);
+	}
+
+	/// Record the start of a DelegateAsyncWait round trip on the calling thread.
+	static void WaitBegin(const DelegateTarget& target) {
+		if (IsEnabled())
+			Record(WAIT_BEGIN, target, 0);
+	}
+
+	/// Record the end of a DelegateAsyncWait round trip, invoked or timed out.
+	static void WaitEnd(const DelegateTarget& target) {
+		if (IsEnabled())
+			Record(WAIT_END, target, 0);
+	}
+
+	/// Record a timer expiration.
+	/// @param[in] timer - identifies the timer instance.
+	static void TimerExpired(const void* timer) {
+		if (IsEnabled())
+			Record(TIMER_EXPIRED, DelegateTarget(), (unsigned long long)(size_t)timer);
+	}
+
+	/// Write every thread's recorded events as Chrome trace event JSON.
+	/// @param[in] os - the output stream.
+	static void WriteChromeTrace(std::ostream& os);
+
+	/// Write the trace to a file.
+	/// @param[in] fileName - the output file name.
+	/// @return true if the file was written.
+	static bool WriteChromeTrace(const std::string& fileName);
+
+	/// Discard all recorded events.
+	static void Clear();
+
+private:
+	enum EventType
+	{
+		ENQUEUE,
+		DEQUEUE,
+		EXECUTE_BEGIN,
+		EXECUTE_END,
+		WAIT_BEGIN,
+		WAIT_END,
+		TIMER_EXPIRED
+	};
+
+	struct Event;
+	struct EventSlot;
+	struct ThreadBuffer;
+	struct ThreadBufferRelease;
+
+	static std::atomic<bool>& GetEnabled();
+	static std::atomic<unsigned long long>& GetNextFlowId();
+	static ThreadBuffer* GetThreadBuffer();
+	static void ReleaseThreadBuffer();
+	static std::vector<ThreadBuffer*>& GetBuffers();
+	static std::mutex& GetBuffersLock();
+	static void Record(EventType type, const DelegateTarget& target, unsigned long long id);
+	static void WriteEvent(std::ostream& os, const ThreadBuffer& buffer, const Event& event);
+
+	/// Write a ring buffer slot. Owner thread only.
+	static void WriteSlot(EventSlot& slot, unsigned long long index, const Event& event);
+
+	/// Read a ring buffer slot.
+	/// @return false if the slot does not hold event index or was overwritten during the read.
+	static bool ReadSlot(const EventSlot& slot, unsigned long long index, Event& event);
+
+	/// The calling thread's ring buffer, created on its first event
+	static thread_local ThreadBuffer* m_threadBuffer;
+
+	/// Releases m_threadBuffer when the calling thread exits
+	static thread_local ThreadBufferRelease m_threadBufferRelease;
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef _DELEGATE_TRANSPORT_H
 #define _DELEGATE_TRANSPORT_H
 
+#include "DelegateSpan.h"
 #include <ostream>
 
 namespace DelegateLib {
@@ -19,10 +20,32 @@ public:
 	/// for sending the bytes over a communication link. Once the receiver obtains the 
 	/// bytes, the DelegateRemoteInvoker::DelegateInvoke() function must be called to 
     /// execute the callback on the remote system. 
-	/// @param[in] s - an outgoing stream to send to the remote CPU.
+	/// @param[in] s - an outgoing stream to send to the remote CPU. For a sender created
+	/// without a stream, s holds exactly one complete message and is leased to this
+	/// call alone, so senders on several threads may call concurrently.
     virtual void DispatchDelegate(std::iostream& s) = 0;
 };
 
+/// @brief A transport that sends each message as a list of byte spans, e.g. with
+/// writev() or sendmsg(), so large arguments reach the link without being copied.
+/// Used by DelegateRemoteSpanSend. A transport may implement both interfaces.
+class IDelegateSpanTransport
+{
+public:
+    /// Destructor
+    virtual ~IDelegateSpanTransport() = default;
+
+    /// Dispatch one message to a remote system. The spans reference the sender's
+    /// buffer and arguments and are only valid until DispatchDelegate() returns.
+    /// Once the receiver obtains the message in one contiguous buffer, the
+    /// DelegateRemoteInvoker::Invoke(const void*, size_t) function must be called
+    /// to execute the callback on the remote system. Senders on several threads
+    /// may call concurrently, each with its own complete message.
+    /// @param[in] spans - the message bytes, in order.
+    /// @param[in] count - the number of spans.
+    virtual void DispatchDelegate(const DelegateSpan* spans, size_t count) = 0;
+};
+
 }
 
 #endif
@@ -1,9 +1,21 @@
 #ifdef DELEGATE_UNIT_TESTS
 
 #include "DelegateLib.h"
+#include "Allocator.h"
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <new>
 #if USE_STD_THREADS
 	#include "WorkerThreadStd.h"
+	#include "Watchdog.h"
+	#include "SpscQueue.h"
 #elif USE_WIN32_THREADS
 	#include "WorkerThreadWin.h"
 #endif
@@ -2544,6 +2556,1586 @@ void DelegateMemberAsyncWaitTests()
 		int ret = MemberFuncIntWithReturn5Delegate(TEST_INT, TEST_INT, TEST_INT, TEST_INT, TEST_INT);
 }
 
+static std::atomic<INT> connectionCallCnt(0);
+void ConnectionFuncInt1(INT i) { ASSERT_TRUE(i == TEST_INT); connectionCallCnt++; }
+
+void ConnectionFuncAuto()
+{
+	// Already executing on testThread so AUTO must invoke synchronously
+	auto delegate = MakeDelegate(&ConnectionFuncInt1, testThread);
+	delegate.SetConnection(DelegateConnection::AUTO);
+	INT cnt = connectionCallCnt;
+	delegate(TEST_INT);
+	ASSERT_TRUE(connectionCallCnt == cnt + 1);
+
+	// BLOCKING_QUEUED on the target thread must not deadlock
+	delegate.SetConnection(DelegateConnection::BLOCKING_QUEUED);
+	delegate(TEST_INT);
+	ASSERT_TRUE(connectionCallCnt == cnt + 2);
+}
+
+void DelegateConnectionTests()
+{
+	connectionCallCnt = 0;
+
+	// DIRECT invokes on the caller's thread
+	auto delegate = MakeDelegate(&ConnectionFuncInt1, testThread);
+	delegate.SetConnection(DelegateConnection::DIRECT);
+	delegate(TEST_INT);
+	ASSERT_TRUE(connectionCallCnt == 1);
+
+	// BLOCKING_QUEUED returns only after the target thread invoked the function
+	TestClass1 testClass1;
+	auto memberDelegate = MakeDelegate(&testClass1, &TestClass1::MemberFuncInt1, testThread);
+	memberDelegate.SetConnection(DelegateConnection::BLOCKING_QUEUED);
+	memberDelegate(TEST_INT);
+	delegate.SetConnection(DelegateConnection::BLOCKING_QUEUED);
+	delegate(TEST_INT);
+	ASSERT_TRUE(connectionCallCnt == 2);
+
+	// Policy is copied into delegate containers
+	MulticastDelegateSafe<void(INT)> multicastDelegate;
+	multicastDelegate += delegate;
+	multicastDelegate(TEST_INT);
+	ASSERT_TRUE(connectionCallCnt == 3);
+
+	// AUTO and BLOCKING_QUEUED invoked from the target thread run synchronously
+	auto autoDelegate = MakeDelegate(&ConnectionFuncAuto, testThread);
+	autoDelegate.SetConnection(DelegateConnection::BLOCKING_QUEUED);
+	autoDelegate();
+	ASSERT_TRUE(connectionCallCnt == 5);
+}
+
+// Invokes each remote delegate as soon as it is sent
+class LoopbackTransport : public IDelegateTransport
+{
+public:
+	LoopbackTransport(std::stringstream& stream) : m_stream(stream) {}
+
+	virtual void DispatchDelegate(std::iostream& s) override {
+		sentBytes = m_stream.str().size();
+		ASSERT_TRUE(DelegateRemoteInvoker::Invoke(s));
+		m_stream.str(std::string());
+		m_stream.clear();
+	}
+
+	size_t sentBytes = 0;
+
+private:
+	std::stringstream& m_stream;
+};
+
+enum class RemoteColor { RED, GREEN = 300 };
+
+struct RemotePoint
+{
+	INT x;
+	INT y;
+	std::string name;
+	std::vector<INT> samples;
+	DELEGATE_REFLECT(x, y, name, samples)
+};
+
+struct RemoteRaw { INT a; double b; };
+
+static INT remoteInt;
+static RemotePoint remotePoint;
+static std::map<INT, std::string> remoteMap;
+static int remoteCallCnt = 0;
+
+void RemoteFuncInt2(INT i, INT i2) { remoteInt = i + i2; remoteCallCnt++; }
+
+void RemoteFuncScalars(INT i, unsigned long long u, double d, bool b, RemoteColor c)
+{
+	ASSERT_TRUE(i == -TEST_INT && u == 0xFFFFFFFFFFFFull && d == 3.25 && b && c == RemoteColor::GREEN);
+	remoteCallCnt++;
+}
+
+void RemoteFuncStructs(RemotePoint* point, const RemoteRaw& raw, std::map<INT, std::string> map, std::vector<unsigned char> bytes)
+{
+	remotePoint = *point;
+	ASSERT_TRUE(raw.a == TEST_INT && raw.b == 1.5);
+	remoteMap = map;
+	ASSERT_TRUE(bytes.size() == 3 && bytes[2] == 0xFF);
+	remoteCallCnt++;
+}
+
+class RemoteReceiver
+{
+public:
+	void MemberFuncString(std::string s, std::list<std::string> l) { value = s + l.back(); }
+	std::string value;
+};
+
+// Gathers the spans of each message into one receive buffer, as a socket would
+// A stream buffer like a socket's. Exposes one byte at a time and cannot seek.
+class TrickleBuf : public std::streambuf
+{
+public:
+	TrickleBuf(const std::string& data) : m_data(data), m_pos(0) {}
+
+protected:
+	virtual int_type underflow() override {
+		if (m_pos >= m_data.size())
+			return traits_type::eof();
+		m_byte = m_data[m_pos++];
+		setg(&m_byte, &m_byte, &m_byte + 1);
+		return traits_type::to_int_type(m_byte);
+	}
+
+private:
+	std::string m_data;
+	size_t m_pos;
+	char m_byte;
+};
+
+class GatherTransport : public IDelegateSpanTransport
+{
+public:
+	virtual void DispatchDelegate(const DelegateSpan* spans, size_t count) override {
+		frame.clear();
+		for (size_t i = 0; i < count; i++)
+		{
+			const char* data = static_cast<const char*>(spans[i].data);
+			if (data == payload)
+				payloadSpans++;
+			frame.insert(frame.end(), data, data + spans[i].size);
+		}
+		ASSERT_TRUE(DelegateRemoteInvoker::Invoke(frame.data(), frame.size()));
+	}
+
+	std::vector<char> frame;
+	const char* payload = nullptr;
+	int payloadSpans = 0;
+};
+
+static DelegateBytes remoteBytes;
+
+void RemoteFuncBytes(INT i, DelegateBytes bytes, const std::string& s)
+{
+	ASSERT_TRUE(i == TEST_INT && s.size() == 512 && s[511] == 's');
+	remoteBytes = bytes;
+	remoteCallCnt++;
+}
+
+#if USE_STD_THREADS
+static std::atomic<INT> remoteDispatchCnt(0);
+void RemoteFuncCount(INT i) { ASSERT_TRUE(i == TEST_INT); remoteDispatchCnt++; }
+
+class RemoteCounter
+{
+public:
+	void MemberFuncCount(INT i) { ASSERT_TRUE(i == TEST_INT); count++; }
+	std::atomic<INT> count{ 0 };
+};
+
+// Invokes each remote delegate on the sending thread. Safe for concurrent senders.
+class ConcurrentLoopbackTransport : public IDelegateTransport, public IDelegateSpanTransport
+{
+public:
+	virtual void DispatchDelegate(std::iostream& s) override {
+		auto encodeStream = dynamic_cast<DelegateEncodeStream*>(&s);
+		ASSERT_TRUE(encodeStream && encodeStream->GetSize() < 64);
+		ASSERT_TRUE(DelegateRemoteInvoker::Invoke(encodeStream->GetData(), encodeStream->GetSize()));
+	}
+
+	virtual void DispatchDelegate(const DelegateSpan* spans, size_t count) override {
+		std::vector<char> frame;
+		for (size_t i = 0; i < count; i++)
+			frame.insert(frame.end(), static_cast<const char*>(spans[i].data), static_cast<const char*>(spans[i].data) + spans[i].size);
+		ASSERT_TRUE(DelegateRemoteInvoker::Invoke(frame.data(), frame.size()));
+	}
+};
+
+static std::atomic<INT> remoteSendCnt(0);
+void RemoteFuncMatch(INT i, std::string s) { ASSERT_TRUE(s == std::to_string(i)); remoteSendCnt++; }
+void RemoteFuncNegated(INT i, INT negated) { ASSERT_TRUE(negated == -i); remoteSendCnt++; }
+
+// Several threads share one sender delegate of each kind
+void RemoteSendThreadTests()
+{
+	const int SEND_THREAD_CNT = 4;
+	const int LOOP_CNT = 2000;
+
+	ConcurrentLoopbackTransport transport;
+	auto streamRecv = MakeDelegate(&RemoteFuncMatch, 20, DelegateBinaryCodec());
+	auto textRecv = MakeDelegate(&RemoteFuncNegated, 21);
+	auto spanRecv = MakeDelegate(&RemoteFuncMatch, 22, DelegateBinaryCodec());
+	auto streamSend = MakeDelegate<INT, std::string>(static_cast<IDelegateTransport&>(transport), 20, DelegateBinaryCodec());
+	auto textSend = MakeDelegate<INT, INT>(static_cast<IDelegateTransport&>(transport), 21);
+	auto spanSend = MakeDelegate<INT, std::string>(static_cast<IDelegateSpanTransport&>(transport), 22);
+
+	remoteSendCnt = 0;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < SEND_THREAD_CNT; t++)
+	{
+		threads.emplace_back([&streamSend, &textSend, &spanSend, t]() {
+			for (int i = 0; i < LOOP_CNT; i++)
+			{
+				INT value = t * LOOP_CNT + i;
+				streamSend(value, std::to_string(value));
+				textSend(value, -value);
+				spanSend(value, std::to_string(value));
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	ASSERT_TRUE(remoteSendCnt == SEND_THREAD_CNT * LOOP_CNT * 3);
+}
+
+// The downstream transport of a batch. Unpacks each batch as the remote system would.
+class BatchReceiveTransport : public IDelegateSpanTransport
+{
+public:
+	virtual void DispatchDelegate(const DelegateSpan* spans, size_t count) override {
+		ASSERT_TRUE(count == 1);
+		invoked += DelegateBatchTransport::InvokeBatch(spans[0].data, spans[0].size);
+		batches++;
+		last.assign(static_cast<const char*>(spans[0].data), static_cast<const char*>(spans[0].data) + spans[0].size);
+	}
+
+	std::vector<char> last;
+	std::atomic<size_t> invoked{ 0 };
+	std::atomic<size_t> batches{ 0 };
+};
+
+static std::atomic<INT> remoteBatchCnt(0);
+void RemoteFuncBatch(INT i, INT negated) { ASSERT_TRUE(negated == -i); remoteBatchCnt++; }
+
+void RemoteBatchTests()
+{
+	const int SEND_THREAD_CNT = 2;
+	const int LOOP_CNT = 1000;
+
+	auto batchRecv = MakeDelegate(&RemoteFuncBatch, 30, DelegateBinaryCodec());
+	auto textRecv = MakeDelegate(&RemoteFuncBatch, 31);
+	remoteBatchCnt = 0;
+
+	// Sealed on size. Messages from concurrent senders are never split.
+	{
+		BatchReceiveTransport downstream;
+		DelegateBatchTransport batch(downstream, 256, std::chrono::seconds(10));
+		auto batchSend = MakeDelegate<INT, INT>(static_cast<IDelegateTransport&>(batch), 30, DelegateBinaryCodec());
+		std::vector<std::thread> threads;
+		for (int t = 0; t < SEND_THREAD_CNT; t++)
+		{
+			threads.emplace_back([&batchSend]() {
+				for (int i = 0; i < LOOP_CNT; i++)
+					batchSend(i, -i);
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+		batch.Flush();
+		ASSERT_TRUE(downstream.invoked == SEND_THREAD_CNT * LOOP_CNT);
+		ASSERT_TRUE(batch.GetMessages() == SEND_THREAD_CNT * LOOP_CNT);
+		ASSERT_TRUE(batch.GetBatches() == downstream.batches);
+		ASSERT_TRUE(downstream.batches * 20 < SEND_THREAD_CNT * LOOP_CNT);
+	}
+	ASSERT_TRUE(remoteBatchCnt == SEND_THREAD_CNT * LOOP_CNT);
+
+	// Sealed explicitly. A caller supplied text stream is read from its read position.
+	{
+		BatchReceiveTransport downstream;
+		DelegateBatchTransport batch(downstream, DelegateBatchTransport::DEFAULT_BATCH_SIZE, std::chrono::seconds(10));
+		auto spanSend = MakeDelegate<INT, INT>(static_cast<IDelegateSpanTransport&>(batch), 30);
+		std::stringstream textStream(std::ios::in | std::ios::out | std::ios::binary);
+		auto textSend = MakeDelegate<INT, INT>(static_cast<IDelegateTransport&>(batch), textStream, 31);
+		for (int i = 0; i < 5; i++)
+		{
+			spanSend(i, -i);
+			textSend(i, -i);
+		}
+		ASSERT_TRUE(downstream.batches == 0);
+		batch.Flush();
+		ASSERT_TRUE(downstream.invoked == 10 && downstream.batches == 1);
+
+		// A truncated or corrupted batch stops at the first incomplete message
+		std::vector<char> received = downstream.last;
+		ASSERT_TRUE(DelegateBatchTransport::InvokeBatch(received.data(), received.size() - 1) == 9);
+		ASSERT_TRUE(DelegateBatchTransport::InvokeBatch(received.data(), 2) == 0);
+		memset(received.data(), 0xFF, 4);
+		ASSERT_TRUE(DelegateBatchTransport::InvokeBatch(received.data(), received.size()) == 0);
+	}
+
+	// Sealed on the time budget without a flush
+	{
+		BatchReceiveTransport downstream;
+		DelegateBatchTransport batch(downstream, DelegateBatchTransport::DEFAULT_BATCH_SIZE, std::chrono::milliseconds(1));
+		auto batchSend = MakeDelegate<INT, INT>(static_cast<IDelegateTransport&>(batch), 30, DelegateBinaryCodec());
+		for (int i = 0; i < 3; i++)
+			batchSend(i, -i);
+		for (int wait = 0; wait < 5000 && downstream.invoked < 3; wait++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		ASSERT_TRUE(downstream.invoked == 3);
+	}
+}
+
+// Receive threads dispatch while receivers are registered, destroyed and the table grows
+void RemoteDispatchThreadTests()
+{
+	const int RECV_THREAD_CNT = 4;
+	const int LOOP_CNT = 2000;
+
+	std::stringstream frames[2];
+	for (int i = 0; i < 2; i++)
+	{
+		DelegateBinaryCodec::WriteId(frames[i], 10 + i);
+		DelegateBinaryCodec::Write(frames[i], TEST_INT);
+	}
+
+	remoteDispatchCnt = 0;
+	auto recv = MakeDelegate(&RemoteFuncCount, 10, DelegateBinaryCodec());
+
+	std::atomic<bool> done(false);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < RECV_THREAD_CNT; t++)
+	{
+		threads.emplace_back([&frames]() {
+			for (int i = 0; i < LOOP_CNT; i++)
+			{
+				std::istringstream always(frames[0].str());
+				ASSERT_TRUE(DelegateRemoteInvoker::Invoke(always));
+				std::istringstream sometimes(frames[1].str());
+				DelegateRemoteInvoker::Invoke(sometimes);
+			}
+		});
+	}
+
+	for (int i = 0; !done; i++)
+	{
+		RemoteCounter counter;
+		{
+			auto counterRecv = MakeDelegate(&counter, &RemoteCounter::MemberFuncCount, 11, DelegateBinaryCodec());
+			std::vector<std::unique_ptr<DelegateFreeRemoteRecv<void(INT), DelegateBinaryCodec>>> fill;
+			for (int id = 0; id < 8; id++)
+				fill.emplace_back(new DelegateFreeRemoteRecv<void(INT), DelegateBinaryCodec>(&RemoteFuncCount, 1000 + (i % 4) * 8 + id));
+		}
+		done = remoteDispatchCnt >= RECV_THREAD_CNT * LOOP_CNT;
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+	ASSERT_TRUE(remoteDispatchCnt == RECV_THREAD_CNT * LOOP_CNT);
+	std::istringstream unregistered(frames[1].str());
+	ASSERT_TRUE(!DelegateRemoteInvoker::Invoke(unregistered));
+}
+#endif
+
+void RemoteDelegateTests()
+{
+	std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+	LoopbackTransport transport(stream);
+	remoteCallCnt = 0;
+
+	// Text and binary frames are told apart by the receiver
+	auto textRecv = MakeDelegate(&RemoteFuncInt2, 1);
+	auto binaryRecv = MakeDelegate(&RemoteFuncInt2, 2, DelegateBinaryCodec());
+	MakeDelegate<INT, INT>(transport, stream, 1)(TEST_INT, 1);
+	ASSERT_TRUE(remoteInt == TEST_INT + 1);
+	size_t textBytes = transport.sentBytes;
+	MakeDelegate<INT, INT>(transport, stream, 2, DelegateBinaryCodec())(TEST_INT, 2);
+	ASSERT_TRUE(remoteInt == TEST_INT + 2);
+	ASSERT_TRUE(transport.sentBytes < textBytes);
+
+	// Varints, zigzag, fixed width and enums
+	auto scalarRecv = MakeDelegate(&RemoteFuncScalars, 3, DelegateBinaryCodec());
+	MakeDelegate<INT, unsigned long long, double, bool, RemoteColor>(transport, stream, 3, DelegateBinaryCodec())(
+		-TEST_INT, 0xFFFFFFFFFFFFull, 3.25, true, RemoteColor::GREEN);
+
+	// Reflected and trivially copyable structs, pointer and reference arguments, containers
+	auto structRecv = MakeDelegate(&RemoteFuncStructs, 4, DelegateBinaryCodec());
+	RemotePoint point = { 1, -2, "point", { 3, 4, 5 } };
+	RemoteRaw raw = { TEST_INT, 1.5 };
+	std::map<INT, std::string> map = { { 1, "one" }, { 2, "two" } };
+	MakeDelegate<RemotePoint*, const RemoteRaw&, std::map<INT, std::string>, std::vector<unsigned char>>(
+		transport, stream, 4, DelegateBinaryCodec())(&point, raw, map, { 0, 1, 0xFF });
+	ASSERT_TRUE(remotePoint.x == 1 && remotePoint.y == -2 && remotePoint.name == "point");
+	ASSERT_TRUE(remotePoint.samples == point.samples);
+	ASSERT_TRUE(remoteMap == map);
+	ASSERT_TRUE(remoteCallCnt == 4);
+
+	// Member function receiver
+	RemoteReceiver receiver;
+	auto memberRecv = MakeDelegate(&receiver, &RemoteReceiver::MemberFuncString, 5, DelegateBinaryCodec());
+	MakeDelegate<std::string, std::list<std::string>>(transport, stream, 5, DelegateBinaryCodec())(
+		"remote ", { "a", "delegate" });
+	ASSERT_TRUE(receiver.value == "remote delegate");
+
+	// Scatter/gather transport. The payload is sent in place and viewed in the receive buffer.
+	GatherTransport gather;
+	std::vector<char> payload(1024, 'p');
+	gather.payload = payload.data();
+	auto bytesRecv = MakeDelegate(&RemoteFuncBytes, 6, DelegateBinaryCodec());
+	auto bytesSend = MakeDelegate<INT, DelegateBytes, const std::string&>(gather, 6);
+	bytesSend(TEST_INT, DelegateBytes(payload.data(), payload.size()), std::string(512, 's'));
+	bytesSend(TEST_INT, DelegateBytes(payload.data(), payload.size()), std::string(512, 's'));
+	ASSERT_TRUE(remoteCallCnt == 6 && gather.payloadSpans == 2);
+	const char* view = static_cast<const char*>(remoteBytes.data);
+	ASSERT_TRUE(remoteBytes.size == payload.size());
+	ASSERT_TRUE(view > gather.frame.data() && view + remoteBytes.size <= gather.frame.data() + gather.frame.size());
+	ASSERT_TRUE(memcmp(view, payload.data(), payload.size()) == 0);
+
+	// A text message decoded straight from a buffer
+	std::stringstream text;
+	DelegateTextCodec::WriteId(text, 1);
+	DelegateTextCodec::Write(text, TEST_INT);
+	DelegateTextCodec::Write(text, 3);
+	std::string textFrame = text.str();
+	ASSERT_TRUE(DelegateRemoteInvoker::Invoke(textFrame.data(), textFrame.size()));
+	ASSERT_TRUE(remoteInt == TEST_INT + 3);
+
+	// A length longer than the message fails the stream instead of being allocated
+	const std::string hostile("\xFF\xFF\xFF\xFF\xFF\x7F" "abc", 9);
+	std::istringstream hostileString(hostile);
+	std::string decodedString = "old";
+	DelegateBinaryCodec::Read(hostileString, decodedString);
+	ASSERT_TRUE(hostileString.fail() && decodedString.empty());
+	std::istringstream hostileVector(hostile);
+	std::vector<INT> decodedVector(1);
+	DelegateBinaryCodec::Read(hostileVector, decodedVector);
+	ASSERT_TRUE(hostileVector.fail() && decodedVector.empty());
+	std::istringstream hostileList(hostile);
+	std::list<std::string> decodedList(1);
+	DelegateBinaryCodec::Read(hostileList, decodedList);
+	ASSERT_TRUE(hostileList.fail() && decodedList.empty());
+	std::istringstream hostileMap(hostile);
+	std::map<INT, std::string> decodedMap = map;
+	DelegateBinaryCodec::Read(hostileMap, decodedMap);
+	ASSERT_TRUE(hostileMap.fail() && decodedMap.empty());
+
+	// A stream that buffers one byte at a time and cannot seek still decodes long values
+	std::stringstream longValues;
+	std::vector<INT> longVector(1000, TEST_INT);
+	DelegateBinaryCodec::Write(longValues, std::string(1000, 'x'));
+	DelegateBinaryCodec::Write(longValues, longVector);
+	TrickleBuf trickle(longValues.str());
+	std::istream trickleStream(&trickle);
+	DelegateBinaryCodec::Read(trickleStream, decodedString);
+	DelegateBinaryCodec::Read(trickleStream, decodedVector);
+	ASSERT_TRUE(trickleStream.good() && decodedString == std::string(1000, 'x') && decodedVector == longVector);
+	TrickleBuf hostileTrickle(hostile);
+	std::istream hostileTrickleStream(&hostileTrickle);
+	DelegateBinaryCodec::Read(hostileTrickleStream, decodedString);
+	ASSERT_TRUE(hostileTrickleStream.fail());
+
+	// The receiver drops a malformed message
+	std::stringstream malformed;
+	DelegateBinaryCodec::WriteId(malformed, 5);
+	DelegateBinaryCodec::Write(malformed, std::string("malformed"));
+	malformed << hostile;
+	std::string malformedFrame = malformed.str();
+	receiver.value.clear();
+	ASSERT_TRUE(DelegateRemoteInvoker::Invoke(malformedFrame.data(), malformedFrame.size()));
+	ASSERT_TRUE(receiver.value.empty());
+
+	// A text frame sent to a binary codec receiver is dropped too
+	malformed.str("");
+	DelegateTextCodec::WriteId(malformed, 5);
+	DelegateTextCodec::Write(malformed, std::string("text"));
+	malformedFrame = malformed.str();
+	ASSERT_TRUE(DelegateRemoteInvoker::Invoke(malformedFrame.data(), malformedFrame.size()));
+	ASSERT_TRUE(receiver.value.empty());
+
+	malformed.str("");
+	DelegateBinaryCodec::WriteId(malformed, 6);
+	DelegateBinaryCodec::Write(malformed, TEST_INT);
+	malformed << hostile;
+	malformedFrame = malformed.str();
+	int callCnt = remoteCallCnt;
+	ASSERT_TRUE(DelegateRemoteInvoker::Invoke(malformedFrame.data(), malformedFrame.size()));
+	ASSERT_TRUE(remoteCallCnt == callCnt);
+
+#if USE_STD_THREADS
+	RemoteDispatchThreadTests();
+	RemoteSendThreadTests();
+	RemoteBatchTests();
+#endif
+}
+
+#if USE_STD_THREADS
+static std::atomic<INT> laneCallCnt(0);
+void LaneFuncInt1(INT i) { ASSERT_TRUE(i == TEST_INT); laneCallCnt++; }
+
+void WorkerThreadLaneTests()
+{
+	const int PRODUCER_CNT = 4;
+	const int LOOP_CNT = 1000;
+
+	WorkerThread laneThread("LaneTestThread", WorkerThread::QueueMode::PRODUCER_LANES);
+	laneThread.SetLaneBudget(4);
+	laneThread.CreateThread();
+	laneCallCnt = 0;
+
+	// Each producer thread floods the worker thread through its own lane
+	std::vector<std::thread> producers;
+	for (int p = 0; p < PRODUCER_CNT; p++)
+	{
+		producers.push_back(std::thread([&laneThread]() {
+			auto delegate = MakeDelegate(&LaneFuncInt1, laneThread);
+			for (int i = 0; i < LOOP_CNT; i++)
+				delegate(TEST_INT);
+		}));
+	}
+	for (auto& producer : producers)
+		producer.join();
+
+	// Exit drains all lanes
+	laneThread.ExitThread();
+	ASSERT_TRUE(laneCallCnt == PRODUCER_CNT * LOOP_CNT);
+
+	// A producer registered before a restart gets a new lane afterwards
+	laneThread.CreateThread();
+	laneCallCnt = 0;
+	std::atomic<int> step(0);
+	std::thread producer([&laneThread, &step]() {
+		auto delegate = MakeDelegate(&LaneFuncInt1, laneThread);
+		delegate(TEST_INT);
+		step = 1;
+		while (step != 2)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		delegate(TEST_INT);
+	});
+	while (step != 1)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	laneThread.ExitThread();
+	laneThread.CreateThread();
+	step = 2;
+	producer.join();
+	laneThread.ExitThread();
+	ASSERT_TRUE(laneCallCnt == 2);
+
+	// A producer that keeps pushing while the thread exits does not stall the 
+	// drain. Pushes made after exit starts are rejected.
+	laneThread.CreateThread();
+	laneCallCnt = 0;
+	std::atomic<bool> stop(false);
+	std::atomic<int> pushed(0);
+	std::thread flooder([&laneThread, &stop, &pushed]() {
+		auto delegate = MakeDelegate(&LaneFuncInt1, laneThread);
+		while (!stop)
+		{
+			delegate(TEST_INT);
+			pushed++;
+		}
+	});
+	while (pushed < LOOP_CNT)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	laneThread.RequestExit(WorkerThread::ExitMode::DRAIN);
+	for (int wait = 0; wait < 5000 && laneThread.GetDiscardedCount() == 0; wait++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	ASSERT_TRUE(laneThread.GetDiscardedCount() > 0);
+	stop = true;
+	flooder.join();
+	size_t discarded = laneThread.JoinThread();
+	ASSERT_TRUE(laneCallCnt + discarded == (size_t)pushed);
+}
+
+void WorkerThreadWaitStrategyTests()
+{
+	const int LOOP_CNT = 1000;
+	const WorkerThread::WaitStrategy strategies[] = { 
+		WorkerThread::WaitStrategy::BLOCK, 
+		WorkerThread::WaitStrategy::SPIN_THEN_PARK, 
+		WorkerThread::WaitStrategy::BUSY_POLL };
+
+	for (auto strategy : strategies)
+	{
+		WorkerThread waitThread("WaitStrategyTestThread");
+		waitThread.SetWaitStrategy(strategy);
+		waitThread.CreateThread();
+		laneCallCnt = 0;
+
+		auto delegate = MakeDelegate(&LaneFuncInt1, waitThread);
+		for (int i = 0; i < LOOP_CNT; i++)
+			delegate(TEST_INT);
+
+		waitThread.ExitThread();
+		ASSERT_TRUE(laneCallCnt == LOOP_CNT);
+
+		WorkerThread::WaitStats stats = waitThread.GetWaitStats(strategy);
+		ASSERT_TRUE(stats.busyTime.count() > 0);
+		if (strategy == WorkerThread::WaitStrategy::BUSY_POLL)
+			ASSERT_TRUE(stats.parks == 0);
+	}
+}
+
+void SleepFunc(INT ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+// Holds the worker thread until released so messages queue up behind it
+static Semaphore gateEntered;
+static Semaphore gateRelease;
+void GateFunc() { gateEntered.Signal(); gateRelease.Wait(-1); }
+
+// Counts live instances so discarded argument copies can be checked
+struct DiscardParam
+{
+	DiscardParam() { liveCnt++; }
+	DiscardParam(const DiscardParam&) { liveCnt++; }
+	~DiscardParam() { liveCnt--; }
+	static std::atomic<int> liveCnt;
+};
+std::atomic<int> DiscardParam::liveCnt(0);
+void DiscardParamFunc(DiscardParam* p1, DiscardParam& p2, DiscardParam** p3) { }
+
+void WorkerThreadExitTests()
+{
+	const int LOOP_CNT = 100;
+
+	// DRAIN invokes every queued message
+	WorkerThread drainThread("DrainTestThread");
+	drainThread.CreateThread();
+	laneCallCnt = 0;
+	MakeDelegate(&SleepFunc, drainThread)(20);
+	auto delegate = MakeDelegate(&LaneFuncInt1, drainThread);
+	for (int i = 0; i < LOOP_CNT; i++)
+		delegate(TEST_INT);
+	ASSERT_TRUE(drainThread.ExitThread() == 0);
+	ASSERT_TRUE(laneCallCnt == LOOP_CNT);
+
+	// DISCARD drops the backlog, frees its argument copies and releases a blocked caller
+	WorkerThread discardThread("DiscardTestThread", WorkerThread::QueueMode::PRODUCER_LANES);
+	discardThread.SetLaneBudget(1);
+	discardThread.CreateThread();
+	laneCallCnt = 0;
+	MakeDelegate(&GateFunc, discardThread)();
+	ASSERT_TRUE(gateEntered.Wait(5000));
+	auto discardDelegate = MakeDelegate(&LaneFuncInt1, discardThread);
+	for (int i = 0; i < LOOP_CNT; i++)
+		discardDelegate(TEST_INT);
+	{
+		DiscardParam param;
+		DiscardParam* paramPtr = &param;
+		auto paramDelegate = MakeDelegate(&DiscardParamFunc, discardThread);
+		for (int i = 0; i < LOOP_CNT; i++)
+			paramDelegate(&param, param, &paramPtr);
+		ASSERT_TRUE(DiscardParam::liveCnt == 1 + LOOP_CNT * 3);
+	}
+	std::thread blockedCaller([&discardThread]() {
+		auto blockingDelegate = MakeDelegate(&LaneFuncInt1, discardThread);
+		blockingDelegate.SetConnection(DelegateConnection::BLOCKING_QUEUED);
+		blockingDelegate(TEST_INT);
+	});
+	std::atomic<bool> waitSuccess(true);
+	std::thread waitCaller([&discardThread, &waitSuccess]() {
+		auto waitDelegate = MakeDelegate(&LaneFuncInt1, discardThread, WAIT_INFINITE);
+		waitDelegate(TEST_INT);
+		waitSuccess = waitDelegate.IsSuccess();
+	});
+	for (int wait = 0; wait < 5000 && discardThread.GetStats().enqueued < LOOP_CNT * 2 + 3; wait++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	discardThread.RequestExit(WorkerThread::ExitMode::DISCARD);
+	gateRelease.Signal();
+	size_t discarded = discardThread.JoinThread();
+	blockedCaller.join();
+	waitCaller.join();
+	ASSERT_TRUE(!waitSuccess);
+	ASSERT_TRUE(discarded == LOOP_CNT * 2 + 2);
+	ASSERT_TRUE(laneCallCnt == 0);
+	ASSERT_TRUE(DiscardParam::liveCnt == 0);
+
+	// DEADLINE exits several threads in parallel within the deadline
+	WorkerThread deadlineThread1("DeadlineTestThread1");
+	WorkerThread deadlineThread2("DeadlineTestThread2");
+	std::vector<WorkerThread*> threads = { &deadlineThread1, &deadlineThread2 };
+	for (auto thread : threads)
+	{
+		thread->CreateThread();
+		auto sleepDelegate = MakeDelegate(&SleepFunc, *thread);
+		for (int i = 0; i < LOOP_CNT; i++)
+			sleepDelegate(10);
+	}
+	auto start = std::chrono::steady_clock::now();
+	discarded = WorkerThread::ExitThreads(threads, WorkerThread::ExitMode::DEADLINE, std::chrono::milliseconds(50));
+	ASSERT_TRUE(discarded > 0);
+	ASSERT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+}
+
+void WorkerThreadStatsTests()
+{
+	const int LOOP_CNT = 100;
+
+	for (auto queueMode : { WorkerThread::QueueMode::SHARED_QUEUE, WorkerThread::QueueMode::PRODUCER_LANES })
+	{
+		WorkerThread statsThread("StatsTestThread", queueMode);
+		statsThread.CreateThread();
+
+		// Queue a backlog behind a slow message
+		laneCallCnt = 0;
+		MakeDelegate(&SleepFunc, statsThread)(20);
+		auto delegate = MakeDelegate(&LaneFuncInt1, statsThread);
+		for (int i = 0; i < LOOP_CNT; i++)
+			delegate(TEST_INT);
+		while (laneCallCnt < LOOP_CNT)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		// Let a timer tick update the rates and CPU time
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+		WorkerThread::Stats stats = statsThread.GetStats();
+		ASSERT_TRUE(stats.threadName == "StatsTestThread");
+		ASSERT_TRUE(stats.enqueued == LOOP_CNT + 1);
+		ASSERT_TRUE(stats.processed == LOOP_CNT + 1);
+		ASSERT_TRUE(stats.queueDepth == 0);
+		ASSERT_TRUE(stats.maxQueueDepth > 0 && stats.maxQueueDepth <= LOOP_CNT + 1);
+		ASSERT_TRUE(stats.maxExecTime >= std::chrono::milliseconds(20));
+		ASSERT_TRUE(stats.sojournMax >= std::chrono::milliseconds(10));
+		ASSERT_TRUE(stats.sojournP50 <= stats.sojournP99 && stats.sojournP99 <= stats.sojournMax);
+		ASSERT_TRUE(stats.busyTime >= std::chrono::milliseconds(20));
+		ASSERT_TRUE(stats.enqueueRate > 0 && stats.dequeueRate > 0);
+
+		// The registry reports every live thread
+		bool found = false;
+		for (auto& threadStats : WorkerThread::GetAllStats())
+			found |= threadStats.threadName == "StatsTestThread";
+		ASSERT_TRUE(found);
+
+		statsThread.ExitThread();
+	}
+}
+
+static std::atomic<size_t> arenaMaxUsed(0);
+static std::atomic<int> arenaCallCnt(0);
+
+// Allocate from the worker thread arena and record how much was already in use
+void ArenaFuncInt1(INT i)
+{
+	DelegateArena* arena = WorkerThread::GetArena();
+	ASSERT_TRUE(arena != nullptr);
+	size_t used = arena->GetUsed();
+	if (used > arenaMaxUsed)
+		arenaMaxUsed = used;
+
+	INT* values = static_cast<INT*>(arena->Allocate(sizeof(INT) * 16, alignof(INT)));
+	for (int j = 0; j < 16; j++)
+		values[j] = i;
+	StructParam* param = arena->New<StructParam>();
+	param->val = values[15];
+	ASSERT_TRUE(param->val == TEST_INT);
+#ifdef USE_CXX17
+	std::pmr::vector<INT> vec(arena);
+	vec.assign(8, i);
+	ASSERT_TRUE(vec.back() == TEST_INT);
+#endif
+	arenaCallCnt++;
+}
+
+void WorkerThreadArenaTests()
+{
+	// Requests beyond the current chunk take a new chunk until the next reset
+	DelegateArena arena(256);
+	ASSERT_TRUE(arena.GetCapacity() == 0);
+	void* aligned = arena.Allocate(10, 64);
+	ASSERT_TRUE(reinterpret_cast<size_t>(aligned) % 64 == 0);
+	for (int i = 0; i < 3; i++)
+		ASSERT_TRUE(arena.Allocate(100) != nullptr);
+	ASSERT_TRUE(arena.Allocate(1000) != nullptr);
+	ASSERT_TRUE(arena.GetChunkAllocations() == 3);
+	ASSERT_TRUE(arena.GetUsed() >= 1310);
+
+	// The reset coalesces the chunks so the same load needs no new memory
+	arena.Reset();
+	ASSERT_TRUE(arena.GetUsed() == 0 && arena.GetPeak() >= 1310);
+	ASSERT_TRUE(arena.GetChunkAllocations() == 4);
+	ASSERT_TRUE(arena.Allocate(10, 64) != nullptr);
+	for (int i = 0; i < 3; i++)
+		arena.Allocate(100);
+	arena.Allocate(1000);
+	ASSERT_TRUE(arena.GetChunkAllocations() == 4);
+	ASSERT_TRUE(arena.GetResets() == 1);
+
+	// Only worker threads have an arena
+	ASSERT_TRUE(WorkerThread::GetArena() == nullptr);
+
+	const int LOOP_CNT = 10;
+	for (auto reset : { WorkerThread::ArenaReset::MESSAGE, WorkerThread::ArenaReset::BATCH })
+	{
+		WorkerThread arenaThread("ArenaTestThread");
+		arenaThread.SetArenaReset(reset);
+		arenaThread.CreateThread();
+		arenaMaxUsed = 0;
+		arenaCallCnt = 0;
+
+		// Queue a backlog behind a slow message so the messages form one batch
+		MakeDelegate(&SleepFunc, arenaThread)(20);
+		auto delegate = MakeDelegate(&ArenaFuncInt1, arenaThread);
+		for (int i = 0; i < LOOP_CNT; i++)
+			delegate(TEST_INT);
+		arenaThread.ExitThread();
+		ASSERT_TRUE(arenaCallCnt == LOOP_CNT);
+
+		WorkerThread::Stats stats = arenaThread.GetStats();
+		ASSERT_TRUE(stats.arenaCapacity >= DelegateArena::DEFAULT_CHUNK_SIZE);
+		if (reset == WorkerThread::ArenaReset::MESSAGE)
+		{
+			ASSERT_TRUE(arenaMaxUsed == 0);
+			ASSERT_TRUE(arenaThread.GetThreadArena().GetResets() == LOOP_CNT);
+		}
+		else
+		{
+			ASSERT_TRUE(arenaMaxUsed >= (LOOP_CNT - 1) * sizeof(INT) * 16);
+			ASSERT_TRUE(stats.arenaPeak >= LOOP_CNT * sizeof(INT) * 16);
+		}
+		ASSERT_TRUE(arenaThread.GetThreadArena().GetChunkAllocations() == 1);
+	}
+}
+
+// Count global heap allocations while heapCheck is set
+static std::atomic<bool> heapCheck(false);
+static std::atomic<int> heapAllocations(0);
+
+void* operator new(size_t size)
+{
+	if (heapCheck.load(std::memory_order_relaxed))
+		heapAllocations++;
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+// Dispatch common signatures synchronously, asynchronously and with AsyncWait
+static void ZeroAllocDispatch(MulticastDelegateSafe<void(INT)>& multicast)
+{
+	TestClass1 testClass1;
+	StructParam param = { TEST_INT };
+	StructParam* pParam = &param;
+
+	MakeDelegate(&FreeFuncInt1)(TEST_INT);
+	MakeDelegate(&testClass1, &TestClass1::MemberFuncStructRef1)(param);
+
+	MakeDelegate(&FreeFuncInt1, testThread)(TEST_INT);
+	MakeDelegate(&FreeFuncStruct1, testThread)(param);
+	MakeDelegate(&FreeFuncStructPtr1, testThread)(&param);
+	MakeDelegate(&FreeFuncPtrPtr1, testThread)(&pParam);
+	MakeDelegate(&FreeFuncStructConstRef1, testThread)(param);
+	MakeDelegate(&testClass1, &TestClass1::MemberFuncStructRef1, testThread)(param);
+	multicast(TEST_INT);
+
+	ASSERT_TRUE(MakeDelegate(&FreeFuncIntWithReturn1, testThread, WAIT_INFINITE)(TEST_INT) == TEST_INT);
+	MakeDelegate(&FreeFuncStructPtr1, testThread, WAIT_INFINITE)(&param);
+	ASSERT_TRUE(MakeDelegate(&testClass1, &TestClass1::MemberFuncIntWithReturn1, testThread, WAIT_INFINITE)(TEST_INT) == TEST_INT);
+}
+
+void ZeroAllocationTests()
+{
+	MulticastDelegateSafe<void(INT)> multicast;
+	multicast += MakeDelegate(&FreeFuncInt1, testThread);
+	multicast += MakeDelegate(&FreeFuncInt1);
+
+	ArmZeroAllocation(256);
+	ASSERT_TRUE(IsZeroAllocationArmed());
+
+	// The first dispatch may register lanes and fill thread caches
+	ZeroAllocDispatch(multicast);
+	ZeroAllocStats before = GetZeroAllocStats();
+
+	// The counter sees a plain heap allocation
+	heapAllocations = 0;
+	heapCheck = true;
+	INT* volatile plain = new INT(TEST_INT);
+	ASSERT_TRUE(heapAllocations == 1);
+	delete plain;
+
+	heapAllocations = 0;
+	for (int i = 0; i < 100; i++)
+		ZeroAllocDispatch(multicast);
+	heapCheck = false;
+
+	ZeroAllocStats after = GetZeroAllocStats();
+	ASSERT_TRUE(heapAllocations == 0);
+	ASSERT_TRUE(after.heapFallbacks == before.heapFallbacks);
+	ASSERT_TRUE(after.poolAllocations > before.poolAllocations);
+
+	// A request larger than any pool block is reported with its type
+	void* large = DelegateAllocate(4096, "LargeType");
+	after = GetZeroAllocStats();
+	ASSERT_TRUE(after.heapFallbacks == before.heapFallbacks + 1);
+	ASSERT_TRUE(strcmp(after.lastFallbackType, "LargeType") == 0 && after.lastFallbackSize == 4096);
+	DelegateDeallocate(large);
+
+	// Blocks allocated while armed return to the pools after disarming
+	void* block = DelegateAllocate(16);
+	DisarmZeroAllocation();
+	ASSERT_TRUE(!IsZeroAllocationArmed());
+	DelegateDeallocate(block);
+	ReportHeapAllocation("Ignored", 1);
+	ASSERT_TRUE(GetZeroAllocStats().heapFallbacks == after.heapFallbacks);
+}
+
+void FlightRecorderTests()
+{
+	const int LOOP_CNT = DelegateFlightRecorder::DEFAULT_SIZE + 10;
+
+	WorkerThread recorderThread("RecorderTestThread");
+	recorderThread.CreateThread();
+	laneCallCnt = 0;
+	auto delegate = MakeDelegate(&LaneFuncInt1, recorderThread);
+	for (int i = 0; i < LOOP_CNT; i++)
+		delegate(TEST_INT);
+	MakeDelegate(&SleepFunc, recorderThread, WAIT_INFINITE)(5);
+
+	// The caller is released before the worker thread records the end of the message
+	auto entries = recorderThread.GetFlightRecorder().GetEntries();
+	for (int wait = 0; wait < 5000 && entries.back().running; wait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		entries = recorderThread.GetFlightRecorder().GetEntries();
+	}
+
+	// Only the most recent messages are kept, oldest first
+	ASSERT_TRUE(entries.size() == DelegateFlightRecorder::DEFAULT_SIZE);
+	ASSERT_TRUE(entries.front().target == DelegateTarget(&LaneFuncInt1));
+	ASSERT_TRUE(entries.back().target == DelegateTarget(&SleepFunc));
+	ASSERT_TRUE(!entries.back().running);
+	ASSERT_TRUE(entries.back().duration >= std::chrono::milliseconds(5));
+	ASSERT_TRUE(entries.back().startTime >= entries.back().enqueueTime);
+
+	FILE* file = tmpfile();
+	if (file)
+	{
+		recorderThread.GetFlightRecorder().Dump(file);
+		ASSERT_TRUE(ftell(file) > 0);
+		fclose(file);
+	}
+	recorderThread.ExitThread();
+}
+
+static std::mutex watchdogLock;
+static std::vector<WatchdogAlarm> watchdogAlarms;
+void WatchdogAlarmFunc(const WatchdogAlarm& alarm) 
+{ 
+	std::lock_guard<std::mutex> lk(watchdogLock);
+	watchdogAlarms.push_back(alarm); 
+}
+
+void WatchdogTests()
+{
+	WorkerThread watchedThread("WatchedTestThread");
+	watchedThread.CreateThread();
+
+	Watchdog watchdog(std::chrono::milliseconds(30), std::chrono::milliseconds(30), std::chrono::milliseconds(10));
+	watchdog.Triggered = MakeDelegate(&WatchdogAlarmFunc);
+	watchdog.Register(watchedThread);
+	watchdog.Start();
+
+	// A slow handler blocks the message queued behind it
+	MakeDelegate(&SleepFunc, watchedThread)(150);
+	MakeDelegate(&LaneFuncInt1, watchedThread)(TEST_INT);
+	std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+	watchdog.Stop();
+	watchdog.Unregister(watchedThread);
+	watchedThread.ExitThread();
+
+	bool slow = false, stalled = false;
+	for (auto& alarm : watchdogAlarms)
+	{
+		ASSERT_TRUE(alarm.threadName == "WatchedTestThread");
+		ASSERT_TRUE(alarm.target == DelegateTarget(&SleepFunc));
+		slow |= alarm.type == WatchdogAlarm::SLOW_HANDLER;
+		stalled |= alarm.type == WatchdogAlarm::QUEUE_STALLED && alarm.queueDepth > 0;
+	}
+	ASSERT_TRUE(slow && stalled);
+	ASSERT_TRUE(watchdog.GetSlowCallCount(&SleepFunc) == 1);
+	ASSERT_TRUE(watchdog.GetSlowCallCount(&LaneFuncInt1) == 0);
+	watchdogAlarms.clear();
+}
+
+void StatsFuncInt1(INT) { }
+
+void MulticastDelegateStatsTests()
+{
+	WorkerThread statsThread("StatsTestThread");
+	statsThread.CreateThread();
+
+	MulticastDelegateSafe<void(INT)> multicast;
+	multicast += MakeDelegate(&StatsFuncInt1);
+	multicast.SetStatsEnabled(true);
+	multicast += MakeDelegate(&SleepFunc);
+	multicast += MakeDelegate(&SleepFunc, statsThread);
+	multicast(20);
+	multicast(20);
+
+	std::vector<SubscriberStats> stats = multicast.GetStats();
+	ASSERT_TRUE(stats.size() == 3);
+	for (auto& s : stats)
+		ASSERT_TRUE(s.count == 2 && s.maxTime <= s.totalTime);
+	ASSERT_TRUE(stats[1].totalTime >= std::chrono::milliseconds(40));
+	ASSERT_TRUE(stats[1].maxTime >= std::chrono::milliseconds(20));
+	ASSERT_TRUE(stats[1].copyTime.count() == 0);
+
+	// An asynchronous call only costs the broadcast its argument copy and dispatch
+	SubscriberStats asyncStats;
+	ASSERT_TRUE(multicast.GetStats(MakeDelegate(&SleepFunc, statsThread), asyncStats));
+	ASSERT_TRUE(asyncStats.copyTime.count() > 0 && asyncStats.copyTime <= asyncStats.totalTime);
+	ASSERT_TRUE(asyncStats.totalTime < stats[1].totalTime);
+
+	multicast -= MakeDelegate(&SleepFunc, statsThread);
+	ASSERT_TRUE(!multicast.GetStats(MakeDelegate(&SleepFunc, statsThread), asyncStats));
+	ASSERT_TRUE(multicast.GetStats().size() == 2);
+
+	multicast.SetStatsEnabled(false);
+	ASSERT_TRUE(multicast.GetStats().empty());
+	multicast.Clear();
+	statsThread.ExitThread();
+}
+
+class LockFreePoolObject
+{
+	DECLARE_ALLOCATOR
+public:
+	INT val[3];
+};
+IMPLEMENT_ALLOCATOR_LOCK_FREE(LockFreePoolObject, 64, NULL)
+
+class LockFreeHeapObject
+{
+	DECLARE_ALLOCATOR
+public:
+	INT val[3];
+};
+IMPLEMENT_ALLOCATOR_LOCK_FREE(LockFreeHeapObject, 0, NULL)
+
+template <class T>
+void AllocatorLockFreeTest()
+{
+	const int THREAD_CNT = 4;
+	const int LOOP_CNT = 20000;
+
+	// Each thread holds at most 8 objects so the 64 block pool is never exhausted
+	std::vector<std::thread> threads;
+	for (int t = 0; t < THREAD_CNT; t++)
+	{
+		threads.push_back(std::thread([t]() {
+			T* objects[8];
+			for (int i = 0; i < LOOP_CNT; i++)
+			{
+				for (int o = 0; o < 8; o++)
+				{
+					objects[o] = new T();
+					objects[o]->val[0] = objects[o]->val[2] = t * LOOP_CNT + i;
+				}
+				for (int o = 0; o < 8; o++)
+				{
+					ASSERT_TRUE(objects[o]->val[0] == t * LOOP_CNT + i && objects[o]->val[2] == t * LOOP_CNT + i);
+					delete objects[o];
+				}
+			}
+		}));
+	}
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void AllocatorLockFreeTests()
+{
+	AllocatorLockFreeTest<LockFreePoolObject>();
+	AllocatorLockFreeTest<LockFreeHeapObject>();
+
+	// Heap blocks are created in chunks and reused
+	Allocator allocator(24, 0, NULL, "LockFreeTest", true);
+	ASSERT_TRUE(allocator.IsLockFree());
+	std::vector<void*> blocks;
+	for (int i = 0; i < 100; i++)
+		blocks.push_back(allocator.Allocate(24));
+	ASSERT_TRUE(allocator.GetBlocksInUse() == 100);
+	ASSERT_TRUE(allocator.GetBlockCount() == 16 + 32 + 64);
+	for (auto block : blocks)
+		allocator.Deallocate(block);
+	ASSERT_TRUE(allocator.Allocate(24) == blocks.back());
+	ASSERT_TRUE(allocator.GetBlocksInUse() == 1 && allocator.GetAllocations() == 101);
+}
+
+void AllocatorMemoryTest(Allocator& allocator, int blockCnt)
+{
+	ASSERT_TRUE(allocator.GetBlockSize() == 64);
+	std::vector<void*> blocks;
+	for (int i = 0; i < blockCnt; i++)
+	{
+		void* block = allocator.Allocate(40);
+		ASSERT_TRUE(block != NULL && ((size_t)block & 63) == 0);
+		memset(block, i, 64);
+		blocks.push_back(block);
+	}
+	for (int i = 0; i < blockCnt; i++)
+		ASSERT_TRUE(*static_cast<unsigned char*>(blocks[i]) == (unsigned char)i);
+	for (auto block : blocks)
+		allocator.Deallocate(block);
+	ASSERT_TRUE(allocator.GetBlocksInUse() == 0);
+}
+
+void AllocatorMemoryTests()
+{
+	const UINT flags = ALLOC_MMAP | ALLOC_PREFAULT | ALLOC_CACHE_ALIGN;
+
+	// Mapped, prefaulted and cache line aligned pool 
+	Allocator pool(40, 100, NULL, "MemoryPoolTest", false, flags);
+	AllocatorMemoryTest(pool, 100);
+	ASSERT_TRUE((pool.GetMemoryFlags() & flags) == flags);
+
+	// Heap blocks carved from mapped chunks
+	Allocator heap(40, 0, NULL, "MemoryHeapTest", false, flags);
+	AllocatorMemoryTest(heap, 200);
+	ASSERT_TRUE(heap.GetBlockCount() >= 200);
+	ASSERT_TRUE((heap.GetMemoryFlags() & flags) == flags);
+
+	Allocator lockFree(40, 0, NULL, "MemoryLockFreeTest", true, flags);
+	AllocatorMemoryTest(lockFree, 200);
+
+	// Huge pages and locking are best effort
+	Allocator huge(40, 100, NULL, "MemoryHugeTest", false, ALLOC_HUGE_PAGES | ALLOC_MLOCK | ALLOC_CACHE_ALIGN);
+	AllocatorMemoryTest(huge, 100);
+	ASSERT_TRUE((huge.GetMemoryFlags() & (ALLOC_MMAP | ALLOC_CACHE_ALIGN)) == (ALLOC_MMAP | ALLOC_CACHE_ALIGN));
+
+	// Options are ignored for caller provided memory
+	static CHAR memory[40 * 10];
+	Allocator external(40, 10, memory, "MemoryExternalTest", false, flags);
+	ASSERT_TRUE(external.GetBlockSize() == 40 && external.GetMemoryFlags() == 0);
+}
+
+void AllocatorTrimTests()
+{
+	// Heap blocks beyond the retained count are freed
+	Allocator heap(32, 0, NULL, "TrimHeapTest");
+	std::vector<void*> blocks;
+	for (int i = 0; i < 100; i++)
+		blocks.push_back(heap.Allocate(32));
+	for (auto block : blocks)
+		heap.Deallocate(block);
+	ASSERT_TRUE(heap.Trim(10) == 90 * 32);
+	ASSERT_TRUE(heap.GetBlockCount() == 10 && heap.GetReclaimedBytes() == 90 * 32);
+	void* block = heap.Allocate(32);
+	ASSERT_TRUE(block == blocks.back());
+	heap.Deallocate(block);
+	ASSERT_TRUE(heap.Trim(10) == 0);
+
+	// Chunks are released once every block is free. Chunk k is sized for 
+	// 16 << k blocks of 64 bytes rounded up to whole pages.
+	const size_t pageSize = Allocator::GetPageSize();
+	std::vector<size_t> chunkBytes;
+	size_t chunkedBlocks = 0;
+	for (size_t k = 0; chunkedBlocks < 200; k++)
+	{
+		size_t bytes = ((64 * ((size_t)16 << k)) + pageSize - 1) / pageSize * pageSize;
+		chunkBytes.push_back(bytes);
+		chunkedBlocks += bytes / 64;
+	}
+	size_t laterBytes = 0;
+	for (size_t k = 1; k < chunkBytes.size(); k++)
+		laterBytes += chunkBytes[k];
+
+	Allocator chunked(40, 0, NULL, "TrimChunkTest", false, ALLOC_MMAP | ALLOC_CACHE_ALIGN);
+	blocks.clear();
+	for (int i = 0; i < 200; i++)
+		blocks.push_back(chunked.Allocate(40));
+	ASSERT_TRUE(chunked.GetBlockCount() == chunkedBlocks);
+	for (size_t i = 1; i < blocks.size(); i++)
+		chunked.Deallocate(blocks[i]);
+	ASSERT_TRUE(chunked.Trim(0) == laterBytes);
+	ASSERT_TRUE(chunked.GetBlockCount() == chunkBytes[0] / 64);
+	chunked.Deallocate(blocks[0]);
+	ASSERT_TRUE(chunked.Trim((UINT)(chunkBytes[0] / 64)) == 0);
+	ASSERT_TRUE(chunked.Trim(0) == chunkBytes[0] && chunked.GetBlockCount() == 0);
+	ASSERT_TRUE(chunked.GetReclaimedBytes() == chunkBytes[0] + laterBytes);
+
+	// Storage grows again after a trim
+	block = chunked.Allocate(40);
+	ASSERT_TRUE(block != NULL && chunked.GetBlockCount() == chunkBytes[0] / 64);
+	chunked.Deallocate(block);
+
+	// Pools and lock-free allocators keep their memory
+	Allocator pool(32, 10, NULL, "TrimPoolTest");
+	pool.Deallocate(pool.Allocate(32));
+	ASSERT_TRUE(pool.Trim(0) == 0);
+	Allocator lockFree(32, 0, NULL, "TrimLockFreeTest", true);
+	lockFree.Deallocate(lockFree.Allocate(32));
+	ASSERT_TRUE(lockFree.Trim(0) == 0);
+}
+
+#ifdef USE_XALLOCATOR
+void XallocatorTests()
+{
+	const int BLOCK_CNT = 1000;
+	std::vector<void*> blocks(BLOCK_CNT);
+
+	// Blocks allocated on one thread and freed on another take the remote-free path
+	std::thread producer([&blocks]() {
+		for (int i = 0; i < BLOCK_CNT; i++)
+		{
+			blocks[i] = xmalloc(sizeof(int) * (1 + i % 64));
+			*static_cast<int*>(blocks[i]) = i;
+		}
+	});
+	producer.join();
+	for (int i = 0; i < BLOCK_CNT; i++)
+	{
+		ASSERT_TRUE(*static_cast<int*>(blocks[i]) == i);
+		xfree(blocks[i]);
+	}
+
+	// Producer and consumer running concurrently
+	std::atomic<bool> done(false);
+	SpscQueue<void*> queue;
+	std::thread consumer([&queue, &done]() {
+		void* block;
+		while (!done || !queue.Empty())
+		{
+			if (queue.Pop(block))
+			{
+				ASSERT_TRUE(*static_cast<int*>(block) == TEST_INT);
+				xfree(block);
+			}
+		}
+	});
+	for (int i = 0; i < BLOCK_CNT * 10; i++)
+	{
+		void* block = xmalloc(sizeof(int) * (1 + i % 64));
+		*static_cast<int*>(block) = TEST_INT;
+		queue.Push(block);
+	}
+	done = true;
+	consumer.join();
+
+	// Blocks freed by the allocating thread
+	for (int i = 0; i < BLOCK_CNT; i++)
+		blocks[i] = xmalloc(100);
+	blocks[0] = xrealloc(blocks[0], 1000);
+	for (int i = 0; i < BLOCK_CNT; i++)
+		xfree(blocks[i]);
+
+	// Blocks larger than the largest size class come from the heap
+	const size_t LARGE_SIZE = 65536;
+	char* large = static_cast<char*>(xmalloc(LARGE_SIZE));
+	ASSERT_TRUE(large != NULL);
+	memset(large, 'x', LARGE_SIZE);
+	large = static_cast<char*>(xrealloc(large, LARGE_SIZE * 2));
+	ASSERT_TRUE(large[0] == 'x' && large[LARGE_SIZE - 1] == 'x');
+	large = static_cast<char*>(xrealloc(large, 100));
+	ASSERT_TRUE(large[99] == 'x');
+	large = static_cast<char*>(xrealloc(large, LARGE_SIZE));
+	ASSERT_TRUE(large[0] == 'x' && large[99] == 'x');
+	xfree(large);
+
+	// Statistics account for every block of a size class
+	XallocClassStats stats[XALLOC_MAX_CLASSES];
+	INT statsCnt = xalloc_get_stats(stats, XALLOC_MAX_CLASSES);
+	ASSERT_TRUE(statsCnt == 15);
+	void* block = xmalloc(300);
+	XallocClassStats after[XALLOC_MAX_CLASSES];
+	xalloc_get_stats(after, XALLOC_MAX_CLASSES);
+	ASSERT_TRUE(after[6].blockSize == 396);
+	ASSERT_TRUE(after[6].allocations >= stats[6].allocations + 1);
+	ASSERT_TRUE(after[6].wastedBytes >= stats[6].wastedBytes + 396 - 300 - sizeof(void*));
+	ASSERT_TRUE(after[6].blocksInUse >= 1 && after[6].peakBlocksInUse >= after[6].blocksInUse + after[6].blocksCached);
+	ASSERT_TRUE(after[6].blocksCreated >= after[6].blocksInUse + after[6].blocksCached);
+	ASSERT_TRUE(after[6].exhaustions == 0);
+	xfree(block);
+
+	// Size classes are validated before being replaced
+	XallocClass defaults[XALLOC_MAX_CLASSES];
+	XallocClass classes[XALLOC_MAX_CLASSES];
+	INT defaultCnt = xalloc_get_classes(defaults, XALLOC_MAX_CLASSES);
+	INT classCnt = xalloc_get_classes(classes, XALLOC_MAX_CLASSES);
+	ASSERT_TRUE(classCnt == 15 && classes[6].blockSize == 396 && classes[14].blockSize == 32768);
+	ASSERT_TRUE(xalloc_configure(classes, 0) == FALSE);
+
+	// Block sizes must be ascending multiples of 4
+	XallocClass unaligned[] = { { 16, 0, 0 }, { 102, 0, 0 } };
+	ASSERT_TRUE(xalloc_configure(unaligned, 2) == FALSE);
+	XallocClass descending[] = { { 104, 0, 0 }, { 16, 0, 0 } };
+	ASSERT_TRUE(xalloc_configure(descending, 2) == FALSE);
+
+	// Profiled request sizes become size classes
+	xalloc_profile_start();
+	for (int i = 0; i < BLOCK_CNT; i++)
+		blocks[i] = xmalloc(i % 2 ? 40 : 100);
+	xalloc_profile_stop();
+	for (int i = 0; i < BLOCK_CNT; i++)
+		xfree(blocks[i]);
+
+	classCnt = xalloc_profile_recommend(classes, XALLOC_MAX_CLASSES);
+	ASSERT_TRUE(classCnt > 2 && classes[classCnt - 1].blockSize == 32768);
+	bool found40 = false, found100 = false;
+	for (INT i = 0; i < classCnt; i++)
+	{
+		found40 |= classes[i].blockSize == ((40 + sizeof(void*) + sizeof(void*) - 1) & ~(sizeof(void*) - 1));
+		found100 |= classes[i].blockSize == ((100 + sizeof(void*) + sizeof(void*) - 1) & ~(sizeof(void*) - 1));
+		ASSERT_TRUE(i == 0 || classes[i].blockSize > classes[i - 1].blockSize);
+	}
+	ASSERT_TRUE(found40 && found100);
+
+	// Apply the recommended classes while blocks of the current classes are still
+	// allocated, here and by other threads. The recommended classes then serve 
+	// the profiled sizes exactly.
+	void* oldBlock = xmalloc(100);
+	std::atomic<bool> configured(false);
+	void* remoteBlock = NULL;
+	std::thread holder([&configured, &remoteBlock]() {
+		remoteBlock = xmalloc(100);
+		while (!configured)
+			std::this_thread::yield();
+		xfree(remoteBlock);
+		remoteBlock = xmalloc(100);
+	});
+	ASSERT_TRUE(xalloc_configure(classes, classCnt) == TRUE);
+	configured = true;
+	XallocClass applied[XALLOC_MAX_CLASSES];
+	ASSERT_TRUE(xalloc_get_classes(applied, XALLOC_MAX_CLASSES) == classCnt);
+	for (int i = 0; i < BLOCK_CNT; i++)
+		blocks[i] = xmalloc(i % 2 ? 40 : 100);
+	INT appliedCnt = xalloc_get_stats(stats, XALLOC_MAX_CLASSES);
+	ASSERT_TRUE(appliedCnt == classCnt);
+	int fitted = 0;
+	for (INT i = 0; i < appliedCnt; i++)
+	{
+		if (stats[i].blockSize == applied[i].blockSize && stats[i].blocksInUse >= BLOCK_CNT / 2 && stats[i].wastedBytes < stats[i].allocations * sizeof(void*))
+			fitted++;
+	}
+	ASSERT_TRUE(fitted == 2);
+
+	// Blocks of the retired classes are freed as usual, on any thread
+	holder.join();
+	*static_cast<int*>(oldBlock) = TEST_INT;
+	oldBlock = xrealloc(oldBlock, 40);
+	ASSERT_TRUE(*static_cast<int*>(oldBlock) == TEST_INT);
+	xfree(oldBlock);
+	xfree(remoteBlock);
+	for (int i = 0; i < BLOCK_CNT; i++)
+		xfree(blocks[i]);
+
+	// Restore the default classes
+	ASSERT_TRUE(xalloc_configure(defaults, defaultCnt) == TRUE);
+	ASSERT_TRUE(xalloc_get_classes(applied, XALLOC_MAX_CLASSES) == defaultCnt);
+	ASSERT_TRUE(applied[6].blockSize == 396);
+
+	// Free blocks are released on request and by the background policy
+	for (int i = 0; i < BLOCK_CNT; i++)
+		blocks[i] = xmalloc(1500);
+	for (int i = 0; i < BLOCK_CNT; i++)
+		xfree(blocks[i]);
+	ASSERT_TRUE(xalloc_trim(0) > 0);
+	xalloc_get_stats(stats, XALLOC_MAX_CLASSES);
+	ASSERT_TRUE(stats[10].blockSize == 2048 && stats[10].reclaimedBytes > 0);
+	ASSERT_TRUE(stats[10].blocksCreated == stats[10].blocksInUse + stats[10].blocksCached);
+
+	unsigned long long reclaimed = stats[10].reclaimedBytes;
+	for (int i = 0; i < BLOCK_CNT; i++)
+		blocks[i] = xmalloc(1500);
+	for (int i = 0; i < BLOCK_CNT; i++)
+		xfree(blocks[i]);
+	xalloc_trim_start(0, 10);
+	for (int i = 0; i < 100 && stats[10].reclaimedBytes == reclaimed; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		xalloc_get_stats(stats, XALLOC_MAX_CLASSES);
+	}
+	xalloc_trim_stop();
+	ASSERT_TRUE(stats[10].reclaimedBytes > reclaimed);
+}
+#endif
+
+#ifdef USE_CXX17
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	std::atomic<int> allocations{ 0 };
+	std::atomic<int> deallocations{ 0 };
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		allocations++;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+		deallocations++;
+		std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+};
+
+void MemoryResourceTests()
+{
+	WorkerThread resourceThread("ResourceTestThread");
+	resourceThread.CreateThread();
+
+	// Clones, messages, argument copies and queue nodes come from the resource. 
+	// Other threads' messages may use it too, so it is never destroyed.
+	static CountingResource counting;
+	SetDelegateResource(&counting);
+	StructParam param = { TEST_INT };
+	auto asyncDelegate = MakeDelegate(&FreeFuncStructPtr1, resourceThread);
+	for (int i = 0; i < 10; i++)
+		asyncDelegate(&param);
+	auto waitDelegate = MakeDelegate(&FreeFuncStructPtr1, resourceThread, WAIT_INFINITE);
+	waitDelegate(&param);
+	ASSERT_TRUE(waitDelegate.IsSuccess());
+	ASSERT_TRUE(counting.allocations >= 11 * 3);
+
+	// Objects return to the resource they came from
+	SetDelegateResource(nullptr);
+	ASSERT_TRUE(GetDelegateResource() != &counting);
+	resourceThread.ExitThread();
+	for (int i = 0; i < 100 && counting.allocations != counting.deallocations; i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	ASSERT_TRUE(counting.allocations == counting.deallocations);
+
+	// A multicast delegate list on its own resource
+	CountingResource listCounting;
+	{
+		MulticastDelegateSafe<void(INT)> multicast(&listCounting);
+		multicast += MakeDelegate(&StatsFuncInt1);
+		multicast(1);
+		ASSERT_TRUE(listCounting.allocations == 1);
+	}
+	ASSERT_TRUE(listCounting.deallocations == 1);
+
+	// Requests fitting a block come from the Allocator
+	Allocator pool(64, 16, NULL, "ResourceTestPool");
+	AllocatorResource poolResource(pool);
+	{
+		std::pmr::vector<INT> values(&poolResource);
+		values.reserve(8);
+		ASSERT_TRUE(pool.GetBlocksInUse() == 1);
+		values.reserve(100);
+		ASSERT_TRUE(pool.GetBlocksInUse() == 0);
+	}
+
+	// Requests past the pool capacity come from the upstream resource
+	CountingResource upstream;
+	AllocatorResource overflowResource(pool, &upstream);
+	std::vector<void*> blocks;
+	for (int i = 0; i < 20; i++)
+		blocks.push_back(overflowResource.allocate(64));
+	ASSERT_TRUE(pool.GetBlocksInUse() == 16 && upstream.allocations == 4 && pool.GetExhaustions() == 0);
+	for (auto block : blocks)
+		overflowResource.deallocate(block, 64);
+	ASSERT_TRUE(pool.GetBlocksInUse() == 0 && upstream.deallocations == 4);
+
+#ifdef USE_XALLOCATOR
+	XallocatorResource xallocResource;
+	void* aligned = xallocResource.allocate(100, 64);
+	ASSERT_TRUE(((size_t)aligned & 63) == 0);
+	xallocResource.deallocate(aligned, 100, 64);
+	void* large = xallocResource.allocate(1 << 20);
+	xallocResource.deallocate(large, 1 << 20);
+#endif
+}
+#endif
+
+#ifdef USE_DELEGATE_LATENCY
+void DelegateLatencyTests()
+{
+	const int LOOP_CNT = 100;
+
+	DelegateLatency::Reset();
+	DelegateLatency::SetEnabled(true);
+
+	WorkerThread latencyThread("LatencyTestThread");
+	latencyThread.CreateThread();
+	laneCallCnt = 0;
+	auto delegate = MakeDelegate(&LaneFuncInt1, latencyThread);
+	for (int i = 0; i < LOOP_CNT; i++)
+		delegate(TEST_INT);
+	latencyThread.ExitThread();
+	DelegateLatency::SetEnabled(false);
+	ASSERT_TRUE(laneCallCnt == LOOP_CNT);
+
+	DelegateLatency::Stats stats;
+	ASSERT_TRUE(DelegateLatency::GetStats(&LaneFuncInt1, stats));
+	ASSERT_TRUE(stats.total.count == LOOP_CNT);
+	ASSERT_TRUE(stats.total.p50 <= stats.total.p99 && stats.total.p99 <= stats.total.p999);
+	ASSERT_TRUE(stats.total.p999 <= stats.total.max);
+	ASSERT_TRUE(stats.execute.max <= stats.total.max && stats.queued.max <= stats.total.max);
+	ASSERT_TRUE(!DelegateLatency::GetStats(&SleepFunc, stats));
+
+	bool found = false;
+	for (auto& threadStats : DelegateLatency::GetThreadStats())
+		found |= threadStats.threadName == "LatencyTestThread" && threadStats.total.count == LOOP_CNT;
+	ASSERT_TRUE(found);
+}
+#endif
+
+#ifdef USE_DELEGATE_TRACE
+// Count the threads with a trace buffer
+static size_t CountTraceThreads()
+{
+	std::stringstream trace;
+	DelegateTrace::WriteChromeTrace(trace);
+	std::string json = trace.str();
+	size_t count = 0;
+	for (size_t pos = json.find("\"thread_name\""); pos != std::string::npos; pos = json.find("\"thread_name\"", pos + 1))
+		count++;
+	return count;
+}
+
+void DelegateTraceTests()
+{
+	DelegateTrace::Clear();
+	DelegateTrace::SetEnabled(true);
+
+	WorkerThread traceThread("TraceTestThread");
+	traceThread.CreateThread();
+	MakeDelegate(&LaneFuncInt1, traceThread)(TEST_INT);
+	MakeDelegate(&LaneFuncInt1, traceThread, WAIT_INFINITE)(TEST_INT);
+	traceThread.ExitThread();
+	DelegateTrace::SetEnabled(false);
+
+	std::stringstream trace;
+	DelegateTrace::WriteChromeTrace(trace);
+	std::string json = trace.str();
+	ASSERT_TRUE(json.find("\"traceEvents\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"TraceTestThread\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"ph\":\"s\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"ph\":\"f\"") != std::string::npos);
+	ASSERT_TRUE(json.find("AsyncWait ") != std::string::npos);
+	ASSERT_TRUE(json.find(DelegateTarget(&LaneFuncInt1).ToString()) != std::string::npos);
+
+	// Threads that exit give their buffer to the next thread instead of adding one
+	DelegateTrace::SetEnabled(true);
+	std::thread([]() { DelegateTrace::Enqueue(DelegateTarget()); }).join();
+	size_t buffers = CountTraceThreads();
+	for (int i = 0; i < 10; i++)
+		std::thread([]() { DelegateTrace::Enqueue(DelegateTarget()); }).join();
+	DelegateTrace::SetEnabled(false);
+	ASSERT_TRUE(CountTraceThreads() == buffers);
+
+	// Clear() drops the recorded events even if the owner thread is gone
+	DelegateTrace::Clear();
+	trace.str("");
+	DelegateTrace::WriteChromeTrace(trace);
+	ASSERT_TRUE(trace.str().find(DelegateTarget(&LaneFuncInt1).ToString()) == std::string::npos);
+
+	// Writing the trace while a thread wraps its ring buffer skips torn slots
+	DelegateTrace::SetEnabled(true);
+	std::atomic<bool> stop(false);
+	std::thread recorder([&stop]() {
+		while (!stop)
+		{
+			DelegateTrace::Enqueue(DelegateTarget(&LaneFuncInt1));
+			DelegateTrace::Enqueue(DelegateTarget());
+		}
+	});
+	for (int i = 0; i < 20; i++)
+	{
+		std::stringstream dump;
+		DelegateTrace::WriteChromeTrace(dump);
+		ASSERT_TRUE(dump.str().find("\n]}") != std::string::npos);
+	}
+	stop = true;
+	recorder.join();
+	DelegateTrace::SetEnabled(false);
+	DelegateTrace::Clear();
+}
+#endif
+#endif
+
 void DelegateUnitTests()
 {
 	testThread.CreateThread();
@@ -2567,7 +4159,36 @@ void DelegateUnitTests()
 		DelegateMemberAsyncWaitTests();
 		DelegateMemberSpTests();
 		DelegateMemberAsyncSpTests();
+		DelegateConnectionTests();
 	}
+	RemoteDelegateTests();
+
+#if USE_STD_THREADS
+	WorkerThreadLaneTests();
+	WorkerThreadWaitStrategyTests();
+	WorkerThreadExitTests();
+	WorkerThreadStatsTests();
+	WorkerThreadArenaTests();
+	FlightRecorderTests();
+	WatchdogTests();
+	MulticastDelegateStatsTests();
+	AllocatorLockFreeTests();
+	AllocatorMemoryTests();
+	AllocatorTrimTests();
+	ZeroAllocationTests();
+#ifdef USE_XALLOCATOR
+	XallocatorTests();
+#endif
+#ifdef USE_CXX17
+	MemoryResourceTests();
+#endif
+#ifdef USE_DELEGATE_LATENCY
+	DelegateLatencyTests();
+#endif
+#ifdef USE_DELEGATE_TRACE
+	DelegateTraceTests();
+#endif
+#endif
 
 #ifdef WIN32
 	QueryPerformanceCounter(&EndingTime);
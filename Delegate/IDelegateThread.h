@@ -20,8 +20,15 @@ public:
 	/// @param[in] msg - a pointer to the callback message that must be created dynamically
 	///		using operator new. 
 	/// @pre Caller *must* create the DelegateMsg argument dynamically using operator new.
-	/// @post The destination thread must delete the msg instance by calling DelegateInvoke().
+	/// @post The destination thread must delete the msg instance by calling DelegateInvoke(),
+	///		or DelegateDiscard() if the message is dropped without being invoked.
 	virtual void DispatchDelegate(std::shared_ptr<DelegateLib::DelegateMsgBase> msg) = 0;
+
+	/// Check if the caller is executing on this thread of control. Used by the
+	/// DelegateConnection::AUTO policy to skip the message queue.
+	/// @return true if the calling thread is this thread. Ports that do not 
+	///		override this function always queue. 
+	virtual bool IsCurrentThread() { return false; }
 };
 
 }
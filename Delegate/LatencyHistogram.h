@@ -0,0 +1,158 @@
+#ifndef _LATENCY_HISTOGRAM_H
+#define _LATENCY_HISTOGRAM_H
+
+// LatencyHistogram.h
+// @see https://github.com/endurodave/AsyncMulticastDelegateCpp11
+
+#include <atomic>
+#include <cstddef>
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace DelegateLib {
+
+/// @brief A fixed size log-linear histogram in the style of HdrHistogram. Each
+/// power-of-two range of values is divided into SUB_BUCKET_CNT linear buckets, so
+/// a reported percentile is within 1/SUB_BUCKET_CNT (about 6%) of the true value
+/// over the full 64-bit range. Values are typically latencies in nanoseconds.
+///
+/// @details Record() is lock-free and may be called concurrently from any thread.
+/// Readers see a consistent enough view for monitoring; a percentile computed
+/// while values are being recorded may be off by the in-flight samples.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram() { Reset(); }
+
+	/// Add a sample to the histogram.
+	/// @param[in] value - the sample value, e.g. latency in nanoseconds.
+	void Record(unsigned long long value) {
+		m_buckets[GetIndex(value)].fetch_add(1, std::memory_order_relaxed);
+		m_count.fetch_add(1, std::memory_order_relaxed);
+		m_sum.fetch_add(value, std::memory_order_relaxed);
+
+		unsigned long long max = m_max.load(std::memory_order_relaxed);
+		while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+			;
+	}
+
+	/// Get the number of samples recorded.
+	unsigned long long GetCount() const { return m_count.load(std::memory_order_relaxed); }
+
+	/// Get the largest sample recorded.
+	unsigned long long GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+	/// Get the mean of all samples recorded.
+	unsigned long long GetMean() const {
+		unsigned long long count = GetCount();
+		return count ? m_sum.load(std::memory_order_relaxed) / count : 0;
+	}
+
+	/// Get the value at or below which the given percentage of samples fall.
+	/// @param[in] percentile - percentile from 0.0 to 100.0, e.g. 99.9.
+	/// @return The highest value equivalent to the percentile bucket, or 0 if empty.
+	unsigned long long GetPercentile(double percentile) const {
+		unsigned long long count = 0;
+		for (size_t i = 0; i < BUCKET_CNT; i++)
+			count += m_buckets[i].load(std::memory_order_relaxed);
+		if (count == 0)
+			return 0;
+
+		unsigned long long target = (unsigned long long)(percentile / 100.0 * count + 0.5);
+		if (target == 0)
+			target = 1;
+
+		unsigned long long seen = 0;
+		for (size_t i = 0; i < BUCKET_CNT; i++)
+		{
+			seen += m_buckets[i].load(std::memory_order_relaxed);
+			if (seen >= target)
+			{
+				unsigned long long value = GetHighestValue(i);
+				unsigned long long max = GetMax();
+				return value < max ? value : max;
+			}
+		}
+		return GetMax();
+	}
+
+	/// Add all samples from another histogram into this one.
+	/// @param[in] other - the histogram to merge.
+	void Merge(const LatencyHistogram& other) {
+		for (size_t i = 0; i < BUCKET_CNT; i++)
+			m_buckets[i].fetch_add(other.m_buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		m_count.fetch_add(other.GetCount(), std::memory_order_relaxed);
+		m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		unsigned long long value = other.GetMax();
+		unsigned long long max = m_max.load(std::memory_order_relaxed);
+		while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+			;
+	}
+
+	/// Remove all samples.
+	void Reset() {
+		for (size_t i = 0; i < BUCKET_CNT; i++)
+			m_buckets[i].store(0, std::memory_order_relaxed);
+		m_count.store(0, std::memory_order_relaxed);
+		m_sum.store(0, std::memory_order_relaxed);
+		m_max.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	// Prevent copying objects
+	LatencyHistogram(const LatencyHistogram&) = delete;
+	LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+	enum
+	{
+		SUB_BUCKET_BITS = 4,
+		SUB_BUCKET_CNT = 1 << SUB_BUCKET_BITS,
+		BUCKET_CNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_CNT
+	};
+
+	/// Get the index of the most significant set bit.
+	static unsigned int MostSignificantBit(unsigned long long value) {
+#if defined(__GNUC__)
+		return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_WIN64)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return index;
+#else
+		unsigned int msb = 0;
+		while (value >>= 1)
+			msb++;
+		return msb;
+#endif
+	}
+
+	/// Get the bucket index for a value. Values below SUB_BUCKET_CNT map one to one.
+	static size_t GetIndex(unsigned long long value) {
+		if (value < SUB_BUCKET_CNT)
+			return (size_t)value;
+		unsigned int shift = MostSignificantBit(value) - SUB_BUCKET_BITS;
+		size_t subBucket = (size_t)(value >> shift) & (SUB_BUCKET_CNT - 1);
+		return (shift + 1) * SUB_BUCKET_CNT + subBucket;
+	}
+
+	/// Get the highest value that maps to a bucket index.
+	static unsigned long long GetHighestValue(size_t index) {
+		if (index < SUB_BUCKET_CNT)
+			return index;
+		unsigned int shift = (unsigned int)(index / SUB_BUCKET_CNT - 1);
+		unsigned long long subBucket = index % SUB_BUCKET_CNT;
+		unsigned long long lowest = (SUB_BUCKET_CNT + subBucket) << shift;
+		return lowest + ((1ULL << shift) - 1);
+	}
+
+	std::atomic<unsigned long long> m_buckets[BUCKET_CNT];
+	std::atomic<unsigned long long> m_count;
+	std::atomic<unsigned long long> m_sum;
+	std::atomic<unsigned long long> m_max;
+};
+
+}
+
+#endif
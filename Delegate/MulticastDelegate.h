@@ -2,42 +2,72 @@
 #define _MULTICAST_DELEGATE_H
 
 #include "Delegate.h"
+#include "DelegateCopyTimer.h"
 #include <list>
+#include <vector>
+#include <chrono>
 #include <algorithm>
 
 namespace DelegateLib {
 
+/// @brief Timing of one registered delegate collected by MulticastDelegate when 
+/// subscriber statistics are enabled. 
+struct SubscriberStats
+{
+    unsigned long long count = 0;               ///< Number of invocations
+    std::chrono::nanoseconds totalTime{ 0 };    ///< Cumulative time in the delegate call
+    std::chrono::nanoseconds maxTime{ 0 };      ///< Longest single delegate call
+    std::chrono::nanoseconds copyTime{ 0 };     ///< Cumulative argument copy time of asynchronous targets, included in totalTime
+};
+
 template <class R>
 struct MulticastDelegate; // Not defined
 
 /// @brief Not thread-safe multicast delegate container class. The class has a linked  
 /// list of Delegate<> instances. When invoked, each Delegate instance within the invocation 
 /// list is called. MulticastDelegate<> does not support return values. A void return  
-/// must always be used.
+/// must always be used. The list is allocated with DelegateAllocate(), or with 
+/// USE_CXX17 from a memory resource.
 template<class RetType, class... Args>
 class MulticastDelegate<RetType(Args...)>
 {
 public:
-    MulticastDelegate() = default;
+    MulticastDelegate() : m_delegates(GetContainerAllocator()), m_stats(GetContainerAllocator()) {}
+#ifdef USE_CXX17
+    /// Constructor
+    /// @param[in] resource - the memory resource the list is allocated from. Registered 
+    ///     delegate clones come from GetDelegateResource().
+    explicit MulticastDelegate(std::pmr::memory_resource* resource) : m_delegates(resource), m_stats(resource) {}
+#endif
     ~MulticastDelegate() { Clear(); }
 
     RetType operator()(Args... args) {
+        if (m_statsEnabled)
+            return InvokeTimed(args...);
+
         for (Delegate<RetType(Args...)>* delegate : m_delegates)
             (*delegate)(args...);	// Invoke delegate callback
     }
 
     void operator+=(const Delegate<RetType(Args...)>& delegate) {
         m_delegates.push_back(delegate.Clone());
+        if (m_statsEnabled)
+            m_stats.push_back(SubscriberStats());
     }
     void operator-=(const Delegate<RetType(Args...)>& delegate) {
+        auto stats = m_stats.begin();
         for (auto it = m_delegates.begin(); it != m_delegates.end(); ++it)
         {
             if (*((DelegateBase*)&delegate) == *((DelegateBase*)(*it)))
             {
                 delete (*it);
                 m_delegates.erase(it);
+                if (m_statsEnabled)
+                    m_stats.erase(stats);
                 break;
             }
+            if (m_statsEnabled)
+                ++stats;
         }
     }
 
@@ -52,17 +82,72 @@ public:
             delete (*it);
             it = m_delegates.erase(it);
         }
+        m_stats.clear();
     }
 
     explicit operator bool() const { return !Empty(); }
 
+    /// Switch per-subscriber timing on or off. Disabled by default. Switching 
+    /// on starts all registered delegates from zero.
+    void SetStatsEnabled(bool enabled) {
+        m_statsEnabled = enabled;
+        m_stats.clear();
+        if (enabled)
+            m_stats.resize(m_delegates.size());
+    }
+
+    /// Get the timing of every registered delegate in invocation order. Empty if
+    /// statistics are disabled.
+    std::vector<SubscriberStats> GetStats() const {
+        return std::vector<SubscriberStats>(m_stats.begin(), m_stats.end());
+    }
+
+    /// Get the timing of a registered delegate.
+    /// @param[in] delegate - a delegate equal to the registered one.
+    /// @param[out] stats - the delegate timing.
+    /// @return true if statistics are enabled and the delegate is registered.
+    bool GetStats(const Delegate<RetType(Args...)>& delegate, SubscriberStats& stats) const {
+        auto s = m_stats.begin();
+        for (auto it = m_delegates.begin(); it != m_delegates.end() && s != m_stats.end(); ++it, ++s)
+        {
+            if (*((DelegateBase*)&delegate) == *((DelegateBase*)(*it)))
+            {
+                stats = *s;
+                return true;
+            }
+        }
+        return false;
+    }
+
 private:
     // Prevent copying objects
     MulticastDelegate(const MulticastDelegate&) = delete;
     MulticastDelegate& operator=(const MulticastDelegate&) = delete;
 
+    /// Invoke each delegate and time it
+    RetType InvokeTimed(Args... args) {
+        auto stats = m_stats.begin();
+        for (Delegate<RetType(Args...)>* delegate : m_delegates)
+        {
+            DelegateCopyTimer copyTimer;
+            auto start = std::chrono::steady_clock::now();
+            (*delegate)(args...);	// Invoke delegate callback
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            stats->count++;
+            stats->totalTime += elapsed;
+            stats->maxTime = (std::max)(stats->maxTime, elapsed);
+            stats->copyTime += copyTimer.GetCopyTime();
+            ++stats;
+        }
+    }
+
     /// List of registered delegates
-    std::list<Delegate<RetType(Args...)>*> m_delegates;
+    DelegateList<Delegate<RetType(Args...)>*> m_delegates;
+
+    /// Timing of each registered delegate, in m_delegates order, when enabled
+    DelegateList<SubscriberStats> m_stats;
+    bool m_statsEnabled = false;
 };
 
 }
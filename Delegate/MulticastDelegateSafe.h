@@ -15,6 +15,12 @@ class MulticastDelegateSafe<RetType(Args...)> : public MulticastDelegate<RetType
 {
 public:
     MulticastDelegateSafe() = default;
+#ifdef USE_CXX17
+    /// Constructor
+    /// @param[in] resource - the memory resource the list is allocated from.
+    explicit MulticastDelegateSafe(std::pmr::memory_resource* resource) : 
+        MulticastDelegate<RetType(Args...)>(resource) {}
+#endif
     ~MulticastDelegateSafe() = default;
 
     void operator+=(const Delegate<RetType(Args...)>& delegate) {
@@ -43,6 +49,19 @@ public:
         return MulticastDelegate<RetType(Args...)>::operator bool();
     }
 
+    void SetStatsEnabled(bool enabled) {
+        const std::lock_guard<std::mutex> lock(m_lock);
+        MulticastDelegate<RetType(Args...)>::SetStatsEnabled(enabled);
+    }
+    std::vector<SubscriberStats> GetStats() {
+        const std::lock_guard<std::mutex> lock(m_lock);
+        return MulticastDelegate<RetType(Args...)>::GetStats();
+    }
+    bool GetStats(const Delegate<RetType(Args...)>& delegate, SubscriberStats& stats) {
+        const std::lock_guard<std::mutex> lock(m_lock);
+        return MulticastDelegate<RetType(Args...)>::GetStats(delegate, stats);
+    }
+
 private:
     // Prevent copying objects
     MulticastDelegateSafe(const MulticastDelegateSafe&) = delete;
@@ -2,15 +2,18 @@
 #include "xallocator.h"
 #include "Fault.h"
 #include <cstring>
+#include <cstddef>
 #include <iostream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <new>
 
 using namespace std;
 
-#ifndef CHAR_BIT
-#define CHAR_BIT	8 
-#endif
-
 static BOOL _xallocInitialized = FALSE;
 
 // Define STATIC_POOLS to switch from heap blocks mode to static pools mode
@@ -35,14 +38,148 @@ static BOOL _xallocInitialized = FALSE;
 	CHAR* _allocator2048 [sizeof(AllocatorPool<CHAR[2048], MAX_BLOCKS>)];	
 	CHAR* _allocator4096 [sizeof(AllocatorPool<CHAR[4096], MAX_BLOCKS>)];
 
-	// Array of pointers to all allocator instances
-	static Allocator* _allocators[MAX_ALLOCATORS];
-
+	#define MAX_BLOCK_SIZE	4096
 #else
-	#define MAX_ALLOCATORS  15
-	static Allocator* _allocators[MAX_ALLOCATORS];
+	#define MAX_ALLOCATORS  XALLOC_MAX_CLASSES
+
+	// Default size classes, replaceable with xalloc_configure(). Most blocks are powers
+	// of two, however some common allocator block sizes can be explicitly defined to 
+	// minimize wasted storage. This offers application specific tuning. Block sizes 
+	// include the block header.
+	static const XallocClass _defaultClasses[] = 
+	{
+		{ 8, 0, 0 }, { 16, 0, 0 }, { 32, 0, 0 }, { 64, 0, 0 }, { 128, 0, 0 }, { 256, 0, 0 }, { 396, 0, 0 }, 
+		{ 512, 0, 0 }, { 768, 0, 0 }, { 1024, 0, 0 }, { 2048, 0, 0 }, { 4096, 0, 0 }, { 8192, 0, 0 }, 
+		{ 16384, 0, 0 }, { 32768, 0, 0 }
+	};
+
+	// Size classes passed to xalloc_configure() before xalloc_init(). Guarded by get_mutex().
+	static XallocClass _pendingClasses[MAX_ALLOCATORS];
+	static INT _pendingCnt = 0;
 #endif	// STATIC_POOLS
 
+// Size classes are looked up in a table with one entry per 1 << SIZE_CLASS_SHIFT bytes
+#define SIZE_CLASS_SHIFT	2
+
+// Histogram of xmalloc() request block sizes recorded by xalloc_profile_start(). 
+// Bucket i counts requests with a block size in ((i - 1) << SIZE_CLASS_SHIFT, 
+// i << SIZE_CLASS_SHIFT]. Profiles are never deleted since a thread may still be
+// recording into one after profiling stops. 
+struct Profile
+{
+	size_t buckets;
+	std::atomic<unsigned long long>* counts;
+};
+static std::atomic<Profile*> _profile(NULL);	// Set while recording
+static Profile* _lastProfile = NULL;			// Guarded by get_mutex()
+
+// Each thread keeps a magazine of free blocks per size class so most xmalloc() and
+// xfree() calls take no lock. A block records the cache it was allocated from. A
+// block freed by the allocating thread returns to its magazine. A block freed by 
+// another thread is pushed lock-free onto the owner's remote-free list, which the 
+// owner reclaims in one batch when its magazine runs empty. The global lock is 
+// only taken to move MAGAZINE_BATCH blocks at a time between a magazine and its 
+// allocator. When a thread exits its caches are flushed and recycled for the next 
+// new thread. Blocks held in magazines count as in use by the allocator. 
+// STATIC_POOLS disables thread caches since blocks held by one thread could 
+// exhaust an exactly sized pool needed by another.
+#define MAGAZINE_SIZE	32
+#define MAGAZINE_BATCH	(MAGAZINE_SIZE / 2)
+
+struct ThreadCache;
+struct SizeClassSet;
+
+// A free raw block on a remote-free list
+struct FreeBlock
+{
+	FreeBlock* pNext;
+};
+
+// One thread's cache of a single size class
+struct ClassCache
+{
+	std::atomic<Allocator*> allocator;	// The size class allocator or NULL when destroyed
+	std::atomic<FreeBlock*> remoteFree;	// Blocks freed by other threads
+	std::atomic<bool> owned;			// False once the thread exits; frees go to the allocator
+	ThreadCache* thread;				// The owning cache or NULL if shared
+	void* magazine[MAGAZINE_SIZE];		// Owning thread only
+	INT count;							// Owning thread only
+
+	// Client statistics summed by xalloc_get_stats()
+	std::atomic<unsigned long long> allocations;
+	std::atomic<unsigned long long> deallocations;
+	std::atomic<unsigned long long> wastedBytes;
+};
+
+// All size class caches of one thread
+struct ThreadCache
+{
+	ClassCache classes[MAX_ALLOCATORS];
+	SizeClassSet* set;					// The size classes the caches are bound to
+	ThreadCache* pNextAll;				// List of every cache created
+	ThreadCache* pNextFree;				// List of caches released by exited threads
+};
+
+// Blocks larger than the largest size class are allocated from the heap with an
+// OversizeHeader in front. The cache field holds OVERSIZE_CACHE so xfree() 
+// returns them to the heap.
+struct OversizeHeader
+{
+	size_t size;						// The client's requested size
+	ClassCache* cache;					// Always OVERSIZE_CACHE
+};
+static char _oversizeMarker;
+#define OVERSIZE_CACHE	((ClassCache*)&_oversizeMarker)
+
+// One configuration of size classes. xalloc_configure() retires the current set
+// instead of destroying it since blocks and thread caches still refer to it. 
+// Each thread moves to the new set on its next xmalloc(), and blocks of a 
+// retired set return to its allocators as they are freed. xalloc_destroy() 
+// destroys the allocators and lookup tables of every set. 
+struct SizeClassSet
+{
+	Allocator* allocators[MAX_ALLOCATORS];
+	XallocClass classes[MAX_ALLOCATORS];
+	INT count;
+	size_t maxBlockSize;
+
+	// Size class lookup table. Entry i holds the index of the smallest size 
+	// class with a block of at least i << SIZE_CLASS_SHIFT bytes. 
+	UINT8* sizeClasses;
+
+	// Caches used by threads without a thread cache. Never owned, so every
+	// allocation and free goes to the allocator under the lock.
+	ClassCache sharedCaches[MAX_ALLOCATORS];
+
+	SizeClassSet* pRetired;				// The set this one replaced
+};
+
+// The current size classes. Read without the lock, replaced under the lock.
+static std::atomic<SizeClassSet*> _classSet(NULL);
+
+#ifdef STATIC_POOLS
+	static UINT8 _sizeClassTable[(MAX_BLOCK_SIZE >> SIZE_CLASS_SHIFT) + 1];
+	static SizeClassSet _staticClassSet;
+#endif
+
+// Guarded by get_mutex()
+static ThreadCache* _allThreadCaches = NULL;
+static ThreadCache* _freeThreadCaches = NULL;
+
+// The calling thread's cache, created on first use
+static thread_local ThreadCache* _threadCache = NULL;
+static thread_local BOOL _threadCacheReleased = FALSE;
+
+static void release_thread_cache();
+
+// Releases the thread cache when the thread exits
+class ThreadCacheRelease
+{
+public:
+	~ThreadCacheRelease() { release_thread_cache(); }
+};
+static thread_local ThreadCacheRelease _threadCacheRelease;
+
 // For C++ applications, must define AUTOMATIC_XALLOCATOR_INIT_DESTROY to 
 // correctly ensure allocators are initialized before any static user C++ 
 // construtor/destructor executes which might call into the xallocator API. 
@@ -73,56 +210,61 @@ XallocInitDestroy::~XallocInitDestroy()
 }
 #endif	// AUTOMATIC_XALLOCATOR_INIT_DESTROY
 
-/// Returns the next higher powers of two. For instance, pass in 12 and 
-/// the value returned would be 16. 
-/// @param[in] k - numeric value to compute the next higher power of two.
-/// @return	The next higher power of two based on the input k. 
-template <class T>
-T nexthigher(T k) 
-{
-    k--;
-    for (size_t i=1; i<sizeof(T)*CHAR_BIT; i<<=1)
-        k |= (k >> i);
-    return k+1;
-}
-
 static std::mutex& get_mutex()
 {
 	static std::mutex _mutex;
 	return _mutex;
 }
 
-// Stored a pointer to the allocator instance within the block region. 
+// Background trim policy started by xalloc_trim_start(). Guarded by mutex 
+// and never destroyed so a trim thread can be stopped from a static destructor.
+struct TrimPolicy
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::thread* thread;
+	BOOL exit;
+	UINT retainBlocks;
+	std::chrono::milliseconds period;
+};
+
+static TrimPolicy& get_trim_policy()
+{
+	static TrimPolicy* _trimPolicy = new TrimPolicy();
+	return *_trimPolicy;
+}
+
+// Stored a pointer to the owning cache instance within the block region. 
 ///	a pointer to the client's area within the block.
 /// @param[in] block - a pointer to the raw memory block. 
-///	@param[in] size - the client requested size of the memory block.
+///	@param[in] cache - the cache the block was allocated from.
 /// @return	A pointer to the client's address within the raw memory block. 
-static inline void *set_block_allocator(void* block, Allocator* allocator)
+static inline void *set_block_cache(void* block, ClassCache* cache)
 {
-	// Cast the raw block memory to a Allocator pointer
-	Allocator** pAllocatorInBlock = static_cast<Allocator**>(block);
+	// Cast the raw block memory to a ClassCache pointer
+	ClassCache** pCacheInBlock = static_cast<ClassCache**>(block);
 
-	// Write the size into the memory block
-	*pAllocatorInBlock = allocator;
+	// Write the cache into the memory block
+	*pCacheInBlock = cache;
 
-	// Advance the pointer past the Allocator* block size and return a pointer to
+	// Advance the pointer past the ClassCache* and return a pointer to
 	// the client's memory region
-	return ++pAllocatorInBlock;
+	return ++pCacheInBlock;
 }
 
-/// Gets the size of the memory block stored within the block.
+/// Gets the owning cache stored within the block.
 /// @param[in] block - a pointer to the client's memory block. 
-/// @return	The original allocator instance stored in the memory block.
-static inline Allocator* get_block_allocator(void* block)
+/// @return	The cache instance stored in the memory block.
+static inline ClassCache* get_block_cache(void* block)
 {
-	// Cast the client memory to a Allocator pointer
-	Allocator** pAllocatorInBlock = static_cast<Allocator**>(block);
+	// Cast the client memory to a ClassCache pointer
+	ClassCache** pCacheInBlock = static_cast<ClassCache**>(block);
 
-	// Back up one Allocator* position to get the stored allocator instance
-	pAllocatorInBlock--;
+	// Back up one ClassCache* position to get the stored cache instance
+	pCacheInBlock--;
 
-	// Return the allocator instance stored within the memory block
-	return *pAllocatorInBlock;
+	// Return the cache instance stored within the memory block
+	return *pCacheInBlock;
 }
 
 /// Returns the raw memory block pointer given a client memory pointer. 
@@ -130,45 +272,191 @@ static inline Allocator* get_block_allocator(void* block)
 /// @return	A pointer to the original raw memory block address. 
 static inline void *get_block_ptr(void* block)
 {
-	// Cast the client memory to a Allocator* pointer
-	Allocator** pAllocatorInBlock = static_cast<Allocator**>(block);
+	// Cast the client memory to a ClassCache* pointer
+	ClassCache** pCacheInBlock = static_cast<ClassCache**>(block);
 
-	// Back up one Allocator* position and return the original raw memory block pointer
-	return --pAllocatorInBlock;
+	// Back up one ClassCache* position and return the original raw memory block pointer
+	return --pCacheInBlock;
 }
 
-/// Returns an allocator instance matching the size provided
-/// @param[in] size - allocator block size
-/// @return Allocator instance handling requested block size or NULL
-/// if no allocator exists. 
-static inline Allocator* find_allocator(size_t size)
+/// Build the size class lookup table from the allocators. Called with the lock held.
+/// @param[in] set - the size classes.
+static void build_size_classes(SizeClassSet* set)
+{
+	set->maxBlockSize = set->allocators[set->count - 1]->GetBlockSize();
+	size_t entries = (set->maxBlockSize >> SIZE_CLASS_SHIFT) + 1;
+#ifndef STATIC_POOLS
+	set->sizeClasses = new UINT8[entries];
+#endif
+
+	INT index = 0;
+	for (size_t i=0; i<entries; i++)
+	{
+		while (set->allocators[index]->GetBlockSize() < (i << SIZE_CLASS_SHIFT))
+			index++;
+		set->sizeClasses[i] = (UINT8)index;
+	}
+}
+
+/// Point the shared caches at the allocators. Called with the lock held.
+/// @param[in] set - the size classes.
+static void bind_shared_caches(SizeClassSet* set)
 {
 	for (INT i=0; i<MAX_ALLOCATORS; i++)
+		set->sharedCaches[i].allocator = i < set->count ? set->allocators[i] : NULL;
+}
+
+#ifndef STATIC_POOLS
+/// Create an allocator for each size class. Called with the lock held.
+/// @param[in] classes - the size classes in ascending block size order.
+/// @param[in] count - the number of size classes.
+/// @return The new size classes, ready to become current.
+static SizeClassSet* create_class_set(const XallocClass* classes, INT count)
+{
+	SizeClassSet* set = new SizeClassSet();
+	for (INT i=0; i<count; i++)
 	{
-		if (_allocators[i] == 0)
-			break;
-		
-		if (_allocators[i]->GetBlockSize() == size)
-			return _allocators[i];
+		set->classes[i] = classes[i];
+		set->allocators[i] = new Allocator(classes[i].blockSize, classes[i].blocks, 0, "xallocator", false, classes[i].flags);
 	}
-	
-	return NULL;
+	set->count = count;
+
+	build_size_classes(set);
+	bind_shared_caches(set);
+	return set;
+}
+#endif
+
+/// Get the size class handling the client's requested size in constant time.
+/// @param[in] set - the size classes.
+/// @param[in] size - the client's requested block size.
+/// @return The size class index into the set's allocators.
+static inline INT get_size_class(const SizeClassSet* set, size_t size)
+{
+	// Add sizeof(ClassCache*) to the requested block size to hold the owning
+	// cache within the block memory region. 
+	size_t blockSize = size + sizeof(ClassCache*);
+	ASSERT_TRUE(blockSize <= set->maxBlockSize);
+	return set->sizeClasses[(blockSize + (1 << SIZE_CLASS_SHIFT) - 1) >> SIZE_CLASS_SHIFT];
+}
+
+/// Get the largest block size of the current size classes. Called with the lock held.
+/// @return The largest block size, or 0 if not initialized.
+static size_t get_max_block_size()
+{
+	SizeClassSet* set = _classSet.load();
+	return set ? set->maxBlockSize : 0;
 }
 
-/// Insert an allocator instance into the array
-/// @param[in] allocator - An allocator instance
-static inline void insert_allocator(Allocator* allocator)
+/// Return every block held by a cache to its allocator. Called with the lock held.
+/// @param[in] cache - the cache to flush.
+/// @param[in] magazine - TRUE to flush the magazine too. Only when the owning 
+///		thread has exited or is the caller.
+static void flush_class_cache(ClassCache* cache, BOOL magazine)
 {
+	Allocator* allocator = cache->allocator.load();
+	FreeBlock* pBlock = cache->remoteFree.exchange(NULL);
+	while (pBlock)
+	{
+		FreeBlock* pNext = pBlock->pNext;
+		if (allocator)
+			allocator->Deallocate(pBlock);
+		pBlock = pNext;
+	}
+
+	if (magazine)
+	{
+		while (cache->count > 0)
+		{
+			void* pMemory = cache->magazine[--cache->count];
+			if (allocator)
+				allocator->Deallocate(pMemory);
+		}
+	}
+}
+
+/// Flush a thread cache no longer used by its thread and recycle it if its size
+/// classes are current. Called with the lock held.
+/// @param[in] threadCache - the cache to recycle.
+static void recycle_thread_cache(ThreadCache* threadCache)
+{
+	// Mark unowned before flushing. A thread freeing concurrently either 
+	// pushed before the flush or sees the cache unowned and flushes itself.
 	for (INT i=0; i<MAX_ALLOCATORS; i++)
 	{
-		if (_allocators[i] == 0)
+		threadCache->classes[i].owned = false;
+		flush_class_cache(&threadCache->classes[i], TRUE);
+	}
+
+	// A cache of retired size classes is kept only for its blocks to find
+	if (threadCache->set == _classSet.load())
+	{
+		threadCache->pNextFree = _freeThreadCaches;
+		_freeThreadCaches = threadCache;
+	}
+}
+
+/// Get the calling thread's cache, creating or recycling one on first use or
+/// once the size classes are replaced.
+/// @return The thread cache or NULL if thread caches are unavailable.
+static ThreadCache* get_thread_cache()
+{
+#ifdef STATIC_POOLS
+	return NULL;
+#else
+	if (_threadCacheReleased)
+		return NULL;
+	if (_threadCache && _threadCache->set == _classSet.load(std::memory_order_acquire))
+		return _threadCache;
+
+	// Construct the thread exit hook
+	(void)&_threadCacheRelease;
+
+	get_mutex().lock();
+
+	// The size classes were replaced so return the blocks of the retired ones
+	if (_threadCache)
+		recycle_thread_cache(_threadCache);
+
+	SizeClassSet* set = _classSet.load();
+	ThreadCache* threadCache = _freeThreadCaches;
+	if (threadCache)
+		_freeThreadCaches = threadCache->pNextFree;
+	else
+	{
+		threadCache = new ThreadCache();
+		threadCache->set = set;
+		for (INT i=0; i<MAX_ALLOCATORS; i++)
 		{
-			_allocators[i] = allocator;
-			return;
+			threadCache->classes[i].thread = threadCache;
+			threadCache->classes[i].allocator = i < set->count ? set->allocators[i] : NULL;
 		}
+		threadCache->pNextAll = _allThreadCaches;
+		_allThreadCaches = threadCache;
 	}
-	
-	ASSERT();
+
+	for (INT i=0; i<MAX_ALLOCATORS; i++)
+		threadCache->classes[i].owned = true;
+
+	get_mutex().unlock();
+
+	_threadCache = threadCache;
+	return threadCache;
+#endif
+}
+
+/// Flush and recycle the calling thread's cache. Called when the thread exits.
+static void release_thread_cache()
+{
+	ThreadCache* threadCache = _threadCache;
+	_threadCache = NULL;
+	_threadCacheReleased = TRUE;
+	if (!threadCache)
+		return;
+
+	get_mutex().lock();
+	recycle_thread_cache(threadCache);
+	get_mutex().unlock();
 }
 
 /// This function must be called exactly one time *before* any other xallocator
@@ -194,87 +482,158 @@ extern "C" void xalloc_init()
 	new (&_allocator2048) AllocatorPool<CHAR[2048], MAX_BLOCKS>();
 	new (&_allocator4096) AllocatorPool<CHAR[4096], MAX_BLOCKS>();
 
-	// Populate allocator array with all instances 
-	_allocators[0] = (Allocator*)&_allocator8;
-	_allocators[1] = (Allocator*)&_allocator16;
-	_allocators[2] = (Allocator*)&_allocator32;
-	_allocators[3] = (Allocator*)&_allocator64;
-	_allocators[4] = (Allocator*)&_allocator128;
-	_allocators[5] = (Allocator*)&_allocator256;
-	_allocators[6] = (Allocator*)&_allocator396;
-	_allocators[7] = (Allocator*)&_allocator512;
-	_allocators[8] = (Allocator*)&_allocator768;
-	_allocators[9] = (Allocator*)&_allocator1024;
-	_allocators[10] = (Allocator*)&_allocator2048;
-	_allocators[11] = (Allocator*)&_allocator4096;
+	// Populate the size classes with all instances
+	SizeClassSet* set = &_staticClassSet;
+	set->allocators[0] = (Allocator*)&_allocator8;
+	set->allocators[1] = (Allocator*)&_allocator16;
+	set->allocators[2] = (Allocator*)&_allocator32;
+	set->allocators[3] = (Allocator*)&_allocator64;
+	set->allocators[4] = (Allocator*)&_allocator128;
+	set->allocators[5] = (Allocator*)&_allocator256;
+	set->allocators[6] = (Allocator*)&_allocator396;
+	set->allocators[7] = (Allocator*)&_allocator512;
+	set->allocators[8] = (Allocator*)&_allocator768;
+	set->allocators[9] = (Allocator*)&_allocator1024;
+	set->allocators[10] = (Allocator*)&_allocator2048;
+	set->allocators[11] = (Allocator*)&_allocator4096;
 
-	get_mutex().unlock();
+	for (INT i=0; i<MAX_ALLOCATORS; i++)
+	{
+		set->classes[i].blockSize = set->allocators[i]->GetBlockSize();
+		set->classes[i].blocks = MAX_BLOCKS;
+		set->classes[i].flags = 0;
+	}
+	set->count = MAX_ALLOCATORS;
+	set->sizeClasses = _sizeClassTable;
+	build_size_classes(set);
+	bind_shared_caches(set);
+#else
+	get_mutex().lock();
+
+	// Create every size class allocator up front so xmalloc() never creates one.
+	// Heap blocks mode allocators obtain no memory until first used.
+	SizeClassSet* set;
+	if (_pendingCnt > 0)
+		set = create_class_set(_pendingClasses, _pendingCnt);
+	else
+		set = create_class_set(_defaultClasses, sizeof(_defaultClasses) / sizeof(_defaultClasses[0]));
 #endif
+
+	_classSet.store(set, std::memory_order_release);
+	_xallocInitialized = TRUE;
+
+	get_mutex().unlock();
 }
 
 /// Called one time when the application exits to cleanup any allocated memory.
 /// ~XallocInitDestroy destructor calls this function automatically. 
 extern "C" void xalloc_destroy()
 {
+	xalloc_trim_stop();
+
 	get_mutex().lock();
 
-#ifdef STATIC_POOLS
-	for (INT i=0; i<MAX_ALLOCATORS; i++)
+	_xallocInitialized = FALSE;
+	SizeClassSet* set = _classSet.exchange(NULL);
+
+	// Return cached blocks and forget the allocators about to be destroyed
+	for (ThreadCache* threadCache = _allThreadCaches; threadCache; threadCache = threadCache->pNextAll)
 	{
-		_allocators[i]->~Allocator();
-		_allocators[i] = 0;
+		for (INT i=0; i<MAX_ALLOCATORS; i++)
+		{
+			flush_class_cache(&threadCache->classes[i], TRUE);
+			threadCache->classes[i].allocator = NULL;
+		}
+		threadCache->set = NULL;
 	}
-#else
-	for (INT i=0; i<MAX_ALLOCATORS; i++)
+	_freeThreadCaches = NULL;
+
+	// Destroy the current and every retired set of size classes. The sets are 
+	// kept since a block freed later still refers to their shared caches.
+	while (set)
 	{
-		if (_allocators[i] == 0)
-			break;
-		delete _allocators[i];
-		_allocators[i] = 0;
-	}
+		for (INT i=0; i<MAX_ALLOCATORS; i++)
+		{
+			flush_class_cache(&set->sharedCaches[i], FALSE);
+			set->sharedCaches[i].allocator = NULL;
+		}
+
+		for (INT i=0; i<set->count; i++)
+		{
+#ifdef STATIC_POOLS
+			set->allocators[i]->~Allocator();
+#else
+			delete set->allocators[i];
 #endif
+			set->allocators[i] = 0;
+		}
+#ifndef STATIC_POOLS
+		delete [] set->sizeClasses;
+		set->sizeClasses = NULL;
+#endif
+		set->count = 0;
+		set = set->pRetired;
+	}
 
 	get_mutex().unlock();
 }
 
+/// Allocate a block too large for any size class from the heap.
+/// @param[in] size - the client's requested block size.
+/// @return	A pointer to the client's memory block or NULL if out of memory.
+static void* oversize_malloc(size_t size)
+{
+	if (size > (size_t)-1 - sizeof(OversizeHeader))
+		return NULL;
+	OversizeHeader* header = static_cast<OversizeHeader*>(::operator new(sizeof(OversizeHeader) + size, std::nothrow));
+	if (header == NULL)
+		return NULL;
+	header->size = size;
+	return set_block_cache(&header->cache, OVERSIZE_CACHE);
+}
+
+/// Get the header of an oversize block.
+/// @param[in] block - a pointer to the raw memory block. 
+/// @return	The header in front of the raw memory block.
+static inline OversizeHeader* get_oversize_header(void* block)
+{
+	return reinterpret_cast<OversizeHeader*>(static_cast<char*>(block) - offsetof(OversizeHeader, cache));
+}
+
+/// Get the client's usable size of a block.
+/// @param[in] block - a pointer to the client's memory block. 
+/// @return	The number of bytes the client may use.
+static size_t get_block_size(void* block)
+{
+	ClassCache* cache = get_block_cache(block);
+	if (cache == OVERSIZE_CACHE)
+		return get_oversize_header(get_block_ptr(block))->size;
+	return cache->allocator.load()->GetBlockSize() - sizeof(ClassCache*);
+}
+
 /// Get an Allocator instance based upon the client's requested block size.
-/// If a Allocator instance is not currently available to handle the size,
-///	then a new Allocator instance is create.
 ///	@param[in] size - the client's requested block size.
 ///	@return An Allocator instance that handles blocks of the requested
 ///	size.
 extern "C" Allocator* xallocator_get_allocator(size_t size)
 {
-	// Based on the size, find the next higher powers of two value.
-	// Add sizeof(Allocator*) to the requested block size to hold the size
-	// within the block memory region. Most blocks are powers of two,
-	// however some common allocator block sizes can be explicitly defined
-	// to minimize wasted storage. This offers application specific tuning.
-	size_t blockSize = size + sizeof(Allocator*);
-	if (blockSize > 256 && blockSize <= 396)
-		blockSize = 396;
-	else if (blockSize > 512 && blockSize <= 768)
-		blockSize = 768;
-	else
-		blockSize = nexthigher<size_t>(blockSize);
-
-	Allocator* allocator = find_allocator(blockSize);
-
-#ifdef STATIC_POOLS
-	ASSERT_TRUE(allocator != NULL);
-#else
-	// If there is not an allocator already created to handle this block size
-	if (allocator == NULL)  
-	{
-		// Create a new allocator to handle blocks of the size required
-		allocator = new Allocator(blockSize, 0, 0, "xallocator");
+	ASSERT_TRUE(_xallocInitialized);
+	SizeClassSet* set = _classSet.load(std::memory_order_acquire);
+	return set->allocators[get_size_class(set, size)];
+}
 
-		// Insert allocator into array
-		insert_allocator(allocator);
-	}
-#endif
-	
-	return allocator;
+/// Get the calling thread's cache for the size class handling the requested size.
+/// @param[in] size - the client's requested block size.
+/// @return The thread's size class cache, a shared cache if the thread has none, 
+///		or NULL if the size is too large for every size class.
+static inline ClassCache* get_class_cache(size_t size)
+{
+	ThreadCache* threadCache = get_thread_cache();
+	SizeClassSet* set = threadCache ? threadCache->set : _classSet.load(std::memory_order_acquire);
+	if (size > set->maxBlockSize - sizeof(ClassCache*))
+		return NULL;
+	ClassCache* classes = threadCache ? threadCache->classes : set->sharedCaches;
+	return &classes[get_size_class(set, size)];
 }
 
 /// Allocates a memory block of the requested size. The blocks are created from
@@ -283,16 +642,85 @@ extern "C" Allocator* xallocator_get_allocator(size_t size)
 /// @return	A pointer to the client's memory block.
 extern "C" void *xmalloc(size_t size)
 {
-	get_mutex().lock();
+	ASSERT_TRUE(_xallocInitialized);
+	ClassCache* cache = get_class_cache(size);
 
-	// Allocate a raw memory block 
-	Allocator* allocator = xallocator_get_allocator(size);
-	void* blockMemoryPtr = allocator->Allocate(sizeof(Allocator*) + size);
+	// Too large for the largest size class so allocate from the heap
+	if (cache == NULL)
+		return oversize_malloc(size);
+	void* blockMemoryPtr = NULL;
 
-	get_mutex().unlock();
+	Profile* profile = _profile.load(std::memory_order_acquire);
+	if (profile)
+	{
+		size_t bucket = (size + sizeof(ClassCache*) + (1 << SIZE_CLASS_SHIFT) - 1) >> SIZE_CLASS_SHIFT;
+		if (bucket < profile->buckets)
+			profile->counts[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
 
-	// Set the block Allocator* within the raw memory block region
-	void* clientsMemoryPtr = set_block_allocator(blockMemoryPtr, allocator);
+	if (cache->thread)
+	{
+		// Reclaim blocks freed by other threads once the magazine runs empty
+		if (cache->count == 0)
+		{
+			FreeBlock* pBlock = cache->remoteFree.exchange(NULL, std::memory_order_acquire);
+			while (pBlock && cache->count < MAGAZINE_SIZE)
+			{
+				cache->magazine[cache->count++] = pBlock;
+				pBlock = pBlock->pNext;
+			}
+			if (pBlock)
+			{
+				get_mutex().lock();
+				Allocator* allocator = cache->allocator.load();
+				while (pBlock)
+				{
+					FreeBlock* pNext = pBlock->pNext;
+					allocator->Deallocate(pBlock);
+					pBlock = pNext;
+				}
+				get_mutex().unlock();
+			}
+		}
+
+		if (cache->count > 0)
+			blockMemoryPtr = cache->magazine[--cache->count];
+	}
+
+	if (blockMemoryPtr == NULL)
+	{
+		get_mutex().lock();
+
+		// Allocate a raw memory block and, if caching, refill the magazine 
+		Allocator* allocator = cache->allocator.load();
+		size_t blockSize = allocator->GetBlockSize();
+		blockMemoryPtr = allocator->Allocate(blockSize);
+		if (cache->thread && blockMemoryPtr)
+		{
+			// Only take blocks a pool has free so refilling never exhausts it
+			BOOL pool = allocator->IsPool();
+			while (cache->count < MAGAZINE_BATCH - 1)
+			{
+				void* pBlock = pool ? allocator->TryAllocate(blockSize) : allocator->Allocate(blockSize);
+				if (pBlock == NULL)
+					break;
+				cache->magazine[cache->count++] = pBlock;
+			}
+		}
+
+		get_mutex().unlock();
+
+		// Pool exhausted and the new-handler returned
+		if (blockMemoryPtr == NULL)
+			return NULL;
+	}
+
+	cache->allocations.fetch_add(1, std::memory_order_relaxed);
+	cache->wastedBytes.fetch_add(cache->allocator.load(std::memory_order_relaxed)->GetBlockSize() - 
+		size - sizeof(ClassCache*), std::memory_order_relaxed);
+
+	// Set the block ClassCache* within the raw memory block region
+	void* clientsMemoryPtr = set_block_cache(blockMemoryPtr, cache);
 	return clientsMemoryPtr;
 }
 
@@ -304,16 +732,64 @@ extern "C" void xfree(void* ptr)
 	if (ptr == 0)
 		return;
 
-	// Extract the original allocator instance from the caller's block pointer
-	Allocator* allocator = get_block_allocator(ptr);
+	// Extract the owning cache instance from the caller's block pointer
+	ClassCache* cache = get_block_cache(ptr);
 
 	// Convert the client pointer into the original raw block pointer
 	void* blockPtr = get_block_ptr(ptr);
 
+	if (cache == OVERSIZE_CACHE)
+	{
+		::operator delete(get_oversize_header(blockPtr));
+		return;
+	}
+
+	cache->deallocations.fetch_add(1, std::memory_order_relaxed);
+
+	// Freed by the owning thread so return it to the magazine
+	if (cache->thread && cache->thread == _threadCache)
+	{
+		if (cache->count == MAGAZINE_SIZE)
+		{
+			get_mutex().lock();
+			Allocator* allocator = cache->allocator.load();
+			while (cache->count > MAGAZINE_SIZE - MAGAZINE_BATCH)
+			{
+				void* pMemory = cache->magazine[--cache->count];
+				if (allocator)
+					allocator->Deallocate(pMemory);
+			}
+			get_mutex().unlock();
+		}
+		cache->magazine[cache->count++] = blockPtr;
+		return;
+	}
+
+	// Freed by another thread so push it onto the owner's remote-free list
+	if (cache->owned.load())
+	{
+		FreeBlock* pBlock = static_cast<FreeBlock*>(blockPtr);
+		pBlock->pNext = cache->remoteFree.load(std::memory_order_relaxed);
+		while (!cache->remoteFree.compare_exchange_weak(pBlock->pNext, pBlock))
+			;
+
+		// The owner exited after the ownership check; it may have flushed
+		// before the push so flush here instead
+		if (!cache->owned.load())
+		{
+			get_mutex().lock();
+			flush_class_cache(cache, FALSE);
+			get_mutex().unlock();
+		}
+		return;
+	}
+
 	get_mutex().lock();
 
 	// Deallocate the block 
-	allocator->Deallocate(blockPtr);
+	Allocator* allocator = cache->allocator.load();
+	if (allocator)
+		allocator->Deallocate(blockPtr);
 
 	get_mutex().unlock();
 }
@@ -337,9 +813,8 @@ extern "C" void *xrealloc(void *oldMem, size_t size)
 		void* newMem = xmalloc(size);
 		if (newMem != 0) 
 		{
-			// Get the original allocator instance from the old memory block
-			Allocator* oldAllocator = get_block_allocator(oldMem);
-			size_t oldSize = oldAllocator->GetBlockSize() - sizeof(Allocator*);
+			// Get the original client size of the old memory block
+			size_t oldSize = get_block_size(oldMem);
 
 			// Copy the bytes from the old memory block into the new (as much as will fit)
 			memcpy(newMem, oldMem, (oldSize < size) ? oldSize : size);
@@ -354,25 +829,410 @@ extern "C" void *xrealloc(void *oldMem, size_t size)
 	}
 }
 
+/// Add the client statistics of a cache to a snapshot
+static void add_cache_stats(ClassCache* cache, XallocClassStats* stats)
+{
+	stats->allocations += cache->allocations.load(std::memory_order_relaxed);
+	stats->deallocations += cache->deallocations.load(std::memory_order_relaxed);
+	stats->wastedBytes += cache->wastedBytes.load(std::memory_order_relaxed);
+}
+
+/// Get a snapshot of the size class statistics
+extern "C" INT xalloc_get_stats(XallocClassStats* stats, INT maxCount)
+{
+	get_mutex().lock();
+
+	// Statistics of the current size classes. Retired classes are not reported.
+	SizeClassSet* set = _classSet.load();
+	INT count = set == NULL ? 0 : set->count < maxCount ? set->count : maxCount;
+	for (INT i=0; i<count; i++)
+	{
+		XallocClassStats& s = stats[i];
+		memset(&s, 0, sizeof(s));
+
+		add_cache_stats(&set->sharedCaches[i], &s);
+		for (ThreadCache* threadCache = _allThreadCaches; threadCache; threadCache = threadCache->pNextAll)
+		{
+			if (threadCache->set == set)
+				add_cache_stats(&threadCache->classes[i], &s);
+		}
+
+		Allocator* allocator = set->allocators[i];
+		s.blockSize = allocator->GetBlockSize();
+		s.blocksCreated = allocator->GetBlockCount();
+		s.peakBlocksInUse = allocator->GetPeakBlocksInUse();
+		s.exhaustions = allocator->GetExhaustions();
+		s.reclaimedBytes = allocator->GetReclaimedBytes();
+
+		// Blocks the allocator handed out are either held by clients or cached
+		UINT allocatorInUse = allocator->GetBlocksInUse();
+		unsigned long long clientInUse = s.allocations > s.deallocations ? s.allocations - s.deallocations : 0;
+		s.blocksInUse = clientInUse < allocatorInUse ? (UINT)clientInUse : allocatorInUse;
+		s.blocksCached = allocatorInUse - s.blocksInUse;
+	}
+
+	get_mutex().unlock();
+	return count;
+}
+
 /// Output xallocator usage statistics
 extern "C" void xalloc_stats()
 {
+	XallocClassStats stats[MAX_ALLOCATORS];
+	INT count = xalloc_get_stats(stats, MAX_ALLOCATORS);
+
+	for (INT i=0; i<count; i++)
+	{
+		cout << "xallocator";
+		cout << " Block Size: " << stats[i].blockSize;
+		cout << " Block Count: " << stats[i].blocksCreated;
+		cout << " Blocks In Use: " << stats[i].blocksInUse;
+		cout << " Blocks Cached: " << stats[i].blocksCached;
+		cout << " Peak Blocks In Use: " << stats[i].peakBlocksInUse;
+		cout << " Allocations: " << stats[i].allocations;
+		cout << " Deallocations: " << stats[i].deallocations;
+		cout << " Exhaustions: " << stats[i].exhaustions;
+		cout << " Wasted Bytes: " << stats[i].wastedBytes;
+		cout << " Reclaimed Bytes: " << stats[i].reclaimedBytes;
+		cout << endl;
+	}
+}
+
+/// Release free blocks of every size class
+extern "C" size_t xalloc_trim(UINT retainBlocks)
+{
+#ifdef STATIC_POOLS
+	(void)retainBlocks;
+	return 0;
+#else
 	get_mutex().lock();
 
-	for (INT i=0; i<MAX_ALLOCATORS; i++)
+	// Return blocks freed by other threads so their chunks can become fully free.
+	// Magazines belong to running threads and exited threads flushed theirs.
+	for (ThreadCache* threadCache = _allThreadCaches; threadCache; threadCache = threadCache->pNextAll)
+	{
+		for (INT i=0; i<MAX_ALLOCATORS; i++)
+			flush_class_cache(&threadCache->classes[i], FALSE);
+	}
+
+	// Trim the current and every retired set of size classes
+	size_t released = 0;
+	for (SizeClassSet* set = _classSet.load(); set; set = set->pRetired)
+	{
+		for (INT i=0; i<MAX_ALLOCATORS; i++)
+			flush_class_cache(&set->sharedCaches[i], FALSE);
+		for (INT i=0; i<set->count; i++)
+			released += set->allocators[i]->Trim(retainBlocks);
+	}
+
+	get_mutex().unlock();
+	return released;
+#endif
+}
+
+/// Entry point for the background trim thread
+static void trim_process()
+{
+	TrimPolicy& policy = get_trim_policy();
+	std::unique_lock<std::mutex> lk(policy.mutex);
+	while (!policy.exit)
 	{
-		if (_allocators[i] == 0)
+		if (policy.cv.wait_for(lk, policy.period, [&policy]() { return policy.exit != FALSE; }))
 			break;
 
-		if (_allocators[i]->GetName() != NULL)
-			cout << _allocators[i]->GetName();
-		cout << " Block Size: " << _allocators[i]->GetBlockSize();
-		cout << " Block Count: " << _allocators[i]->GetBlockCount();
-		cout << " Blocks In Use: " << _allocators[i]->GetBlocksInUse();
-		cout << endl;
+		UINT retainBlocks = policy.retainBlocks;
+		lk.unlock();
+		xalloc_trim(retainBlocks);
+		lk.lock();
+	}
+}
+
+/// Start trimming periodically on a background thread
+extern "C" void xalloc_trim_start(UINT retainBlocks, UINT periodMs)
+{
+	xalloc_trim_stop();
+
+	TrimPolicy& policy = get_trim_policy();
+	std::lock_guard<std::mutex> lk(policy.mutex);
+	policy.exit = FALSE;
+	policy.retainBlocks = retainBlocks;
+	policy.period = std::chrono::milliseconds(periodMs);
+	policy.thread = new std::thread(trim_process);
+}
+
+/// Stop the background trim thread
+extern "C" void xalloc_trim_stop()
+{
+	TrimPolicy& policy = get_trim_policy();
+	std::thread* thread;
+	{
+		std::lock_guard<std::mutex> lk(policy.mutex);
+		thread = policy.thread;
+		policy.thread = NULL;
+		policy.exit = TRUE;
+	}
+	policy.cv.notify_one();
+
+	if (thread)
+	{
+		thread->join();
+		delete thread;
+	}
+}
+
+/// Replace the size classes and pool capacities
+extern "C" BOOL xalloc_configure(const XallocClass* classes, INT count)
+{
+#ifdef STATIC_POOLS
+	(void)classes;
+	(void)count;
+	return FALSE;
+#else
+	if (classes == NULL || count <= 0 || count > MAX_ALLOCATORS)
+		return FALSE;
+	for (INT i=0; i<count; i++)
+	{
+		// The size class table has one entry per 1 << SIZE_CLASS_SHIFT bytes
+		if (classes[i].blockSize <= sizeof(ClassCache*) ||
+			(classes[i].blockSize & ((1 << SIZE_CLASS_SHIFT) - 1)) != 0 ||
+			(i > 0 && classes[i].blockSize <= classes[i-1].blockSize))
+			return FALSE;
 	}
 
+	get_mutex().lock();
+
+	// Not yet initialized so keep the classes for xalloc_init() to create
+	if (!_xallocInitialized)
+	{
+		for (INT i=0; i<count; i++)
+			_pendingClasses[i] = classes[i];
+		_pendingCnt = count;
+		get_mutex().unlock();
+		return TRUE;
+	}
+
+	// Blocks and thread caches of the current classes may still be in use, so 
+	// retire them rather than destroy them
+	SizeClassSet* set = create_class_set(classes, count);
+	set->pRetired = _classSet.load();
+	_classSet.store(set, std::memory_order_release);
+
+	// Recycled thread caches belong to the retired classes
+	_freeThreadCaches = NULL;
+
 	get_mutex().unlock();
+	return TRUE;
+#endif
 }
 
+/// Get the current size classes
+extern "C" INT xalloc_get_classes(XallocClass* classes, INT maxCount)
+{
+	get_mutex().lock();
+
+	SizeClassSet* set = _classSet.load();
+	INT count = set == NULL ? 0 : set->count < maxCount ? set->count : maxCount;
+	for (INT i=0; i<count; i++)
+		classes[i] = set->classes[i];
 
+	get_mutex().unlock();
+	return count;
+}
+
+/// Start recording request sizes
+extern "C" void xalloc_profile_start()
+{
+	get_mutex().lock();
+
+	size_t buckets = (get_max_block_size() >> SIZE_CLASS_SHIFT) + 1;
+	if (_lastProfile == NULL || _lastProfile->buckets != buckets)
+	{
+		_lastProfile = new Profile;
+		_lastProfile->buckets = buckets;
+		_lastProfile->counts = new std::atomic<unsigned long long>[buckets];
+	}
+	for (size_t i=0; i<buckets; i++)
+		_lastProfile->counts[i] = 0;
+	_profile.store(_lastProfile, std::memory_order_release);
+
+	get_mutex().unlock();
+}
+
+/// Stop recording request sizes
+extern "C" void xalloc_profile_stop()
+{
+	_profile.store(NULL, std::memory_order_release);
+}
+
+/// Get the bytes wasted by the profiled requests given ascending block sizes.
+/// Called with the lock held.
+static unsigned long long profile_waste(const std::vector<size_t>& blockSizes)
+{
+	unsigned long long waste = 0;
+	size_t index = 0;
+	for (size_t i=1; i<_lastProfile->buckets; i++)
+	{
+		size_t blockSize = i << SIZE_CLASS_SHIFT;
+		while (index < blockSizes.size() && blockSizes[index] < blockSize)
+			index++;
+		if (index == blockSizes.size())
+			break;
+		waste += _lastProfile->counts[i].load(std::memory_order_relaxed) * (blockSizes[index] - blockSize);
+	}
+	return waste;
+}
+
+/// Compute the recommended block sizes. Called with the lock held.
+/// @param[in] maxCount - the maximum number of size classes.
+/// @return The recommended block sizes in ascending order. Empty if nothing was profiled.
+static std::vector<size_t> profile_recommend(INT maxCount)
+{
+	std::vector<size_t> sizes;
+	std::vector<unsigned long long> counts;
+	if (_lastProfile == NULL || maxCount <= 0)
+		return sizes;
+	size_t maxBlockSize = get_max_block_size();
+	if (maxCount > MAX_ALLOCATORS)
+		maxCount = MAX_ALLOCATORS;
+
+	// Distinct profiled block sizes rounded up to pointer alignment. Coarsen the 
+	// alignment while there are too many to partition quickly.
+	size_t align = sizeof(void*);
+	do
+	{
+		sizes.clear();
+		counts.clear();
+		for (size_t i=1; i<_lastProfile->buckets; i++)
+		{
+			unsigned long long count = _lastProfile->counts[i].load(std::memory_order_relaxed);
+			if (count == 0)
+				continue;
+			size_t blockSize = ((i << SIZE_CLASS_SHIFT) + align - 1) / align * align;
+			if (blockSize > maxBlockSize)
+				blockSize = maxBlockSize;
+			if (!sizes.empty() && sizes.back() == blockSize)
+				counts.back() += count;
+			else
+			{
+				sizes.push_back(blockSize);
+				counts.push_back(count);
+			}
+		}
+		align *= 2;
+	} while (sizes.size() > 1024);
+
+	if (sizes.empty())
+		return sizes;
+
+	// Keep the largest class for unprofiled requests
+	BOOL keepLargest = sizes.back() < maxBlockSize;
+	size_t groups = (size_t)maxCount - (keepLargest && maxCount > 1 ? 1 : 0);
+	size_t n = sizes.size();
+	if (groups > n)
+		groups = n;
+
+	// Partition the sizes into groups minimizing the waste. Each group uses its
+	// largest size as the block size. 
+	std::vector<unsigned long long> prefixCount(n + 1, 0), prefixBytes(n + 1, 0);
+	for (size_t i=0; i<n; i++)
+	{
+		prefixCount[i+1] = prefixCount[i] + counts[i];
+		prefixBytes[i+1] = prefixBytes[i] + counts[i] * sizes[i];
+	}
+
+	const unsigned long long INF = ~0ULL;
+	std::vector<unsigned long long> cost((groups + 1) * (n + 1), INF);
+	std::vector<size_t> split((groups + 1) * (n + 1), 0);
+	cost[0] = 0;
+	for (size_t k=1; k<=groups; k++)
+	{
+		for (size_t b=k; b<=n; b++)
+		{
+			for (size_t a=k-1; a<b; a++)
+			{
+				unsigned long long prev = cost[(k-1) * (n+1) + a];
+				if (prev == INF)
+					continue;
+				unsigned long long waste = sizes[b-1] * (prefixCount[b] - prefixCount[a]) - (prefixBytes[b] - prefixBytes[a]);
+				if (prev + waste < cost[k * (n+1) + b])
+				{
+					cost[k * (n+1) + b] = prev + waste;
+					split[k * (n+1) + b] = a;
+				}
+			}
+		}
+	}
+
+	std::vector<size_t> blockSizes(groups);
+	size_t b = n;
+	for (size_t k=groups; k>0; k--)
+	{
+		blockSizes[k-1] = sizes[b-1];
+		b = split[k * (n+1) + b];
+	}
+	if (keepLargest && blockSizes.back() < maxBlockSize)
+	{
+		if (blockSizes.size() == (size_t)maxCount)
+			blockSizes.back() = maxBlockSize;
+		else
+			blockSizes.push_back(maxBlockSize);
+	}
+	return blockSizes;
+}
+
+/// Recommend size classes from the profile
+extern "C" INT xalloc_profile_recommend(XallocClass* classes, INT maxCount)
+{
+	get_mutex().lock();
+	std::vector<size_t> blockSizes = profile_recommend(maxCount);
+	get_mutex().unlock();
+
+	for (size_t i=0; i<blockSizes.size(); i++)
+	{
+		classes[i].blockSize = blockSizes[i];
+		classes[i].blocks = 0;
+		classes[i].flags = 0;
+	}
+	return (INT)blockSizes.size();
+}
+
+/// Output the request size profile and recommended size classes
+extern "C" void xalloc_profile_report()
+{
+	get_mutex().lock();
+
+	if (_lastProfile == NULL)
+	{
+		get_mutex().unlock();
+		return;
+	}
+
+	unsigned long long requests = 0;
+	for (size_t i=1; i<_lastProfile->buckets; i++)
+	{
+		unsigned long long count = _lastProfile->counts[i].load(std::memory_order_relaxed);
+		if (count == 0)
+			continue;
+		requests += count;
+		size_t maxSize = (i << SIZE_CLASS_SHIFT) - sizeof(ClassCache*);
+		size_t minSize = maxSize < (1 << SIZE_CLASS_SHIFT) ? 0 : maxSize - (1 << SIZE_CLASS_SHIFT) + 1;
+		cout << "xallocator Request Size: " << minSize << "-" << maxSize;
+		cout << " Count: " << count << endl;
+	}
+
+	std::vector<size_t> current;
+	SizeClassSet* set = _classSet.load();
+	for (INT i=0; set && i<set->count; i++)
+		current.push_back(set->classes[i].blockSize);
+	std::vector<size_t> recommended = profile_recommend(MAX_ALLOCATORS);
+
+	cout << "xallocator Requests: " << requests;
+	cout << " Wasted Bytes: " << profile_waste(current);
+	cout << " Recommended Wasted Bytes: " << profile_waste(recommended) << endl;
+	cout << "xallocator Recommended Classes: {";
+	for (size_t i=0; i<recommended.size(); i++)
+		cout << (i ? ", " : " ") << "{ " << recommended[i] << ", 0, 0 }";
+	cout << " }" << endl;
+
+	get_mutex().unlock();
+}
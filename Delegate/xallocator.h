@@ -38,6 +38,9 @@ static XallocInitDestroy xallocInitDestroy;
 extern "C" {
 #endif
 
+/// The maximum number of size classes
+#define XALLOC_MAX_CLASSES	24
+
 /// This function must be called exactly one time before the operating system
 /// threading starts. If using xallocator exclusively in C files within your application
 /// code, you must call this function before the OS starts. If using C++, client code
@@ -54,7 +57,8 @@ void xalloc_init();
 /// Embedded systems that never exit need not call this function at all. 
 void xalloc_destroy();
 
-/// Allocate a block of memory
+/// Allocate a block of memory. Blocks larger than the largest size class are
+/// allocated from the heap.
 /// @param[in] size - the size of the block to allocate. 
 void *xmalloc(size_t size);
 
@@ -70,6 +74,99 @@ void *xrealloc(void *ptr, size_t size);
 /// Output allocator statistics to the standard output
 void xalloc_stats();
 
+/// Statistics of one xallocator size class
+typedef struct
+{
+	size_t blockSize;					///< Fixed block size in bytes, including the block header
+	UINT blocksCreated;					///< Blocks obtained from the heap or pool
+	UINT blocksInUse;					///< Blocks currently held by clients
+	UINT blocksCached;					///< Free blocks held in thread caches
+	UINT peakBlocksInUse;				///< High-water mark of blocks held by clients and caches
+	unsigned long long allocations;		///< Number of xmalloc() calls served
+	unsigned long long deallocations;	///< Number of xfree() calls served
+	UINT exhaustions;					///< Allocations that failed because the pool was exhausted
+	unsigned long long wastedBytes;		///< Bytes lost to rounding up over all allocations
+	unsigned long long reclaimedBytes;	///< Bytes released by xalloc_trim()
+} XallocClassStats;
+
+/// Get a snapshot of every size class's statistics. Counters updated by other
+/// threads during the call may be slightly out of step with each other. Only
+/// the current size classes are reported, not those retired by xalloc_configure().
+/// @param[out] stats - receives up to maxCount size class statistics.
+/// @param[in] maxCount - the capacity of the stats array.
+/// @return The number of size classes written.
+INT xalloc_get_stats(XallocClassStats* stats, INT maxCount);
+
+/// Release free blocks of every size class so memory tracks the working set rather
+/// than the historical peak. Blocks freed by other threads are reclaimed first. 
+/// Blocks cached by running threads are kept. Unavailable with STATIC_POOLS.
+/// @param[in] retainBlocks - the number of free blocks to keep per size class.
+/// @return The number of bytes released.
+size_t xalloc_trim(UINT retainBlocks);
+
+/// Start trimming periodically on a background thread. Replaces any running
+/// policy. Stopped by xalloc_trim_stop() or xalloc_destroy(). Start and stop
+/// the policy from one thread at a time.
+/// @param[in] retainBlocks - the number of free blocks to keep per size class.
+/// @param[in] periodMs - the time between trims in milliseconds.
+void xalloc_trim_start(UINT retainBlocks, UINT periodMs);
+
+/// Stop the background trim thread. Blocks until the thread exits.
+void xalloc_trim_stop();
+
+/// Describes one xallocator size class
+typedef struct
+{
+	/// Fixed block size in bytes, including the block header of one pointer. Block 
+	/// sizes must be a multiple of 4 and should be a multiple of the platform alignment.
+	size_t blockSize;
+
+	/// Pool capacity in blocks, or 0 to create blocks off the heap as needed. Each
+	/// thread may hold up to 32 free blocks of a class in its cache, so allow for 
+	/// them when sizing a pool.
+	UINT blocks;
+
+	/// AllocatorFlags options for the class memory, e.g. a prefaulted huge page 
+	/// pool. 0 for heap memory.
+	UINT flags;
+} XallocClass;
+
+/// Replace the size classes and pool capacities. Called before xalloc_init(), the
+/// classes are kept for xalloc_init() to create. Called after, each thread takes 
+/// new blocks from the new classes on its next xmalloc(). The replaced classes are
+/// retired, not destroyed, so blocks still allocated or cached return to them when
+/// freed. Retired classes hold their memory until xalloc_destroy(), so configure 
+/// rarely, e.g. once after profiling. Unavailable with STATIC_POOLS.
+/// @param[in] classes - the size classes in ascending block size order.
+/// @param[in] count - the number of size classes, at most XALLOC_MAX_CLASSES.
+/// @return TRUE if applied. FALSE if the classes are invalid. 
+BOOL xalloc_configure(const XallocClass* classes, INT count);
+
+/// Get the current size classes.
+/// @param[out] classes - receives up to maxCount size classes.
+/// @param[in] maxCount - the capacity of the classes array.
+/// @return The number of size classes.
+INT xalloc_get_classes(XallocClass* classes, INT maxCount);
+
+/// Start recording a histogram of xmalloc() request sizes. Clears any
+/// previous profile. Adds one atomic increment per allocation.
+void xalloc_profile_start();
+
+/// Stop recording request sizes. The profile is kept.
+void xalloc_profile_stop();
+
+/// Recommend size classes minimizing the bytes wasted by the profiled requests.
+/// The current largest size class is always kept so larger, unprofiled requests
+/// still succeed. Pool capacities are set to 0.
+/// @param[out] classes - receives the recommended classes in ascending order.
+/// @param[in] maxCount - the maximum number of classes, at most XALLOC_MAX_CLASSES.
+/// @return The number of recommended classes, or 0 if nothing was profiled.
+INT xalloc_profile_recommend(XallocClass* classes, INT maxCount);
+
+/// Output the profiled request sizes, the bytes wasted by the current and the 
+/// recommended size classes and the recommended class table to the standard output.
+void xalloc_profile_report();
+
 // Macro to overload new/delete with xalloc/xfree  
 #define XALLOCATOR \
     public: \
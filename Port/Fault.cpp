@@ -1,4 +1,5 @@
 #include "Fault.h"
+#include "DelegateFlightRecorder.h"
 #include <assert.h>
 #if WIN32
 	#include "windows.h"
@@ -9,6 +10,10 @@
 //----------------------------------------------------------------------------
 void FaultHandler(const char* file, unsigned short line)
 {
+	// Show what each worker thread was doing leading up to the fault
+	fprintf(stderr, "Fault at %s:%u\n", file, (unsigned)line);
+	DelegateLib::DelegateFlightRecorder::DumpAll(stderr);
+
 #if WIN32
 	// If you hit this line, it means one of the ASSERT macros failed.
     DebugBreak();
@@ -0,0 +1,90 @@
+#ifndef _SPSC_QUEUE_H
+#define _SPSC_QUEUE_H
+
+#include "DelegateMemoryResource.h"
+#include <atomic>
+#include <utility>
+
+/// @brief An unbounded single-producer/single-consumer queue. Push() is called by
+/// exactly one producer thread and Pop() by exactly one consumer thread. Neither
+/// side takes a lock or waits on the other side, so both operations are wait-free
+/// apart from the node heap allocation.
+///
+/// @details The queue is a singly linked list with a dummy head node. The producer
+/// owns m_tail and publishes each new node with a release store. The consumer owns
+/// m_head and deletes the previous dummy node after each successful Pop(). Nodes 
+/// are allocated with DelegateAllocate().
+template <class T>
+class SpscQueue
+{
+public:
+	SpscQueue()
+	{
+		m_head = m_tail = new Node();
+	}
+
+	~SpscQueue()
+	{
+		while (m_head)
+		{
+			Node* node = m_head;
+			m_head = node->next.load(std::memory_order_relaxed);
+			delete node;
+		}
+	}
+
+	/// Add a value to the tail of the queue. Producer thread only.
+	/// @param[in] value - the value to enqueue.
+	void Push(const T& value)
+	{
+		Node* node = new Node();
+		node->value = value;
+		m_tail->next.store(node, std::memory_order_release);
+		m_tail = node;
+	}
+
+	/// Remove a value from the head of the queue. Consumer thread only.
+	/// @param[out] value - the dequeued value.
+	/// @return Returns true if a value was dequeued, false if the queue is empty.
+	bool Pop(T& value)
+	{
+		Node* next = m_head->next.load(std::memory_order_acquire);
+		if (!next)
+			return false;
+
+		value = std::move(next->value);
+		next->value = T();
+
+		delete m_head;
+		m_head = next;
+		return true;
+	}
+
+	/// Check if the queue is empty. Consumer thread only.
+	/// @return Returns true if no values are pending.
+	bool Empty() const
+	{
+		return m_head->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	// Prevent copying objects
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	struct Node
+	{
+		DELEGATE_ALLOCATOR
+		Node() : next(nullptr) {}
+		std::atomic<Node*> next;
+		T value;
+	};
+
+	enum { CACHE_LINE_SIZE = 64 };
+
+	Node* m_head;							// Consumer owned
+	char m_pad[CACHE_LINE_SIZE - sizeof(Node*)];	// Keep head and tail on separate cache lines
+	Node* m_tail;							// Producer owned
+};
+
+#endif
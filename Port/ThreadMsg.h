@@ -1,17 +1,14 @@
 #ifndef _THREAD_MSG_H
 #define _THREAD_MSG_H
 
-#ifdef USE_XALLOCATOR
-	#include "xallocator.h"
-#endif
+#include "DelegateMemoryResource.h"
+#include <chrono>
 
 /// @brief A class to hold a platform-specific thread messsage that will be passed 
 /// through the OS message queue. 
 class ThreadMsg
 {
-#ifdef USE_XALLOCATOR
-	XALLOCATOR
-#endif
+	DELEGATE_ALLOCATOR
 public:
 	/// Constructor
 	/// @param[in] id - a unique identifier for the thread messsage
@@ -22,16 +19,27 @@ public:
 	///		callback is complete.  
 	ThreadMsg(INT id, std::shared_ptr<DelegateLib::DelegateMsgBase> data) :
 		m_id(id), 
-		m_data(data)
+		m_data(data),
+		m_enqueueTime(std::chrono::steady_clock::now()),
+		m_flowId(0)
 	{
 	}
 
     INT GetId() const { return m_id; }
     std::shared_ptr<DelegateLib::DelegateMsgBase> GetData() { return m_data; }
 
+	/// Get the time the message was created, i.e. when it was queued.
+	std::chrono::steady_clock::time_point GetEnqueueTime() const { return m_enqueueTime; }
+
+	/// Set the DelegateTrace flow ID linking the enqueue to the execution.
+	void SetFlowId(unsigned long long flowId) { m_flowId = flowId; }
+	unsigned long long GetFlowId() const { return m_flowId; }
+
 private:
     INT m_id;
     std::shared_ptr<DelegateLib::DelegateMsgBase> m_data;
+	std::chrono::steady_clock::time_point m_enqueueTime;
+	unsigned long long m_flowId;
 };
 
 #endif
@@ -88,6 +88,9 @@ private:
 	/// @see DelegateThread::DispatchDelegate
 	virtual void DispatchDelegate(std::shared_ptr<DelegateLib::DelegateMsgBase> msg);
 
+	/// @see DelegateThread::IsCurrentThread
+	virtual bool IsCurrentThread() { return ::GetCurrentThreadId() == m_threadId; }
+
 	/// The thread start routine. 
 	/// @param[in] threadParam - the thread data passed into the function. 
 	static int RunProcess (void* threadParam);
@@ -1,5 +1,6 @@
 #include "Timer.h"
 #include "Fault.h"
+#include "DelegateTrace.h"
 #include <chrono>
 
 using namespace std;
@@ -94,6 +95,8 @@ void Timer::CheckExpired()
 		m_expireTime = GetTime();
 	}
 
+	DelegateLib::DelegateTrace::TimerExpired(this);
+
 	// Call the client's expired callback function
 	if (Expired)
 		Expired();
@@ -0,0 +1,211 @@
+#include "DelegateOpt.h"
+#if USE_STD_THREADS
+
+#include "Watchdog.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace std;
+using namespace DelegateLib;
+using namespace std::chrono;
+
+//----------------------------------------------------------------------------
+// Watchdog
+//----------------------------------------------------------------------------
+Watchdog::Watchdog(milliseconds handlerThreshold, milliseconds stallThreshold, milliseconds period) :
+	m_handlerThreshold(handlerThreshold),
+	m_stallThreshold(stallThreshold),
+	m_period(period),
+	m_exit(false)
+{
+	ASSERT_TRUE(period.count() > 0);
+}
+
+//----------------------------------------------------------------------------
+// ~Watchdog
+//----------------------------------------------------------------------------
+Watchdog::~Watchdog()
+{
+	Stop();
+}
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void Watchdog::Start()
+{
+	if (m_thread)
+		return;
+
+	m_exit = false;
+	m_thread = std::unique_ptr<std::thread>(new thread(&Watchdog::Process, this));
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void Watchdog::Stop()
+{
+	if (!m_thread)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_exit = true;
+		m_cv.notify_one();
+	}
+	m_thread->join();
+	m_thread = nullptr;
+}
+
+//----------------------------------------------------------------------------
+// Register
+//----------------------------------------------------------------------------
+void Watchdog::Register(WorkerThread& thread)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+
+	// Only judge messages started from now on
+	Monitor monitor = { &thread, steady_clock::now(), steady_clock::time_point(), false };
+	m_monitors.push_back(monitor);
+}
+
+//----------------------------------------------------------------------------
+// Unregister
+//----------------------------------------------------------------------------
+void Watchdog::Unregister(WorkerThread& thread)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_monitors.erase(std::remove_if(m_monitors.begin(), m_monitors.end(),
+		[&thread](const Monitor& monitor) { return monitor.thread == &thread; }),
+		m_monitors.end());
+}
+
+//----------------------------------------------------------------------------
+// GetSlowCallCount
+//----------------------------------------------------------------------------
+unsigned long long Watchdog::GetSlowCallCount(const DelegateTarget& target)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	auto it = m_slowCalls.find(target);
+	return it == m_slowCalls.end() ? 0 : it->second;
+}
+
+//----------------------------------------------------------------------------
+// GetSlowCalls
+//----------------------------------------------------------------------------
+std::map<DelegateTarget, unsigned long long> Watchdog::GetSlowCalls()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	return m_slowCalls;
+}
+
+//----------------------------------------------------------------------------
+// Check
+//----------------------------------------------------------------------------
+void Watchdog::Check(Monitor& monitor, steady_clock::time_point now, std::vector<WatchdogAlarm>& alarms)
+{
+	WorkerThread::Stats stats = monitor.thread->GetStats();
+	auto entries = monitor.thread->GetFlightRecorder().GetEntries();
+
+	WatchdogAlarm alarm;
+	alarm.threadName = stats.threadName;
+	alarm.queueDepth = stats.queueDepth;
+
+	DelegateTarget running;
+	for (auto& entry : entries)
+	{
+		if (entry.running)
+		{
+			// Alarm once while the message is still executing
+			running = entry.target;
+			nanoseconds elapsed = duration_cast<nanoseconds>(now - entry.startTime);
+			if (elapsed > m_handlerThreshold && entry.startTime != monitor.flaggedStart)
+			{
+				monitor.flaggedStart = entry.startTime;
+				m_slowCalls[entry.target]++;
+				alarm.type = WatchdogAlarm::SLOW_HANDLER;
+				alarm.target = entry.target;
+				alarm.elapsed = elapsed;
+				alarms.push_back(alarm);
+			}
+			continue;
+		}
+
+		// Completed messages not yet examined
+		if (entry.startTime <= monitor.lastStart)
+			continue;
+		monitor.lastStart = entry.startTime;
+
+		if (entry.duration > m_handlerThreshold && entry.startTime != monitor.flaggedStart)
+		{
+			m_slowCalls[entry.target]++;
+			alarm.type = WatchdogAlarm::SLOW_HANDLER;
+			alarm.target = entry.target;
+			alarm.elapsed = entry.duration;
+			alarms.push_back(alarm);
+		}
+	}
+
+	// The worker loop heartbeat stops advancing while a message blocks the queue
+	nanoseconds sinceHeartbeat = duration_cast<nanoseconds>(now - monitor.thread->GetHeartbeat());
+	if (stats.queueDepth > 0 && sinceHeartbeat > m_stallThreshold)
+	{
+		if (!monitor.stalled)
+		{
+			monitor.stalled = true;
+			alarm.type = WatchdogAlarm::QUEUE_STALLED;
+			alarm.target = running;
+			alarm.elapsed = sinceHeartbeat;
+			alarms.push_back(alarm);
+		}
+	}
+	else
+		monitor.stalled = false;
+}
+
+//----------------------------------------------------------------------------
+// Raise
+//----------------------------------------------------------------------------
+void Watchdog::Raise(const WatchdogAlarm& alarm)
+{
+	if (Triggered)
+	{
+		Triggered(alarm);
+		return;
+	}
+
+	fprintf(stderr, "Watchdog: %s %s %s for %lldms, %u queued\n",
+		alarm.threadName.c_str(),
+		alarm.type == WatchdogAlarm::SLOW_HANDLER ? "slow handler" : "queue stalled",
+		alarm.target.ToString().c_str(),
+		(long long)duration_cast<milliseconds>(alarm.elapsed).count(),
+		(unsigned)alarm.queueDepth);
+}
+
+//----------------------------------------------------------------------------
+// Process
+//----------------------------------------------------------------------------
+void Watchdog::Process()
+{
+	while (1)
+	{
+		std::vector<WatchdogAlarm> alarms;
+		{
+			std::unique_lock<std::mutex> lk(m_mutex);
+			m_cv.wait_for(lk, m_period, [this]() { return m_exit; });
+			if (m_exit)
+				break;
+
+			auto now = steady_clock::now();
+			for (auto& monitor : m_monitors)
+				Check(monitor, now, alarms);
+		}
+
+		// Raise outside the lock so a callback may register or unregister threads
+		for (auto& alarm : alarms)
+			Raise(alarm);
+	}
+}
+
+#endif
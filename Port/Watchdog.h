@@ -0,0 +1,126 @@
+#ifndef _WATCHDOG_H
+#define _WATCHDOG_H
+
+#include "DelegateOpt.h"
+#if USE_STD_THREADS
+
+#include "DelegateLib.h"
+#include "WorkerThreadStd.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+
+/// Describes a problem detected by the Watchdog.
+struct WatchdogAlarm
+{
+	enum Type
+	{
+		/// A delegate has been executing longer than the handler threshold.
+		SLOW_HANDLER,
+
+		/// Messages are pending but the thread has not finished one within the stall threshold.
+		QUEUE_STALLED
+	};
+
+	Type type;
+	std::string threadName;
+	DelegateLib::DelegateTarget target;		///< The delegate executing, if known
+	std::chrono::nanoseconds elapsed;		///< Time executing or time without progress
+	size_t queueDepth;						///< Messages not yet completed at detection
+};
+
+/// @brief Monitors registered worker threads from a separate thread. Raises an
+/// alarm when a delegate runs longer than the handler threshold or when a
+/// thread's queue stops draining, identifying the delegate responsible. Counts
+/// slow calls per target function.
+///
+/// @details Alarms are raised once per slow message and once per stall. Slow calls
+/// that start and finish between two polls are found in the thread's
+/// DelegateFlightRecorder; more completions than the recorder holds within
+/// one poll period are not counted.
+class Watchdog
+{
+public:
+	/// Client's register with Triggered to receive alarms. Called on the watchdog
+	/// thread. If empty, alarms are written to stderr. Set before Start().
+	DelegateLib::SinglecastDelegate<void(const WatchdogAlarm&)> Triggered;
+
+	/// Constructor
+	/// @param[in] handlerThreshold - longest acceptable single delegate execution.
+	/// @param[in] stallThreshold - longest acceptable time with messages pending
+	///		and none completed.
+	/// @param[in] period - how often the threads are checked.
+	Watchdog(std::chrono::milliseconds handlerThreshold, std::chrono::milliseconds stallThreshold,
+		std::chrono::milliseconds period = std::chrono::milliseconds(100));
+
+	/// Destructor
+	~Watchdog();
+
+	/// Start monitoring.
+	void Start();
+
+	/// Stop monitoring. Blocks until the watchdog thread exits.
+	void Stop();
+
+	/// Monitor a worker thread. The thread must be unregistered before it is destroyed.
+	/// @param[in] thread - the thread to monitor.
+	void Register(WorkerThread& thread);
+
+	/// Stop monitoring a worker thread.
+	/// @param[in] thread - the thread to stop monitoring.
+	void Unregister(WorkerThread& thread);
+
+	/// Get the number of slow calls detected for a target function.
+	/// @param[in] target - the target function.
+	unsigned long long GetSlowCallCount(const DelegateLib::DelegateTarget& target);
+
+	/// Get the number of slow calls detected for a free or member function.
+	template <class Func>
+	unsigned long long GetSlowCallCount(Func func) { return GetSlowCallCount(DelegateLib::DelegateTarget(func)); }
+
+	/// Get the slow call count of every target function with at least one slow call.
+	std::map<DelegateLib::DelegateTarget, unsigned long long> GetSlowCalls();
+
+private:
+	// Prevent copying objects
+	Watchdog(const Watchdog&) = delete;
+	Watchdog& operator=(const Watchdog&) = delete;
+
+	/// Per-thread monitoring state
+	struct Monitor
+	{
+		WorkerThread* thread;
+		std::chrono::steady_clock::time_point lastStart;	// Newest recorder entry examined
+		std::chrono::steady_clock::time_point flaggedStart;	// Slow message already alarmed
+		bool stalled;										// Stall already alarmed
+	};
+
+	/// Entry point for the watchdog thread
+	void Process();
+
+	/// Check one thread. Called with m_mutex held.
+	void Check(Monitor& monitor, std::chrono::steady_clock::time_point now, std::vector<WatchdogAlarm>& alarms);
+
+	/// Raise an alarm on the watchdog thread
+	void Raise(const WatchdogAlarm& alarm);
+
+	const std::chrono::nanoseconds m_handlerThreshold;
+	const std::chrono::nanoseconds m_stallThreshold;
+	const std::chrono::milliseconds m_period;
+
+	std::unique_ptr<std::thread> m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_exit;
+	std::vector<Monitor> m_monitors;			// Guarded by m_mutex
+	std::map<DelegateLib::DelegateTarget, unsigned long long> m_slowCalls;	// Guarded by m_mutex
+};
+
+#endif
+
+#endif
@@ -4,10 +4,15 @@
 #include "WorkerThreadStd.h"
 #include "ThreadMsg.h"
 #include "Timer.h"
+#include "DelegateTrace.h"
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 
 #ifdef WIN32
 #include <Windows.h>
+#else
+#include <time.h>
 #endif
 
 using namespace std;
@@ -18,11 +23,63 @@ using namespace std::chrono;
 #define MSG_EXIT_THREAD			2
 #define MSG_TIMER				3
 
+// Enqueue and dequeue rates are averaged over roughly this window
+#define RATE_WINDOW_MS			1000
+
+static std::atomic<unsigned long long> _nextInstanceId(1);
+
+thread_local std::vector<WorkerThread::LaneRef> WorkerThread::m_producerLanes;
+thread_local WorkerThread* WorkerThread::m_currentThread = nullptr;
+
 //----------------------------------------------------------------------------
 // WorkerThread
 //----------------------------------------------------------------------------
-WorkerThread::WorkerThread(const CHAR* threadName) : m_thread(nullptr), m_timerExit(false), THREAD_NAME(threadName)
+WorkerThread::WorkerThread(const CHAR* threadName, QueueMode queueMode) : 
+	m_thread(nullptr), 
+	m_queue(DelegateLib::DelegateDeque<std::shared_ptr<ThreadMsg>>(DelegateLib::GetContainerAllocator())),
+	m_timerExit(false), 
+	THREAD_NAME(threadName),
+	m_queueMode(queueMode),
+	m_instanceId(_nextInstanceId++),
+	m_laneBudget(16),
+	m_lanesChanged(false),
+	m_lanesSealed(false),
+	m_waiting(false),
+	m_nextLane(0),
+	m_queueDepth(0),
+	m_waitStrategy(WaitStrategy::BLOCK),
+	m_spinBudget(MIN_SPIN_BUDGET),
+	m_exitRequested(false),
+	m_exitMode(ExitMode::DRAIN),
+	m_discarded(0),
+	m_enqueued(0),
+	m_dequeued(0),
+	m_processed(0),
+	m_totalDiscarded(0),
+	m_maxQueueDepth(0),
+	m_maxExecNs(0),
+	m_cpuNs(0),
+	m_enqueueRate(0),
+	m_dequeueRate(0),
+	m_rateEnqueued(0),
+	m_rateDequeued(0),
+	m_latency(nullptr),
+	m_flightRecorder(threadName),
+	m_heartbeatNs(0),
+	m_arenaReset(ArenaReset::MESSAGE),
+	m_arenaBatchSize(DEFAULT_ARENA_BATCH),
+	m_arenaBatchCnt(0)
 {
+	for (int i = 0; i < WAIT_STRATEGY_CNT; i++)
+	{
+		m_waitStats[i].idleNs = 0;
+		m_waitStats[i].busyNs = 0;
+		m_waitStats[i].spinWakeups = 0;
+		m_waitStats[i].parks = 0;
+	}
+
+	std::lock_guard<std::mutex> lk(GetRegistryLock());
+	GetRegistry().push_back(this);
 }
 
 //----------------------------------------------------------------------------
@@ -31,6 +88,9 @@ WorkerThread::WorkerThread(const CHAR* threadName) : m_thread(nullptr), m_timerE
 WorkerThread::~WorkerThread()
 {
 	ExitThread();
+
+	std::lock_guard<std::mutex> lk(GetRegistryLock());
+	GetRegistry().remove(this);
 }
 
 //----------------------------------------------------------------------------
@@ -40,6 +100,14 @@ BOOL WorkerThread::CreateThread()
 {
 	if (!m_thread)
 	{
+		// Start the rate averages from messages dispatched before this run
+		m_rateTime = steady_clock::now();
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			m_rateEnqueued = GetEnqueuedCount();
+		}
+		m_rateDequeued = m_dequeued.load(std::memory_order_relaxed);
+
 		m_thread = std::unique_ptr<std::thread>(new thread(&WorkerThread::Process, this));
 
 #ifdef WIN32
@@ -78,23 +146,142 @@ std::thread::id WorkerThread::GetCurrentThreadId()
 //----------------------------------------------------------------------------
 // ExitThread
 //----------------------------------------------------------------------------
-void WorkerThread::ExitThread()
+size_t WorkerThread::ExitThread(ExitMode mode, std::chrono::milliseconds deadline)
 {
-	if (!m_thread)
+	RequestExit(mode, deadline);
+	return JoinThread();
+}
+
+//----------------------------------------------------------------------------
+// RequestExit
+//----------------------------------------------------------------------------
+void WorkerThread::RequestExit(ExitMode mode, std::chrono::milliseconds deadline)
+{
+	if (!m_thread || m_exitRequested)
 		return;
 
+	// Publish the exit mode before the worker thread can observe m_exitRequested
+	m_exitMode = mode;
+	m_exitDeadline = steady_clock::now() + deadline;
+	m_discarded = 0;
+	m_exitRequested.store(true, std::memory_order_release);
+
 	// Create a new ThreadMsg
-	std::shared_ptr<ThreadMsg> threadMsg(new ThreadMsg(MSG_EXIT_THREAD, 0));
+	std::shared_ptr<ThreadMsg> threadMsg = DelegateLib::MakeShared<ThreadMsg>(MSG_EXIT_THREAD, nullptr);
 
 	// Put exit thread message into the queue
-	{
-		lock_guard<mutex> lock(m_mutex);
-		m_queue.push(threadMsg);
-		m_cv.notify_one();
-	}
+	PostMsg(threadMsg);
+}
+
+//----------------------------------------------------------------------------
+// JoinThread
+//----------------------------------------------------------------------------
+size_t WorkerThread::JoinThread()
+{
+	if (!m_thread)
+		return 0;
 
     m_thread->join();
     m_thread = nullptr;
+
+	CloseLanes();
+	m_exitRequested = false;
+	return m_discarded;
+}
+
+//----------------------------------------------------------------------------
+// ExitThreads
+//----------------------------------------------------------------------------
+size_t WorkerThread::ExitThreads(const std::vector<WorkerThread*>& threads, ExitMode mode, std::chrono::milliseconds deadline)
+{
+	// Signal every thread first so all threads drain concurrently
+	for (auto thread : threads)
+		thread->RequestExit(mode, deadline);
+
+	size_t discarded = 0;
+	for (auto thread : threads)
+		discarded += thread->JoinThread();
+	return discarded;
+}
+
+//----------------------------------------------------------------------------
+// DiscardOnExit
+//----------------------------------------------------------------------------
+bool WorkerThread::DiscardOnExit()
+{
+	if (!m_exitRequested.load(std::memory_order_acquire))
+		return false;
+
+	switch (m_exitMode)
+	{
+		case ExitMode::DISCARD:
+			return true;
+		case ExitMode::DEADLINE:
+			return steady_clock::now() >= m_exitDeadline;
+		default:
+			return false;
+	}
+}
+
+//----------------------------------------------------------------------------
+// DiscardAll
+//----------------------------------------------------------------------------
+void WorkerThread::DiscardAll()
+{
+	// Take the queue under the lock, then discard outside it since discarding 
+	// runs argument destructors
+	std::queue<std::shared_ptr<ThreadMsg>, DelegateLib::DelegateDeque<std::shared_ptr<ThreadMsg>>> queue;
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		queue = std::move(m_queue);
+		m_queueDepth = 0;
+		m_activeLanes = m_lanes;
+		m_lanesChanged = false;
+	}
+
+	size_t discarded = 0;
+	for (; !queue.empty(); queue.pop())
+	{
+		if (queue.front()->GetId() == MSG_DISPATCH_DELEGATE)
+		{
+			DiscardDelegate(queue.front());
+			discarded++;
+		}
+	}
+
+	std::shared_ptr<ThreadMsg> msg;
+	for (auto& lane : m_activeLanes)
+	{
+		while (lane->queue.Pop(msg))
+		{
+			DiscardDelegate(msg);
+			lane->dequeued++;
+			discarded++;
+		}
+	}
+
+	m_discarded += discarded;
+	m_totalDiscarded.fetch_add(discarded, std::memory_order_relaxed);
+	m_dequeued.fetch_add(discarded, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// DiscardDelegate
+//----------------------------------------------------------------------------
+void WorkerThread::DiscardDelegate(std::shared_ptr<ThreadMsg> msg)
+{
+	// Let the invoker free the argument copies DelegateInvoke() would have freed
+	auto delegateMsg = msg->GetData();
+	delegateMsg->GetDelegateInvoker()->DelegateDiscard(delegateMsg);
+}
+
+//----------------------------------------------------------------------------
+// SetLaneBudget
+//----------------------------------------------------------------------------
+void WorkerThread::SetLaneBudget(UINT budget)
+{
+	ASSERT_TRUE(budget > 0);
+	m_laneBudget = budget;
 }
 
 //----------------------------------------------------------------------------
@@ -105,14 +292,572 @@ void WorkerThread::DispatchDelegate(std::shared_ptr<DelegateLib::DelegateMsgBase
 	ASSERT_TRUE(m_thread);
 
 	// Create a new ThreadMsg
-    std::shared_ptr<ThreadMsg> threadMsg(new ThreadMsg(MSG_DISPATCH_DELEGATE, msg));
+    std::shared_ptr<ThreadMsg> threadMsg = DelegateLib::MakeShared<ThreadMsg>(MSG_DISPATCH_DELEGATE, msg);
+	threadMsg->SetFlowId(DelegateTrace::Enqueue(msg->GetTarget()));
+
+	if (m_queueMode == QueueMode::PRODUCER_LANES)
+	{
+		// Add dispatch delegate msg to this producer's lane without locking
+		if (PushLane(threadMsg))
+		{
+			NotifyLanes();
+			return;
+		}
+
+		// The worker thread is exiting so reject the message like a discarded one
+		DiscardDelegate(threadMsg);
+		m_discarded.fetch_add(1, std::memory_order_relaxed);
+		m_totalDiscarded.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
 
 	// Add dispatch delegate msg to queue and notify worker thread
+	m_enqueued.fetch_add(1, std::memory_order_relaxed);
+	PostMsg(threadMsg);
+}
+
+//----------------------------------------------------------------------------
+// PostMsg
+//----------------------------------------------------------------------------
+void WorkerThread::PostMsg(std::shared_ptr<ThreadMsg> msg)
+{
 	std::unique_lock<std::mutex> lk(m_mutex);
-	m_queue.push(threadMsg);
+	m_queue.push(msg);
+	m_queueDepth.fetch_add(1, std::memory_order_release);
 	m_cv.notify_one();
 }
 
+//----------------------------------------------------------------------------
+// GetProducerLane
+//----------------------------------------------------------------------------
+WorkerThread::ProducerLane* WorkerThread::GetProducerLane()
+{
+	// Fast path: lane already registered by this producer thread. A lane closed 
+	// by ExitThread() is no longer serviced, even if the thread was restarted.
+	for (auto& ref : m_producerLanes)
+	{
+		if (ref.instanceId == m_instanceId && !ref.lane->closed.load(std::memory_order_relaxed))
+			return ref.lane.get();
+	}
+
+	// Drop references to lanes of worker threads that have since exited
+	m_producerLanes.erase(std::remove_if(m_producerLanes.begin(), m_producerLanes.end(),
+		[](const LaneRef& ref) { return ref.lane->closed.load(std::memory_order_relaxed); }),
+		m_producerLanes.end());
+
+	// First message from this producer thread so register a new lane, unless 
+	// the worker thread is exiting
+	std::shared_ptr<ProducerLane> lane(new ProducerLane());
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		if (m_lanesSealed)
+			return nullptr;
+		m_lanes.push_back(lane);
+		m_lanesChanged = true;
+	}
+
+	LaneRef ref = { m_instanceId, lane };
+	m_producerLanes.push_back(ref);
+	return lane.get();
+}
+
+//----------------------------------------------------------------------------
+// PushLane
+//----------------------------------------------------------------------------
+bool WorkerThread::PushLane(std::shared_ptr<ThreadMsg> msg)
+{
+	ProducerLane* lane = GetProducerLane();
+	if (!lane)
+		return false;
+
+	// Pairs with SealLanes() so either this thread sees the lane closed or the 
+	// worker thread waits for the push to finish before counting the lane
+	lane->pushing.store(true);
+	if (lane->closed.load())
+	{
+		lane->pushing.store(false);
+		return false;
+	}
+
+	lane->enqueued.store(lane->enqueued.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	lane->queue.Push(msg);
+	lane->pushing.store(false);
+	return true;
+}
+
+//----------------------------------------------------------------------------
+// NotifyLanes
+//----------------------------------------------------------------------------
+void WorkerThread::NotifyLanes()
+{
+	// Pairs with the fence in Process() so either the worker thread sees the 
+	// pushed message or this thread sees m_waiting set. Only lock when the 
+	// worker thread is actually waiting.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_waiting.load(std::memory_order_relaxed))
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_cv.notify_one();
+	}
+}
+
+//----------------------------------------------------------------------------
+// LanesPending
+//----------------------------------------------------------------------------
+bool WorkerThread::LanesPending()
+{
+	for (auto& lane : m_lanes)
+	{
+		if (!lane->queue.Empty())
+			return true;
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------------
+// ServiceLanes
+//----------------------------------------------------------------------------
+UINT WorkerThread::ServiceLanes()
+{
+	// Pick up lanes registered since the last pass
+	if (m_lanesChanged.exchange(false))
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_activeLanes = m_lanes;
+	}
+
+	// Sample the lane depths once per pass rather than once per message
+	unsigned long long enqueued = m_enqueued.load(std::memory_order_relaxed);
+	for (auto& lane : m_activeLanes)
+		enqueued += lane->enqueued.load(std::memory_order_relaxed);
+	UpdateMaxQueueDepth(enqueued);
+
+	UINT serviced = 0;
+	size_t laneCnt = m_activeLanes.size();
+	for (size_t i = 0; i < laneCnt; i++)
+	{
+		m_nextLane = (m_nextLane + 1) % laneCnt;
+		ProducerLane* lane = m_activeLanes[m_nextLane].get();
+
+		// Service at most m_laneBudget messages before moving to the next lane
+		std::shared_ptr<ThreadMsg> msg;
+		for (UINT cnt = 0; cnt < m_laneBudget && lane->queue.Pop(msg); cnt++)
+		{
+			lane->dequeued++;
+			InvokeDelegate(msg);
+			serviced++;
+		}
+	}
+	return serviced;
+}
+
+//----------------------------------------------------------------------------
+// SealLanes
+//----------------------------------------------------------------------------
+void WorkerThread::SealLanes()
+{
+	// Stop new lanes being registered and pick up any registered since the last pass
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_lanesSealed = true;
+		m_activeLanes = m_lanes;
+		m_lanesChanged = false;
+	}
+
+	// Pairs with PushLane(). Once no push is in flight a closed lane cannot grow.
+	for (auto& lane : m_activeLanes)
+	{
+		lane->closed.store(true);
+		while (lane->pushing.load())
+			std::this_thread::yield();
+	}
+}
+
+//----------------------------------------------------------------------------
+// DrainLanes
+//----------------------------------------------------------------------------
+void WorkerThread::DrainLanes()
+{
+	// Take the count of each sealed lane once so the drain always terminates
+	std::vector<unsigned long long> remaining;
+	for (auto& lane : m_activeLanes)
+		remaining.push_back(lane->enqueued.load(std::memory_order_relaxed) - lane->dequeued);
+
+	// Service the lanes round-robin like ServiceLanes() until all counts are met
+	bool pending = true;
+	while (pending && !DiscardOnExit())
+	{
+		pending = false;
+		for (size_t i = 0; i < m_activeLanes.size(); i++)
+		{
+			ProducerLane* lane = m_activeLanes[i].get();
+			std::shared_ptr<ThreadMsg> msg;
+			for (UINT cnt = 0; cnt < m_laneBudget && remaining[i] > 0; cnt++)
+			{
+				if (!lane->queue.Pop(msg))
+				{
+					remaining[i] = 0;
+					break;
+				}
+				lane->dequeued++;
+				remaining[i]--;
+				InvokeDelegate(msg);
+			}
+			if (remaining[i] > 0)
+				pending = true;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+// PruneLanes
+//----------------------------------------------------------------------------
+void WorkerThread::PruneLanes()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+
+	// Release the worker copies so the reference counts below are accurate
+	m_activeLanes.clear();
+	m_lanesChanged = true;
+
+	// A lane only referenced here belongs to a producer thread that has exited
+	auto it = std::remove_if(m_lanes.begin(), m_lanes.end(),
+		[](const std::shared_ptr<ProducerLane>& lane) { return lane.use_count() == 1 && lane->queue.Empty(); });
+
+	// Keep the message counts of removed lanes
+	for (auto removed = it; removed != m_lanes.end(); ++removed)
+		m_enqueued.fetch_add((*removed)->enqueued.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	m_lanes.erase(it, m_lanes.end());
+}
+
+//----------------------------------------------------------------------------
+// CloseLanes
+//----------------------------------------------------------------------------
+void WorkerThread::CloseLanes()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	for (auto& lane : m_lanes)
+	{
+		lane->closed = true;
+		m_enqueued.fetch_add(lane->enqueued.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	m_lanes.clear();
+	m_activeLanes.clear();
+	m_lanesChanged = false;
+	m_lanesSealed = false;
+}
+
+//----------------------------------------------------------------------------
+// SetArenaReset
+//----------------------------------------------------------------------------
+void WorkerThread::SetArenaReset(ArenaReset reset, UINT batchSize)
+{
+	ASSERT_TRUE(batchSize > 0);
+	ASSERT_TRUE(!m_thread);
+	m_arenaReset = reset;
+	m_arenaBatchSize = batchSize;
+}
+
+//----------------------------------------------------------------------------
+// ReleaseArena
+//----------------------------------------------------------------------------
+void WorkerThread::ReleaseArena(bool drained)
+{
+	if (!drained)
+		m_arenaBatchCnt++;
+	if (m_arenaReset == ArenaReset::BATCH && !drained && m_arenaBatchCnt < m_arenaBatchSize)
+		return;
+
+	// A batch ending with the arena untouched needs no reset
+	if (m_arena.GetUsed() > 0)
+		m_arena.Reset();
+	m_arenaBatchCnt = 0;
+}
+
+//----------------------------------------------------------------------------
+// SetWaitStrategy
+//----------------------------------------------------------------------------
+void WorkerThread::SetWaitStrategy(WaitStrategy strategy)
+{
+	// The worker thread picks up the new strategy after its next message
+	m_waitStrategy.store(strategy, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// GetWaitStats
+//----------------------------------------------------------------------------
+WorkerThread::WaitStats WorkerThread::GetWaitStats(WaitStrategy strategy) const
+{
+	const WaitCounters& counters = m_waitStats[static_cast<int>(strategy)];
+
+	WaitStats stats;
+	stats.idleTime = std::chrono::nanoseconds(counters.idleNs.load(std::memory_order_relaxed));
+	stats.busyTime = std::chrono::nanoseconds(counters.busyNs.load(std::memory_order_relaxed));
+	stats.spinWakeups = counters.spinWakeups.load(std::memory_order_relaxed);
+	stats.parks = counters.parks.load(std::memory_order_relaxed);
+	return stats;
+}
+
+//----------------------------------------------------------------------------
+// GetEnqueuedCount
+//----------------------------------------------------------------------------
+unsigned long long WorkerThread::GetEnqueuedCount()
+{
+	unsigned long long enqueued = m_enqueued.load(std::memory_order_relaxed);
+	for (auto& lane : m_lanes)
+		enqueued += lane->enqueued.load(std::memory_order_relaxed);
+	return enqueued;
+}
+
+//----------------------------------------------------------------------------
+// UpdateMaxQueueDepth
+//----------------------------------------------------------------------------
+void WorkerThread::UpdateMaxQueueDepth(unsigned long long enqueued)
+{
+	// The depth only falls when a message is dequeued, so sampling just before 
+	// each dequeue captures the peak
+	unsigned long long dequeued = m_dequeued.load(std::memory_order_relaxed);
+	if (enqueued > dequeued && enqueued - dequeued > m_maxQueueDepth.load(std::memory_order_relaxed))
+		m_maxQueueDepth.store(enqueued - dequeued, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// UpdateRates
+//----------------------------------------------------------------------------
+void WorkerThread::UpdateRates()
+{
+	auto now = steady_clock::now();
+	double elapsed = duration<double>(now - m_rateTime).count();
+	if (elapsed <= 0)
+		return;
+
+	unsigned long long enqueued;
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		enqueued = GetEnqueuedCount();
+	}
+	unsigned long long dequeued = m_dequeued.load(std::memory_order_relaxed);
+
+	// Exponentially weighted moving average. Weight each sample by its interval
+	// so a late timer tick counts for more.
+	double alpha = 1.0 - std::exp(-elapsed * 1000.0 / RATE_WINDOW_MS);
+	double enqueueRate = m_enqueueRate.load(std::memory_order_relaxed);
+	double dequeueRate = m_dequeueRate.load(std::memory_order_relaxed);
+	enqueueRate += alpha * ((enqueued - m_rateEnqueued) / elapsed - enqueueRate);
+	dequeueRate += alpha * ((dequeued - m_rateDequeued) / elapsed - dequeueRate);
+	m_enqueueRate.store(enqueueRate, std::memory_order_relaxed);
+	m_dequeueRate.store(dequeueRate, std::memory_order_relaxed);
+
+	m_rateTime = now;
+	m_rateEnqueued = enqueued;
+	m_rateDequeued = dequeued;
+}
+
+//----------------------------------------------------------------------------
+// GetThreadCpuTime
+//----------------------------------------------------------------------------
+std::chrono::nanoseconds WorkerThread::GetThreadCpuTime()
+{
+#ifdef WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return nanoseconds(0);
+
+	// FILETIME is in 100ns units
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return nanoseconds((k.QuadPart + u.QuadPart) * 100);
+#else
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return nanoseconds(0);
+	return seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec);
+#endif
+}
+
+//----------------------------------------------------------------------------
+// GetStats
+//----------------------------------------------------------------------------
+WorkerThread::Stats WorkerThread::GetStats()
+{
+	unsigned long long enqueued;
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		enqueued = GetEnqueuedCount();
+	}
+	unsigned long long dequeued = m_dequeued.load(std::memory_order_relaxed);
+
+	Stats stats;
+	stats.threadName = THREAD_NAME;
+	stats.queueDepth = enqueued > dequeued ? (size_t)(enqueued - dequeued) : 0;
+	stats.maxQueueDepth = std::max<size_t>((size_t)m_maxQueueDepth.load(std::memory_order_relaxed), stats.queueDepth);
+	stats.enqueued = enqueued;
+	stats.processed = m_processed.load(std::memory_order_relaxed);
+	stats.discarded = m_totalDiscarded.load(std::memory_order_relaxed);
+	stats.enqueueRate = m_enqueueRate.load(std::memory_order_relaxed);
+	stats.dequeueRate = m_dequeueRate.load(std::memory_order_relaxed);
+
+	stats.busyTime = stats.idleTime = nanoseconds(0);
+	for (int i = 0; i < WAIT_STRATEGY_CNT; i++)
+	{
+		stats.busyTime += nanoseconds(m_waitStats[i].busyNs.load(std::memory_order_relaxed));
+		stats.idleTime += nanoseconds(m_waitStats[i].idleNs.load(std::memory_order_relaxed));
+	}
+	stats.cpuTime = nanoseconds(m_cpuNs.load(std::memory_order_relaxed));
+
+	stats.sojournP50 = nanoseconds(m_sojourn.GetPercentile(50.0));
+	stats.sojournP99 = nanoseconds(m_sojourn.GetPercentile(99.0));
+	stats.sojournP999 = nanoseconds(m_sojourn.GetPercentile(99.9));
+	stats.sojournMax = nanoseconds(m_sojourn.GetMax());
+	stats.maxExecTime = nanoseconds(m_maxExecNs.load(std::memory_order_relaxed));
+	stats.arenaCapacity = m_arena.GetCapacity();
+	stats.arenaPeak = std::max(m_arena.GetPeak(), m_arena.GetUsed());
+	return stats;
+}
+
+//----------------------------------------------------------------------------
+// GetAllStats
+//----------------------------------------------------------------------------
+std::vector<WorkerThread::Stats> WorkerThread::GetAllStats()
+{
+	std::lock_guard<std::mutex> lk(GetRegistryLock());
+
+	std::vector<Stats> stats;
+	for (auto thread : GetRegistry())
+		stats.push_back(thread->GetStats());
+	return stats;
+}
+
+//----------------------------------------------------------------------------
+// WorkPending
+//----------------------------------------------------------------------------
+bool WorkerThread::WorkPending()
+{
+	if (m_queueDepth.load(std::memory_order_acquire) > 0)
+		return true;
+
+	if (m_queueMode == QueueMode::PRODUCER_LANES)
+	{
+		// New lanes must be checked too
+		if (m_lanesChanged.load(std::memory_order_relaxed))
+			return true;
+
+		for (auto& lane : m_activeLanes)
+		{
+			if (!lane->queue.Empty())
+				return true;
+		}
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------------
+// CpuRelax
+//----------------------------------------------------------------------------
+static inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(_M_X64) || defined(_M_IX86)
+	YieldProcessor();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+//----------------------------------------------------------------------------
+// WaitForWork
+//----------------------------------------------------------------------------
+void WorkerThread::WaitForWork(WaitStrategy strategy)
+{
+	WaitCounters& counters = m_waitStats[static_cast<int>(strategy)];
+
+	if (strategy == WaitStrategy::BUSY_POLL)
+	{
+		// Never park. Strategy changes are picked up on the next timer message.
+		while (!WorkPending())
+			CpuRelax();
+		counters.spinWakeups.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	if (strategy == WaitStrategy::SPIN_THEN_PARK)
+	{
+		// Spin without locking for up to m_spinBudget iterations
+		for (UINT spin = 0; spin < m_spinBudget; spin++)
+		{
+			if (WorkPending())
+			{
+				// Spinning paid off so spin longer next time
+				m_spinBudget = std::min<UINT>(m_spinBudget * 2, MAX_SPIN_BUDGET);
+				counters.spinWakeups.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			CpuRelax();
+		}
+
+		// Spinning was wasted so spin less next time
+		m_spinBudget = std::max<UINT>(m_spinBudget / 2, MIN_SPIN_BUDGET);
+	}
+
+	// Block until a message arrives
+	std::unique_lock<std::mutex> lk(m_mutex);
+
+	// Pairs with the fence in NotifyLanes()
+	m_waiting.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	while (m_queue.empty() && !(m_queueMode == QueueMode::PRODUCER_LANES && LanesPending()))
+	{
+		counters.parks.fetch_add(1, std::memory_order_relaxed);
+		m_cv.wait(lk);
+	}
+	m_waiting.store(false, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// InvokeDelegate
+//----------------------------------------------------------------------------
+void WorkerThread::InvokeDelegate(std::shared_ptr<ThreadMsg> msg)
+{
+	ASSERT_TRUE(msg->GetData() != NULL);
+
+	// Convert the ThreadMsg void* data back to a DelegateMsg* 
+	auto delegateMsg = msg->GetData();
+
+	auto start = steady_clock::now();
+	m_sojourn.Record(duration_cast<nanoseconds>(start - msg->GetEnqueueTime()).count());
+	DelegateTrace::Dequeue(delegateMsg->GetTarget(), msg->GetFlowId());
+	DelegateTrace::ExecuteBegin(delegateMsg->GetTarget(), msg->GetFlowId());
+	m_flightRecorder.Begin(delegateMsg->GetTarget(), msg->GetEnqueueTime(), start);
+
+	// Invoke the callback on the target thread
+	delegateMsg->GetDelegateInvoker()->DelegateInvoke(delegateMsg);
+	DelegateTrace::ExecuteEnd(delegateMsg->GetTarget());
+
+	auto end = steady_clock::now();
+	m_flightRecorder.End(end);
+	long long execNs = duration_cast<nanoseconds>(end - start).count();
+	if (execNs > m_maxExecNs.load(std::memory_order_relaxed))
+		m_maxExecNs.store(execNs, std::memory_order_relaxed);
+	m_processed.store(m_processed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	m_dequeued.store(m_dequeued.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+#ifdef USE_DELEGATE_LATENCY
+	if (DelegateLatency::IsEnabled())
+	{
+		if (!m_latency)
+			m_latency = DelegateLatency::GetThreadHistograms(THREAD_NAME);
+		DelegateLatency::Record(m_latency, delegateMsg->GetTarget(), delegateMsg->GetCallTime(),
+			msg->GetEnqueueTime(), start, end);
+	}
+#endif
+
+	ReleaseArena(false);
+}
+
 //----------------------------------------------------------------------------
 // TimerThread
 //----------------------------------------------------------------------------
@@ -122,12 +867,10 @@ void WorkerThread::TimerThread()
     {
         std::this_thread::sleep_for((std::chrono::milliseconds)100);
 
-        std::shared_ptr<ThreadMsg> threadMsg (new ThreadMsg(MSG_TIMER, 0));
+        std::shared_ptr<ThreadMsg> threadMsg = DelegateLib::MakeShared<ThreadMsg>(MSG_TIMER, nullptr);
 
         // Add timer msg to queue and notify worker thread
-        std::unique_lock<std::mutex> lk(m_mutex);
-        m_queue.push(threadMsg);
-        m_cv.notify_one();
+        PostMsg(threadMsg);
     }
 }
 
@@ -138,52 +881,100 @@ void WorkerThread::Process()
 {
     m_timerExit = false;
     std::thread timerThread(&WorkerThread::TimerThread, this);
+	m_currentThread = this;
+	DelegateTrace::SetThreadName(THREAD_NAME);
+	m_heartbeatNs.store(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
 
 	while (1)
 	{
+		WaitStrategy strategy = m_waitStrategy.load(std::memory_order_relaxed);
+		WaitCounters& counters = m_waitStats[static_cast<int>(strategy)];
+
+		// A batch ends once no messages are pending
+		if (m_arenaReset == ArenaReset::BATCH && !WorkPending())
+			ReleaseArena(true);
+
+		// Wait for a message to be added to the queue or a lane
+		auto idleStart = steady_clock::now();
+		WaitForWork(strategy);
+		auto busyStart = steady_clock::now();
+		m_heartbeatNs.store(duration_cast<nanoseconds>(busyStart.time_since_epoch()).count(), std::memory_order_relaxed);
+		counters.idleNs.fetch_add(duration_cast<nanoseconds>(busyStart - idleStart).count(), std::memory_order_relaxed);
+
+		// Drop everything still queued once the exit mode no longer allows draining
+		if (DiscardOnExit())
+		{
+			SealLanes();
+			DiscardAll();
+			break;
+		}
+
 		std::shared_ptr<ThreadMsg> msg;
+		if (m_queueDepth.load(std::memory_order_acquire) > 0)
 		{
-			// Wait for a message to be added to the queue
 			std::unique_lock<std::mutex> lk(m_mutex);
-			while (m_queue.empty())
-				m_cv.wait(lk);
-
-			if (m_queue.empty())
-				continue;
-
 			msg = m_queue.front();
 			m_queue.pop();
+			m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		// Lane messages pending but no control message
+		if (!msg)
+		{
+			ServiceLanes();
+			counters.busyNs.fetch_add(duration_cast<nanoseconds>(steady_clock::now() - busyStart).count(), std::memory_order_relaxed);
+			continue;
 		}
 
+		bool exitThread = false;
 		switch (msg->GetId())
 		{
 			case MSG_DISPATCH_DELEGATE:
-			{
-				ASSERT_TRUE(msg->GetData() != NULL);
-
-				// Convert the ThreadMsg void* data back to a DelegateMsg* 
-                auto delegateMsg = msg->GetData();
-
-				// Invoke the callback on the target thread
-				delegateMsg->GetDelegateInvoker()->DelegateInvoke(delegateMsg);
+				UpdateMaxQueueDepth(m_enqueued.load(std::memory_order_relaxed));
+				InvokeDelegate(msg);
 				break;
-			}
 
             case MSG_TIMER:
+				UpdateRates();
+				m_cpuNs.store(GetThreadCpuTime().count(), std::memory_order_relaxed);
                 Timer::ProcessTimers();
+				ReleaseArena(false);
+				if (m_queueMode == QueueMode::PRODUCER_LANES)
+				{
+					PruneLanes();
+					ServiceLanes();
+				}
                 break;
 
 			case MSG_EXIT_THREAD:
 			{
-                m_timerExit = true;
-                timerThread.join();
-                return;
+				// Drain the producer lanes before exiting, unless out of time. 
+				// Messages pushed after this point are rejected.
+				if (m_queueMode == QueueMode::PRODUCER_LANES)
+				{
+					SealLanes();
+					DrainLanes();
+				}
+				if (DiscardOnExit())
+					DiscardAll();
+
+				exitThread = true;
+				break;
 			}
 
 			default:
 				ASSERT();
 		}
+
+		counters.busyNs.fetch_add(duration_cast<nanoseconds>(steady_clock::now() - busyStart).count(), std::memory_order_relaxed);
+		if (exitThread)
+			break;
 	}
+
+	m_cpuNs.store(GetThreadCpuTime().count(), std::memory_order_relaxed);
+	m_currentThread = nullptr;
+    m_timerExit = true;
+    timerThread.join();
 }
 
 #endif
@@ -9,19 +9,113 @@
 
 #include "IDelegateThread.h"
 #include "DataTypes.h"
+#include "SpscQueue.h"
+#include "LatencyHistogram.h"
+#include "DelegateLatency.h"
+#include "DelegateFlightRecorder.h"
+#include "DelegateArena.h"
 #include <thread>
 #include <queue>
+#include <vector>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <chrono>
+#include <string>
+#include <list>
 
 class ThreadMsg;
 
 class WorkerThread : public DelegateLib::DelegateThread
 {
 public:
+	/// Selects how delegate messages are queued to the worker thread.
+	enum class QueueMode
+	{
+		/// All producer threads share one FIFO queue. 
+		SHARED_QUEUE,
+
+		/// Each producer thread gets a private wait-free lane. The worker thread
+		/// services the lanes round-robin, at most GetLaneBudget() messages per 
+		/// lane per pass, so one flooding producer cannot starve the others. 
+		PRODUCER_LANES
+	};
+
+	/// Selects how the worker thread waits for messages when idle.
+	enum class WaitStrategy
+	{
+		/// Block on a condition variable. Lowest CPU usage.
+		BLOCK,
+
+		/// Spin on the queue for an adaptive number of iterations, then block. 
+		/// The spin budget grows when spinning finds work and shrinks when it 
+		/// does not.
+		SPIN_THEN_PARK,
+
+		/// Never block. Burns a full core; use only on a dedicated core.
+		BUSY_POLL
+	};
+
+	/// Selects how queued messages are handled when the worker thread exits.
+	enum class ExitMode
+	{
+		/// Invoke every message queued before the exit request. Default.
+		DRAIN,
+
+		/// Discard all pending messages and exit as soon as the current message returns.
+		DISCARD,
+
+		/// Drain until the deadline passes, then discard whatever remains.
+		DEADLINE
+	};
+
+	/// Selects when the worker thread's arena is reset.
+	enum class ArenaReset
+	{
+		/// Reset after each message. Default.
+		MESSAGE,
+
+		/// Reset once no messages are pending, or after the batch size number of
+		/// messages if the thread never runs out of work.
+		BATCH
+	};
+
+	/// Idle and busy time accumulated while running a wait strategy.
+	struct WaitStats
+	{
+		std::chrono::nanoseconds idleTime;		///< Time spent waiting for messages
+		std::chrono::nanoseconds busyTime;		///< Time spent processing messages
+		unsigned long long spinWakeups;			///< Waits satisfied without parking
+		unsigned long long parks;				///< Times the thread blocked
+	};
+
+	/// Runtime statistics snapshot. Counts include delegate messages only.
+	struct Stats
+	{
+		std::string threadName;
+		size_t queueDepth;						///< Delegate messages currently pending
+		size_t maxQueueDepth;					///< Largest queue depth observed
+		unsigned long long enqueued;			///< Messages dispatched to the thread
+		unsigned long long processed;			///< Messages invoked
+		unsigned long long discarded;			///< Messages discarded on exit
+		double enqueueRate;						///< Messages per second dispatched, averaged over about one second
+		double dequeueRate;						///< Messages per second invoked or discarded
+		std::chrono::nanoseconds busyTime;		///< Wall time spent processing messages
+		std::chrono::nanoseconds idleTime;		///< Wall time spent waiting for messages
+		std::chrono::nanoseconds cpuTime;		///< Worker thread CPU time, sampled each timer tick
+		std::chrono::nanoseconds sojournP50;	///< Median time a message waited in the queue
+		std::chrono::nanoseconds sojournP99;
+		std::chrono::nanoseconds sojournP999;
+		std::chrono::nanoseconds sojournMax;
+		std::chrono::nanoseconds maxExecTime;	///< Longest single message execution time
+		size_t arenaCapacity;					///< Bytes held by the arena
+		size_t arenaPeak;						///< Most arena bytes used between resets
+	};
+
 	/// Constructor
-	WorkerThread(const CHAR* threadName);
+	/// @param[in] threadName - the thread name. 
+	/// @param[in] queueMode - the delegate message queuing mode.
+	WorkerThread(const CHAR* threadName, QueueMode queueMode = QueueMode::SHARED_QUEUE);
 
 	/// Destructor
 	~WorkerThread();
@@ -30,8 +124,36 @@ public:
 	/// @return TRUE if thread is created. FALSE otherise. 
 	BOOL CreateThread();
 
-	/// Called once a program exit to exit the worker thread
-	void ExitThread();
+	/// Called once a program exit to exit the worker thread. Blocks until the 
+	/// thread exits.
+	/// @note A discarded DelegateConnection::BLOCKING_QUEUED or DelegateAsyncWait 
+	///		call releases its caller. The DelegateAsyncWait call is not successful.
+	/// @param[in] mode - how pending messages are handled.
+	/// @param[in] deadline - time allowed to drain when mode is ExitMode::DEADLINE.
+	/// @return The number of pending delegate messages discarded.
+	size_t ExitThread(ExitMode mode = ExitMode::DRAIN, 
+		std::chrono::milliseconds deadline = std::chrono::milliseconds(0));
+
+	/// Ask the worker thread to exit without waiting. Call JoinThread() to wait. 
+	/// @param[in] mode - how pending messages are handled.
+	/// @param[in] deadline - time allowed to drain when mode is ExitMode::DEADLINE.
+	void RequestExit(ExitMode mode, std::chrono::milliseconds deadline = std::chrono::milliseconds(0));
+
+	/// Wait for the worker thread to exit after RequestExit().
+	/// @return The number of pending delegate messages discarded.
+	size_t JoinThread();
+
+	/// Exit several worker threads in parallel. All threads are asked to exit 
+	/// before waiting on any of them, so the total time is that of the slowest.
+	/// @param[in] threads - the worker threads to exit.
+	/// @param[in] mode - how pending messages are handled.
+	/// @param[in] deadline - time allowed to drain when mode is ExitMode::DEADLINE.
+	/// @return The total number of pending delegate messages discarded.
+	static size_t ExitThreads(const std::vector<WorkerThread*>& threads, ExitMode mode,
+		std::chrono::milliseconds deadline = std::chrono::milliseconds(0));
+
+	/// Get the number of delegate messages discarded by the last exit.
+	size_t GetDiscardedCount() const { return m_discarded; }
 
 	/// Get the ID of this thread instance
 	std::thread::id GetThreadId();
@@ -39,24 +161,243 @@ public:
 	/// Get the ID of the currently executing thread
 	static std::thread::id GetCurrentThreadId();
 
+	/// Get the delegate message queuing mode.
+	QueueMode GetQueueMode() const { return m_queueMode; }
+
+	/// Set the maximum number of messages serviced from one producer lane before
+	/// moving on to the next lane. Only used with QueueMode::PRODUCER_LANES.
+	/// @param[in] budget - messages per lane per pass. Must be greater than 0.
+	void SetLaneBudget(UINT budget);
+
+	/// Get the per-lane message budget.
+	UINT GetLaneBudget() const { return m_laneBudget; }
+
+	/// Set when the arena is reset. Call before CreateThread().
+	/// @param[in] reset - the reset policy.
+	/// @param[in] batchSize - the most messages in a batch with ArenaReset::BATCH.
+	///		Must be greater than 0.
+	void SetArenaReset(ArenaReset reset, UINT batchSize = DEFAULT_ARENA_BATCH);
+
+	/// Get the arena reset policy.
+	ArenaReset GetArenaReset() const { return m_arenaReset; }
+
+	/// Get the arena of the WorkerThread running on the calling thread. Memory
+	/// allocated by a delegate handler is valid until the arena is reset after 
+	/// the message or batch, see SetArenaReset().
+	/// @return The arena, or nullptr if not called on a WorkerThread.
+	static DelegateLib::DelegateArena* GetArena() { return m_currentThread ? &m_currentThread->m_arena : nullptr; }
+
+	/// Get this thread's arena. Allocate from it on the worker thread only.
+	const DelegateLib::DelegateArena& GetThreadArena() const { return m_arena; }
+
+	/// Set the idle wait strategy. May be called at any time from any thread. The
+	/// new strategy takes effect after the worker thread's next message.
+	/// @param[in] strategy - the new wait strategy.
+	void SetWaitStrategy(WaitStrategy strategy);
+
+	/// Get the idle wait strategy.
+	WaitStrategy GetWaitStrategy() const { return m_waitStrategy.load(); }
+
+	/// Get the idle and busy time accumulated while running a wait strategy.
+	/// @param[in] strategy - the wait strategy to report.
+	/// @return The wait strategy statistics.
+	WaitStats GetWaitStats(WaitStrategy strategy) const;
+
+	/// Get a snapshot of the runtime statistics. May be called from any thread. 
+	/// @return The thread statistics.
+	Stats GetStats();
+
+	/// Get a snapshot of the runtime statistics of every WorkerThread instance.
+	/// @return The statistics of each thread in creation order.
+	static std::vector<Stats> GetAllStats();
+
+	/// Get the last time the worker thread woke to process a message. Stops 
+	/// advancing while a delegate blocks the thread. Used by Watchdog.
+	std::chrono::steady_clock::time_point GetHeartbeat() const {
+		return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(m_heartbeatNs.load(std::memory_order_relaxed)));
+	}
+
+	/// Get the record of the last messages this thread invoked.
+	const DelegateLib::DelegateFlightRecorder& GetFlightRecorder() const { return m_flightRecorder; }
+
 	virtual void DispatchDelegate(std::shared_ptr<DelegateLib::DelegateMsgBase> msg);
 
+	/// @see DelegateThread::IsCurrentThread
+	virtual bool IsCurrentThread() { return m_currentThread == this; }
+
 private:
 	WorkerThread(const WorkerThread&) = delete;
 	WorkerThread& operator=(const WorkerThread&) = delete;
 
+	/// A private message queue owned by a single producer thread
+	struct ProducerLane
+	{
+		ProducerLane() : closed(false), pushing(false), enqueued(0), dequeued(0) {}
+		SpscQueue<std::shared_ptr<ThreadMsg>> queue;
+		std::atomic<bool> closed;			// Set when the worker thread starts exiting
+		std::atomic<bool> pushing;			// Set by the producer thread while pushing
+		std::atomic<unsigned long long> enqueued;	// Written by the producer thread only
+		unsigned long long dequeued;		// Written by the worker thread only
+	};
+
+	/// A producer thread's reference to its lane on one worker thread
+	struct LaneRef
+	{
+		unsigned long long instanceId;
+		std::shared_ptr<ProducerLane> lane;
+	};
+
 	/// Entry point for the thread
 	void Process();
 
     /// Entry point for timer thread
     void TimerThread();
 
+	/// Add a message to the shared queue and wake the worker thread
+	void PostMsg(std::shared_ptr<ThreadMsg> msg);
+
+	/// Wait for a message using the specified strategy
+	void WaitForWork(WaitStrategy strategy);
+
+	/// Check for pending messages without locking. Worker thread only.
+	bool WorkPending();
+
+	/// Check if the exit mode requires discarding pending messages. Worker thread only.
+	bool DiscardOnExit();
+
+	/// Discard all messages in the queue and lanes. Worker thread only.
+	void DiscardAll();
+
+	/// Release a delegate message without invoking it
+	void DiscardDelegate(std::shared_ptr<ThreadMsg> msg);
+
+	/// Invoke a delegate message on this thread
+	void InvokeDelegate(std::shared_ptr<ThreadMsg> msg);
+
+	/// Reset the arena if the reset policy ends the message or batch. Worker thread only.
+	/// @param[in] drained - true if no messages are pending.
+	void ReleaseArena(bool drained);
+
+	/// Get the calling thread's lane, registering a new one on first use
+	ProducerLane* GetProducerLane();
+
+	/// Wake the worker thread if it is waiting for lane messages
+	void NotifyLanes();
+
+	/// Check all lanes for pending messages. Called with m_mutex held.
+	bool LanesPending();
+
+	/// Service each producer lane once in round-robin order
+	/// @return The number of messages serviced.
+	UINT ServiceLanes();
+
+	/// Remove lanes whose producer thread has exited and are empty
+	void PruneLanes();
+
+	/// Close all lanes so producer threads release them
+	void CloseLanes();
+
+	/// Close all lanes to further pushes when exit starts. Worker thread only.
+	void SealLanes();
+
+	/// Service the messages queued in the lanes before they were sealed, unless 
+	/// the exit mode stops draining. Worker thread only.
+	void DrainLanes();
+
+	/// Add a message to the calling producer thread's lane
+	/// @return Returns false if the lane is closed because the worker thread is exiting.
+	bool PushLane(std::shared_ptr<ThreadMsg> msg);
+
+	/// Get the number of delegate messages dispatched. Called with m_mutex held.
+	unsigned long long GetEnqueuedCount();
+
+	/// Record a new maximum queue depth. Worker thread only.
+	void UpdateMaxQueueDepth(unsigned long long enqueued);
+
+	/// Update the smoothed enqueue and dequeue rates. Worker thread only.
+	void UpdateRates();
+
+	/// Get the CPU time consumed by the calling thread
+	static std::chrono::nanoseconds GetThreadCpuTime();
+
+	/// All WorkerThread instances
+	static std::list<WorkerThread*>& GetRegistry()
+	{
+		static std::list<WorkerThread*> registry;
+		return registry;
+	}
+
+	static std::mutex& GetRegistryLock()
+	{
+		static std::mutex lock;
+		return lock;
+	}
+
 	std::unique_ptr<std::thread> m_thread;
-	std::queue<std::shared_ptr<ThreadMsg>> m_queue;
+	std::queue<std::shared_ptr<ThreadMsg>, DelegateLib::DelegateDeque<std::shared_ptr<ThreadMsg>>> m_queue;
 	std::mutex m_mutex;
 	std::condition_variable m_cv;
     std::atomic<bool> m_timerExit;
 	const std::string THREAD_NAME;
+
+	const QueueMode m_queueMode;
+	const unsigned long long m_instanceId;	// Unique id used to match thread-local lanes
+	UINT m_laneBudget;
+	std::vector<std::shared_ptr<ProducerLane>> m_lanes;		// Guarded by m_mutex
+	std::vector<std::shared_ptr<ProducerLane>> m_activeLanes;	// Worker thread copy of m_lanes
+	std::atomic<bool> m_lanesChanged;
+	bool m_lanesSealed;										// Guarded by m_mutex
+	std::atomic<bool> m_waiting;			// Worker thread is waiting on m_cv
+	size_t m_nextLane;
+
+	enum { WAIT_STRATEGY_CNT = 3, MIN_SPIN_BUDGET = 64, MAX_SPIN_BUDGET = 64 * 1024, DEFAULT_ARENA_BATCH = 64 };
+
+	struct WaitCounters
+	{
+		std::atomic<long long> idleNs;
+		std::atomic<long long> busyNs;
+		std::atomic<unsigned long long> spinWakeups;
+		std::atomic<unsigned long long> parks;
+	};
+
+	std::atomic<size_t> m_queueDepth;		// Messages in m_queue
+	std::atomic<WaitStrategy> m_waitStrategy;
+	UINT m_spinBudget;						// Adaptive spin iterations. Worker thread only.
+	WaitCounters m_waitStats[WAIT_STRATEGY_CNT];
+
+	std::atomic<bool> m_exitRequested;
+	ExitMode m_exitMode;					// Written before m_exitRequested is set
+	std::chrono::steady_clock::time_point m_exitDeadline;
+	std::atomic<size_t> m_discarded;
+
+	// Runtime statistics. Apart from m_enqueued, only the worker thread writes these.
+	std::atomic<unsigned long long> m_enqueued;		// Shared queue messages plus retired lane counts
+	std::atomic<unsigned long long> m_dequeued;		// Messages invoked or discarded
+	std::atomic<unsigned long long> m_processed;
+	std::atomic<unsigned long long> m_totalDiscarded;
+	std::atomic<unsigned long long> m_maxQueueDepth;
+	std::atomic<long long> m_maxExecNs;
+	std::atomic<long long> m_cpuNs;
+	std::atomic<double> m_enqueueRate;
+	std::atomic<double> m_dequeueRate;
+	std::chrono::steady_clock::time_point m_rateTime;
+	unsigned long long m_rateEnqueued;
+	unsigned long long m_rateDequeued;
+	DelegateLib::LatencyHistogram m_sojourn;		// Queue wait time in nanoseconds
+	DelegateLib::DelegateLatency::Histograms* m_latency;	// Resolved on first use. Worker thread only.
+	DelegateLib::DelegateFlightRecorder m_flightRecorder;
+	std::atomic<long long> m_heartbeatNs;
+
+	DelegateLib::DelegateArena m_arena;		// Handler scratch memory. Worker thread only.
+	ArenaReset m_arenaReset;
+	UINT m_arenaBatchSize;
+	UINT m_arenaBatchCnt;					// Messages since the last reset. Worker thread only.
+
+	/// The WorkerThread instance running on the calling thread, if any
+	static thread_local WorkerThread* m_currentThread;
+
+	/// Lanes registered by the calling producer thread, one per worker thread
+	static thread_local std::vector<LaneRef> m_producerLanes;
 };
 
 #endif 